@@ -29,16 +29,12 @@ void loadMaterial(out vec4 baseColor, out vec3 normal, out vec3 emissive, out ve
 
     // Load textures
     // NOTE:
-    // テクスチャはリニア空間になっていないのでガンマ補正が必要
+    // baseColor と emissive は sRGB のフォーマットで作ってあるので、サンプリングした時点でリニア
     //   baseColor:         sRGB
     //   emissive:          sRGB
     //   mettalicRoughness: linear
     //   normal:            linear
     //   occlusion:         linear
-    // WARN: 厳密にはsRGBtoLinearとGamma2.2の処理は異なる
-    // TODO: 
-    // そもそもシェーダで変換するのではなく、vk::ImageのFormatで適切にsRGBかUnormかを指定し、
-    // GPU側で補正してもらうべき。
     int baseColorTexture = objects[pc.objectIndex].baseColorTextureIndex;
     int metallicRoughnessTexture = objects[pc.objectIndex].metallicRoughnessTextureIndex;
     int emissiveTextureIndex = objects[pc.objectIndex].emissiveTextureIndex;
@@ -47,7 +43,6 @@ void loadMaterial(out vec4 baseColor, out vec3 normal, out vec3 emissive, out ve
     int enableNormalMapping = objects[pc.objectIndex].enableNormalMapping;
     if(baseColorTexture != -1){
         vec4 texBaseColor = texture(textures2D[baseColorTexture], inTexCoord);
-        texBaseColor = gammaCorrect(texBaseColor, 2.2);
         baseColor *= texBaseColor;
     }
     if(metallicRoughnessTexture != -1){
@@ -57,7 +52,6 @@ void loadMaterial(out vec4 baseColor, out vec3 normal, out vec3 emissive, out ve
     }
     if(emissiveTextureIndex != -1){
         vec3 texEmissive = texture(textures2D[emissiveTextureIndex], inTexCoord).xyz;
-        texEmissive = gammaCorrect(texEmissive, 2.2);
         emissive *= texEmissive;
     }
     if(occlusionTextureIndex != -1){
@@ -0,0 +1,195 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+
+// glTF のアクセサの要素をまとめて変換して読み出す
+// NOTE: tinygltf に依存しないよう、バッファ上の位置と型だけを受け取る
+//       成分の型ごとに別々のループにしてあり、ループの中では分岐しない
+
+// glTF の componentType と同じ値
+enum class AccessorComponentType : uint32_t {
+    Byte = 5120,
+    UnsignedByte = 5121,
+    Short = 5122,
+    UnsignedShort = 5123,
+    UnsignedInt = 5125,
+    Float = 5126,
+};
+
+// アクセサの密な部分
+// NOTE: data が nullptr の場合 (bufferView を持たない sparse のアクセサ) は全て 0 として読む
+struct AccessorView {
+    const unsigned char* data = nullptr;
+    size_t byteStride = 0;  // 0 なら要素は密に詰まっている
+    size_t count = 0;
+    AccessorComponentType componentType = AccessorComponentType::Float;
+    bool normalized = false;
+};
+
+// アクセサの sparse な部分
+// NOTE: 値は密な部分と同じ型で、密に詰まっている
+struct AccessorSparseView {
+    const unsigned char* indices = nullptr;
+    const unsigned char* values = nullptr;
+    size_t count = 0;
+    AccessorComponentType indexComponentType = AccessorComponentType::UnsignedInt;
+};
+
+inline size_t getComponentSize(AccessorComponentType type) {
+    switch (type) {
+        case AccessorComponentType::Byte:
+        case AccessorComponentType::UnsignedByte:
+            return 1;
+        case AccessorComponentType::Short:
+        case AccessorComponentType::UnsignedShort:
+            return 2;
+        default:
+            return 4;
+    }
+}
+
+namespace accessor_detail {
+// 正規化された整数を [0, 1] か [-1, 1] の float にする (glTF の仕様の式)
+template <typename S>
+float normalize(S value) {
+    if constexpr (std::is_same_v<S, float>) {
+        return value;
+    } else if constexpr (std::is_signed_v<S>) {
+        constexpr float scale = 1.0f / static_cast<float>(std::numeric_limits<S>::max());
+        return std::max(static_cast<float>(value) * scale, -1.0f);
+    } else {
+        constexpr float scale = 1.0f / static_cast<float>(std::numeric_limits<S>::max());
+        return static_cast<float>(value) * scale;
+    }
+}
+
+// 成分を N 個ずつ src から dst に変換して書き込む
+// NOTE: 型と成分数がコンパイル時に決まるため、ループは展開・ベクトル化されやすい
+template <typename S, typename D, uint32_t N, bool Normalized>
+void convert(const unsigned char* src,
+             size_t srcStride,
+             size_t count,
+             unsigned char* dst,
+             size_t dstStride) {
+    if (count == 0) {
+        return;
+    }
+    // 同じ型で両方とも密に詰まっていればそのままコピーする
+    if constexpr (std::is_same_v<S, D>) {
+        if (srcStride == sizeof(S) * N && dstStride == sizeof(D) * N) {
+            std::memcpy(dst, src, sizeof(D) * N * count);
+            return;
+        }
+    }
+    for (size_t i = 0; i < count; i++) {
+        S in[N];
+        D out[N];
+        std::memcpy(in, src + i * srcStride, sizeof(in));
+        for (uint32_t c = 0; c < N; c++) {
+            if constexpr (Normalized) {
+                out[c] = static_cast<D>(normalize(in[c]));
+            } else {
+                out[c] = static_cast<D>(in[c]);
+            }
+        }
+        std::memcpy(dst + i * dstStride, out, sizeof(out));
+    }
+}
+
+template <typename D, uint32_t N, bool Normalized>
+void convert(AccessorComponentType type,
+             const unsigned char* src,
+             size_t srcStride,
+             size_t count,
+             unsigned char* dst,
+             size_t dstStride) {
+    switch (type) {
+        case AccessorComponentType::Byte:
+            convert<int8_t, D, N, Normalized>(src, srcStride, count, dst, dstStride);
+            break;
+        case AccessorComponentType::UnsignedByte:
+            convert<uint8_t, D, N, Normalized>(src, srcStride, count, dst, dstStride);
+            break;
+        case AccessorComponentType::Short:
+            convert<int16_t, D, N, Normalized>(src, srcStride, count, dst, dstStride);
+            break;
+        case AccessorComponentType::UnsignedShort:
+            convert<uint16_t, D, N, Normalized>(src, srcStride, count, dst, dstStride);
+            break;
+        case AccessorComponentType::UnsignedInt:
+            convert<uint32_t, D, N, Normalized>(src, srcStride, count, dst, dstStride);
+            break;
+        case AccessorComponentType::Float:
+            convert<float, D, N, Normalized>(src, srcStride, count, dst, dstStride);
+            break;
+    }
+}
+
+template <typename D, uint32_t N>
+void convert(const AccessorView& view,
+             const unsigned char* src,
+             size_t srcStride,
+             size_t count,
+             unsigned char* dst,
+             size_t dstStride) {
+    // NOTE: 整数で受け取る場合 (JOINTS_0 など) は正規化しない
+    if constexpr (std::is_floating_point_v<D>) {
+        if (view.normalized) {
+            convert<D, N, true>(view.componentType, src, srcStride, count, dst, dstStride);
+            return;
+        }
+    }
+    convert<D, N, false>(view.componentType, src, srcStride, count, dst, dstStride);
+}
+
+inline size_t readIndex(AccessorComponentType type, const unsigned char* data, size_t i) {
+    switch (type) {
+        case AccessorComponentType::UnsignedByte:
+            return data[i];
+        case AccessorComponentType::UnsignedShort: {
+            uint16_t index;
+            std::memcpy(&index, data + i * sizeof(index), sizeof(index));
+            return index;
+        }
+        default: {
+            uint32_t index;
+            std::memcpy(&index, data + i * sizeof(index), sizeof(index));
+            return index;
+        }
+    }
+}
+}  // namespace accessor_detail
+
+// アクセサの要素を N 成分の D (float か uint32_t) として読み出し、
+// dst から dstStride バイトおきに書き込む
+// NOTE: dst は view.count 個の要素を書き込めること。構造体の配列のメンバにも直接書き込める
+template <typename D, uint32_t N>
+void readAccessor(const AccessorView& view,
+                  D* dst,
+                  size_t dstStride,
+                  const AccessorSparseView& sparse = {}) {
+    auto* out = reinterpret_cast<unsigned char*>(dst);
+    if (view.data) {
+        size_t srcStride =
+            view.byteStride == 0 ? getComponentSize(view.componentType) * N : view.byteStride;
+        accessor_detail::convert<D, N>(view, view.data, srcStride, view.count, out, dstStride);
+    } else {
+        for (size_t i = 0; i < view.count; i++) {
+            std::memset(out + i * dstStride, 0, sizeof(D) * N);
+        }
+    }
+
+    // 疎な値を上書きする (範囲外の番号は無視する)
+    size_t valueStride = getComponentSize(view.componentType) * N;
+    for (size_t i = 0; i < sparse.count; i++) {
+        size_t index = accessor_detail::readIndex(sparse.indexComponentType, sparse.indices, i);
+        if (index < view.count) {
+            accessor_detail::convert<D, N>(view, sparse.values + i * valueStride, valueStride, 1,
+                                           out + index * dstStride, dstStride);
+        }
+    }
+}
@@ -0,0 +1,507 @@
+#pragma once
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// glTF のサンプラーの補間方法
+enum class Interpolation : uint8_t {
+    Linear,
+    Step,
+    CubicSpline,
+};
+
+// アニメーションの更新頻度 (アニメーション LOD)
+// NOTE: 再生時刻から直接サンプリングするため、間引いたり止めたりしても
+//       次に更新したときにはその時刻の姿勢に戻る (再開時に巻き戻しや早送りは要らない)
+enum class AnimationRate : uint8_t {
+    Auto,       // 可視性と画面上の大きさから決める
+    Full,       // 毎フレーム
+    Half,       // 2 フレームに 1 回
+    Quarter,    // 4 フレームに 1 回
+    Sixteenth,  // 16 フレームに 1 回
+    Paused,     // 更新しない
+};
+
+struct AnimationLodSettings {
+    bool enabled = true;
+    float halfRateSize = 0.1f;      // 画面の高さに対する大きさがこれより小さければ Half
+    float quarterRateSize = 0.03f;  // これより小さければ Quarter
+};
+
+// バウンディング球の画面上の大きさ (直径 / 画面の高さ)
+// projScaleY は射影行列の [1][1] (= 1 / tan(fovY / 2))
+inline float computeScreenSize(float radius, float distance, float projScaleY) {
+    if (distance <= radius) {
+        return 1.0f;  // カメラが球の中にある
+    }
+    return radius * projScaleY / distance;
+}
+
+inline AnimationRate chooseAnimationRate(bool visible,
+                                         float screenSize,
+                                         const AnimationLodSettings& settings) {
+    if (!settings.enabled) {
+        return AnimationRate::Full;
+    }
+    // NOTE: 視錐台の外でも止めない。可視性は前フレームの AABB で判定するため、
+    //       止めると自身のアニメーションで視界に入ってくるオブジェクトがずっと外に残る
+    if (!visible) {
+        return AnimationRate::Sixteenth;
+    }
+    if (screenSize < settings.quarterRateSize) {
+        return AnimationRate::Quarter;
+    }
+    if (screenSize < settings.halfRateSize) {
+        return AnimationRate::Half;
+    }
+    return AnimationRate::Full;
+}
+
+// このフレームに更新するか
+// NOTE: 同じ頻度のオブジェクトが同じフレームに集中しないよう、staggerKey でフレームをずらす
+//       一緒に動くもの (同じメッシュを動かす関節など) は同じキーにして、同じフレームに更新する
+inline bool shouldUpdateAnimation(AnimationRate rate, uint64_t frame, uint32_t staggerKey) {
+    switch (rate) {
+        case AnimationRate::Auto:
+        case AnimationRate::Full:
+            return true;
+        case AnimationRate::Half:
+            return (frame + staggerKey) % 2 == 0;
+        case AnimationRate::Quarter:
+            return (frame + staggerKey) % 4 == 0;
+        case AnimationRate::Sixteenth:
+            return (frame + staggerKey) % 16 == 0;
+        case AnimationRate::Paused:
+            return false;
+    }
+    return true;
+}
+
+// 同じ型の値を持つトラックをまとめて保持する (SoA)
+// translation / rotation / scale はそれぞれ独立した時間軸を持つため、チャンネルごとに別のトラックにする
+// キーの時刻と値は全トラック分を一つの配列に詰め、トラックは先頭位置と個数だけを持つ
+// NOTE: 前回のキーの位置 (カーソル) を覚えておき、時間が進んだ分だけ前に進める
+//       巻き戻ったとき (ループなど) や大きく進んだときだけ二分探索する
+template <typename T>
+class AnimationTracks {
+public:
+    static constexpr uint32_t invalidTarget = std::numeric_limits<uint32_t>::max();
+
+    // NOTE: CUBICSPLINE の values は (inTangent, value, outTangent) の順に3つずつ並ぶ
+    void add(uint32_t target,
+             Interpolation interpolation,
+             std::span<const float> times,
+             std::span<const T> values) {
+        uint32_t valuesPerKey = interpolation == Interpolation::CubicSpline ? 3 : 1;
+        assert(!times.empty());
+        assert(values.size() == times.size() * valuesPerKey);
+
+        targets.push_back(target);
+        interpolations.push_back(interpolation);
+        firstKeys.push_back(static_cast<uint32_t>(keyTimes.size()));
+        keyCounts.push_back(static_cast<uint32_t>(times.size()));
+        firstValues.push_back(static_cast<uint32_t>(keyValues.size()));
+        cursors.push_back(0);
+        results.push_back(values[valuesPerKey / 2]);
+
+        keyTimes.insert(keyTimes.end(), times.begin(), times.end());
+        keyValues.insert(keyValues.end(), values.begin(), values.end());
+        duration = std::max(duration, times.back());
+    }
+
+    // [begin, end) のトラックを time でサンプリングし、結果を results に書き込む
+    // NOTE: 範囲ごとに別のスレッドから呼んでよい
+    void sample(float time, uint32_t begin, uint32_t end) {
+        for (uint32_t track = begin; track < end; track++) {
+            results[track] = sampleTrack(track, time);
+        }
+    }
+
+    // shouldSample(target) が false のトラックは飛ばし、結果を前回のまま残す
+    template <typename ShouldSample>
+    void sample(float time, uint32_t begin, uint32_t end, ShouldSample&& shouldSample) {
+        for (uint32_t track = begin; track < end; track++) {
+            if (targets[track] != invalidTarget && shouldSample(targets[track])) {
+                results[track] = sampleTrack(track, time);
+            }
+        }
+    }
+
+    // 削除されたオブジェクトを対象にしているトラックを無効にする
+    void removeTarget(uint32_t target) {
+        std::ranges::replace(targets, target, invalidTarget);
+    }
+
+    uint32_t size() const {
+        return static_cast<uint32_t>(targets.size());
+    }
+
+    float getDuration() const {
+        return duration;
+    }
+
+    std::span<const uint32_t> getTargets() const {
+        return targets;
+    }
+
+    std::span<const T> getResults() const {
+        return results;
+    }
+
+    // トラックごとに (対象, 補間, キーの時刻, 値) を列挙する
+    // NOTE: 値は add() に渡したものと同じ並び
+    template <typename Function>
+    void forEachTrack(Function&& function) const {
+        for (uint32_t track = 0; track < size(); track++) {
+            uint32_t valuesPerKey = interpolations[track] == Interpolation::CubicSpline ? 3 : 1;
+            std::span<const float> times{&keyTimes[firstKeys[track]], keyCounts[track]};
+            std::span<const T> values{&keyValues[firstValues[track]],
+                                      keyCounts[track] * valuesPerKey};
+            function(targets[track], interpolations[track], times, values);
+        }
+    }
+
+private:
+    T sampleTrack(uint32_t track, float time) {
+        const float* times = &keyTimes[firstKeys[track]];
+        const T* values = &keyValues[firstValues[track]];
+        uint32_t count = keyCounts[track];
+        Interpolation interpolation = interpolations[track];
+        uint32_t stride = interpolation == Interpolation::CubicSpline ? 3 : 1;
+        uint32_t center = stride / 2;
+
+        // 範囲外は端のキーの値で止める
+        if (time <= times[0]) {
+            cursors[track] = 0;
+            return values[center];
+        }
+        if (time >= times[count - 1]) {
+            cursors[track] = count - 1;
+            return values[(count - 1) * stride + center];
+        }
+
+        // times[cursor] <= time < times[cursor + 1] となる位置を探す
+        // NOTE: 止めていたトラックを再開したときのように、大きく進んだ場合も二分探索する
+        uint32_t cursor = cursors[track];
+        if (cursor >= count - 1 || time < times[cursor] ||
+            (cursor + 2 < count && time >= times[cursor + 2])) {
+            cursor = static_cast<uint32_t>(std::upper_bound(times, times + count, time) - times) - 1;
+        }
+        while (time >= times[cursor + 1]) {
+            cursor++;
+        }
+        cursors[track] = cursor;
+
+        float interval = times[cursor + 1] - times[cursor];
+        float t = (time - times[cursor]) / interval;
+        const T* key = &values[cursor * stride];
+        switch (interpolation) {
+            case Interpolation::Step:
+                return key[0];
+            case Interpolation::Linear:
+                if constexpr (std::is_same_v<T, glm::quat>) {
+                    return glm::slerp(key[0], key[1], t);
+                } else {
+                    return glm::mix(key[0], key[1], t);
+                }
+            case Interpolation::CubicSpline: {
+                // エルミート補間 (glTF 仕様 Appendix C)
+                // NOTE: 接線は秒あたりの値なので、キーの間隔を掛けて使う
+                float t2 = t * t;
+                float t3 = t2 * t;
+                const T& v0 = key[1];
+                const T& b0 = key[2];
+                const T& a1 = key[3];
+                const T& v1 = key[4];
+                T value = (2.0f * t3 - 3.0f * t2 + 1.0f) * v0 +
+                          (t3 - 2.0f * t2 + t) * interval * b0 +
+                          (-2.0f * t3 + 3.0f * t2) * v1 + (t3 - t2) * interval * a1;
+                if constexpr (std::is_same_v<T, glm::quat>) {
+                    return glm::normalize(value);
+                } else {
+                    return value;
+                }
+            }
+        }
+        return key[0];
+    }
+
+    // トラックごとの情報
+    std::vector<uint32_t> targets;  // object index
+    std::vector<Interpolation> interpolations;
+    std::vector<uint32_t> firstKeys;
+    std::vector<uint32_t> keyCounts;
+    std::vector<uint32_t> firstValues;
+    std::vector<uint32_t> cursors;
+    std::vector<T> results;
+
+    // 全トラックのキー
+    std::vector<float> keyTimes;
+    std::vector<T> keyValues;
+
+    float duration = 0.0f;
+};
+
+// glTF の animation 一つ分
+struct AnimationClip {
+    std::string name;
+    AnimationTracks<glm::vec3> translations;
+    AnimationTracks<glm::quat> rotations;
+    AnimationTracks<glm::vec3> scales;
+
+    // モーフターゲットのウェイト (ターゲット一つにつき一つのトラック)
+    // NOTE: 対象はオブジェクトではなく Scene の MorphWeights 上の位置
+    AnimationTracks<float> weights;
+
+    float getDuration() const {
+        return std::max({translations.getDuration(), rotations.getDuration(),
+                         scales.getDuration(), weights.getDuration()});
+    }
+
+    // NOTE: weights はオブジェクトを対象にしないので含めない
+    void removeTarget(uint32_t objectIndex) {
+        translations.removeTarget(objectIndex);
+        rotations.removeTarget(objectIndex);
+        scales.removeTarget(objectIndex);
+    }
+};
+
+// 焼き込んだトラック一つ分 (GPU でもそのまま読む)
+struct BakedTrack {
+    uint32_t firstFrame = 0;
+    uint32_t frameCount = 0;
+    float frameRate = 0.0f;
+    float duration = 0.0f;
+};
+
+// 焼き込んだトラックの行列が全フレームで取る範囲 (CPU でのカリング用)
+// NOTE: 平行移動と、回転・拡大縮小の部分の成分ごとの最小・最大を持つ
+struct BakedTrackBounds {
+    static constexpr float lowest = std::numeric_limits<float>::lowest();
+    static constexpr float highest = std::numeric_limits<float>::max();
+
+    glm::vec3 minTranslation{highest};
+    glm::vec3 maxTranslation{lowest};
+    glm::mat3 minLinear{glm::vec3{highest}, glm::vec3{highest}, glm::vec3{highest}};
+    glm::mat3 maxLinear{glm::vec3{lowest}, glm::vec3{lowest}, glm::vec3{lowest}};
+};
+
+// GPU で再生するインスタンス (メッシュを持つオブジェクト) 一つ分 (GPU でもそのまま読む)
+// ワールド行列は preMatrix * トラックの行列 * postMatrix
+// NOTE: preMatrix はアニメーションするオブジェクトの親のワールド行列、
+//       postMatrix はアニメーションするオブジェクトからメッシュを持つオブジェクトまでの相対行列
+struct BakedAnimationInstance {
+    glm::mat4 preMatrix{1.0f};
+    glm::mat4 postMatrix{1.0f};
+    uint32_t objectIndex = 0;
+    uint32_t track = 0;
+    float timeOffset = 0.0f;  // 秒
+    float _dummy{};
+};
+
+// クリップのトラックを一定間隔でサンプリングしたローカル行列に焼き込む
+// 同じ動きをする大量のオブジェクト (群衆など) は CPU でサンプリングせず、
+// コンピュートシェーダが再生時刻とインスタンスごとのずれから行列を求めて ObjectData に書き込む
+// NOTE: フレーム間は行列の線形補間で近似する。回転が速いトラックはフレームレートを上げること
+class BakedAnimation {
+public:
+    static constexpr uint32_t invalidTrack = std::numeric_limits<uint32_t>::max();
+
+    // clip の中で target を対象にしているトラックを焼き込み、焼き込んだトラックの番号を返す
+    // NOTE: クリップが持たないチャンネルは rest の値のまま。どのチャンネルも無ければ invalidTrack
+    uint32_t bake(AnimationClip& clip,
+                  uint32_t target,
+                  float frameRate,
+                  const glm::vec3& restTranslation,
+                  const glm::quat& restRotation,
+                  const glm::vec3& restScale) {
+        auto findTrack = [target](const auto& animationTracks) {
+            std::span<const uint32_t> targets = animationTracks.getTargets();
+            auto it = std::ranges::find(targets, target);
+            return it == targets.end() ? invalidTrack
+                                       : static_cast<uint32_t>(it - targets.begin());
+        };
+        uint32_t translationTrack = findTrack(clip.translations);
+        uint32_t rotationTrack = findTrack(clip.rotations);
+        uint32_t scaleTrack = findTrack(clip.scales);
+        if (translationTrack == invalidTrack && rotationTrack == invalidTrack &&
+            scaleTrack == invalidTrack) {
+            return invalidTrack;
+        }
+
+        // NOTE: 最後のフレームがちょうど duration になるよう、フレームの間隔を揃え直す
+        BakedTrack track{};
+        track.firstFrame = static_cast<uint32_t>(frames.size());
+        track.duration = clip.getDuration();
+        track.frameCount = static_cast<uint32_t>(std::ceil(track.duration * frameRate)) + 1;
+        track.frameRate =
+            track.frameCount > 1 ? static_cast<float>(track.frameCount - 1) / track.duration
+                                 : frameRate;
+
+        auto sampleOrRest = [](auto& animationTracks, uint32_t index, float time,
+                               const auto& rest) {
+            if (index == invalidTrack) {
+                return rest;
+            }
+            animationTracks.sample(time, index, index + 1);
+            return animationTracks.getResults()[index];
+        };
+        BakedTrackBounds bounds{};
+        for (uint32_t frame = 0; frame < track.frameCount; frame++) {
+            float time = std::min(static_cast<float>(frame) / track.frameRate, track.duration);
+            glm::vec3 translation =
+                sampleOrRest(clip.translations, translationTrack, time, restTranslation);
+            glm::quat rotation = sampleOrRest(clip.rotations, rotationTrack, time, restRotation);
+            glm::vec3 scale = sampleOrRest(clip.scales, scaleTrack, time, restScale);
+            const glm::mat4& matrix =
+                frames.emplace_back(glm::translate(glm::mat4{1.0f}, translation) *
+                                    glm::mat4_cast(rotation) * glm::scale(glm::mat4{1.0f}, scale));
+
+            bounds.minTranslation = glm::min(bounds.minTranslation, translation);
+            bounds.maxTranslation = glm::max(bounds.maxTranslation, translation);
+            for (int column = 0; column < 3; column++) {
+                glm::vec3 linear{matrix[column]};
+                bounds.minLinear[column] = glm::min(bounds.minLinear[column], linear);
+                bounds.maxLinear[column] = glm::max(bounds.maxLinear[column], linear);
+            }
+        }
+        tracks.push_back(track);
+        trackBounds.push_back(bounds);
+        dirty = true;
+        return static_cast<uint32_t>(tracks.size() - 1);
+    }
+
+    // CPU でのサンプリング (GPU の baked_animation.comp と同じ計算)
+    // NOTE: テストや検証用の参照実装
+    glm::mat4 sample(uint32_t track, float time) const {
+        const BakedTrack& baked = tracks[track];
+        time = baked.duration > 0.0f ? std::fmod(time, baked.duration) : 0.0f;
+        if (time < 0.0f) {
+            time += baked.duration;
+        }
+        float frame = time * baked.frameRate;
+        uint32_t frame0 = std::min(static_cast<uint32_t>(frame), baked.frameCount - 1);
+        uint32_t frame1 = std::min(frame0 + 1, baked.frameCount - 1);
+        float t = frame - static_cast<float>(frame0);
+        const glm::mat4& matrix0 = frames[baked.firstFrame + frame0];
+        const glm::mat4& matrix1 = frames[baked.firstFrame + frame1];
+        return matrix0 * (1.0f - t) + matrix1 * t;
+    }
+
+    // 中心 center・半径 extents の箱をトラックの全フレームの行列で動かしたとき、
+    // それが通る範囲を包む箱を (min, max) で返す
+    // NOTE: フレーム間は行列の線形補間なので、各フレームで動かした箱の和からはみ出さない
+    //       行列の成分ごとの範囲で区間演算するので、回転が大きいトラックほど緩くなる
+    std::pair<glm::vec3, glm::vec3> computeBounds(uint32_t track,
+                                                  const glm::vec3& center,
+                                                  const glm::vec3& extents) const {
+        const BakedTrackBounds& bounds = trackBounds[track];
+        glm::vec3 min = bounds.minTranslation;
+        glm::vec3 max = bounds.maxTranslation;
+        for (int column = 0; column < 3; column++) {
+            glm::vec3 low = bounds.minLinear[column] * center[column];
+            glm::vec3 high = bounds.maxLinear[column] * center[column];
+            glm::vec3 maxAbs =
+                glm::max(glm::abs(bounds.minLinear[column]), glm::abs(bounds.maxLinear[column]));
+            min += glm::min(low, high) - maxAbs * extents[column];
+            max += glm::max(low, high) + maxAbs * extents[column];
+        }
+        return {min, max};
+    }
+
+    // 前回の読み出しから変更があったか (読み出すとリセットされる)
+    bool consumeDirty() {
+        bool wasDirty = dirty;
+        dirty = false;
+        return wasDirty;
+    }
+
+    std::span<const glm::mat4> getFrames() const {
+        return frames;
+    }
+
+    std::span<const BakedTrack> getTracks() const {
+        return tracks;
+    }
+
+    void clear() {
+        frames.clear();
+        tracks.clear();
+        trackBounds.clear();
+        dirty = true;
+    }
+
+private:
+    std::vector<glm::mat4> frames;  // 全トラック分のローカル行列
+    std::vector<BakedTrack> tracks;
+    std::vector<BakedTrackBounds> trackBounds;  // トラックごと
+    bool dirty = false;
+};
+
+// 再生中のクリップと再生時刻
+// NOTE: float で時間を蓄積すると長時間の再生で誤差が増えるため、double で持ち、
+//       サンプリングの直前にクリップの長さでループさせてから float にする
+class AnimationPlayer {
+public:
+    void addClip(AnimationClip&& clip) {
+        clips.push_back(std::move(clip));
+    }
+
+    void advance(double seconds) {
+        time += seconds;
+    }
+
+    // クリップの長さでループさせた再生時刻
+    float getClipTime() const {
+        const AnimationClip* clip = getActiveClip();
+        if (!clip || clip->getDuration() <= 0.0f) {
+            return 0.0f;
+        }
+        return static_cast<float>(std::fmod(time, static_cast<double>(clip->getDuration())));
+    }
+
+    AnimationClip* getActiveClip() {
+        return activeClip < clips.size() ? &clips[activeClip] : nullptr;
+    }
+
+    const AnimationClip* getActiveClip() const {
+        return activeClip < clips.size() ? &clips[activeClip] : nullptr;
+    }
+
+    void setActiveClip(uint32_t index) {
+        activeClip = index;
+        time = 0.0;
+    }
+
+    const std::vector<AnimationClip>& getClips() const {
+        return clips;
+    }
+
+    void removeTarget(uint32_t objectIndex) {
+        for (AnimationClip& clip : clips) {
+            clip.removeTarget(objectIndex);
+        }
+    }
+
+    void clear() {
+        clips.clear();
+        activeClip = 0;
+        time = 0.0;
+    }
+
+private:
+    std::vector<AnimationClip> clips;
+    uint32_t activeClip = 0;
+    double time = 0.0;
+};
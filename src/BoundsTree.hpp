@@ -0,0 +1,242 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+#include <reactive/Scene/AABB.hpp>
+
+// 動的なAABBの二分木 (Bounding volume hierarchy)
+// 葉にオブジェクトのAABBを持ち、内部ノードは子のAABBを包む
+// 葉が動いたときは祖先だけを包み直すため、根のAABBは常にシーン全体のぴったりした範囲になる
+class BoundsTree {
+public:
+    static constexpr uint32_t nullNode = std::numeric_limits<uint32_t>::max();
+
+    // 葉を追加し、そのノード番号を返す
+    // NOTE: ノード番号は remove するまで変わらない
+    uint32_t insert(const rv::AABB& aabb, uint32_t userData) {
+        uint32_t leaf = allocateNode();
+        nodes[leaf].box = toBox(aabb);
+        nodes[leaf].userData = userData;
+        insertLeaf(leaf);
+        leafCount++;
+        return leaf;
+    }
+
+    void remove(uint32_t leaf) {
+        assert(nodes[leaf].isLeaf());
+        removeLeaf(leaf);
+        freeNode(leaf);
+        leafCount--;
+    }
+
+    // 葉のAABBを更新する
+    // 元の位置と重なっていれば祖先を包み直すだけで済ませ、
+    // 離れた場所へ移動した場合は木の形が悪くならないよう挿入し直す
+    void update(uint32_t leaf, const rv::AABB& aabb) {
+        assert(nodes[leaf].isLeaf());
+        Box box = toBox(aabb);
+        bool overlaps = nodes[leaf].box.overlaps(box);
+        nodes[leaf].box = box;
+        if (overlaps) {
+            refit(nodes[leaf].parent);
+        } else {
+            removeLeaf(leaf);
+            insertLeaf(leaf);
+        }
+    }
+
+    bool empty() const {
+        return root == nullNode;
+    }
+
+    size_t size() const {
+        return leafCount;
+    }
+
+    // 全ての葉を包むAABB
+    rv::AABB getRootAABB() const {
+        if (root == nullNode) {
+            return rv::AABB{};
+        }
+        return toAABB(nodes[root].box);
+    }
+
+    rv::AABB getAABB(uint32_t node) const {
+        return toAABB(nodes[node].box);
+    }
+
+    uint32_t getUserData(uint32_t leaf) const {
+        return nodes[leaf].userData;
+    }
+
+    void clear() {
+        nodes.clear();
+        freeList.clear();
+        root = nullNode;
+        leafCount = 0;
+    }
+
+private:
+    struct Box {
+        glm::vec3 min{std::numeric_limits<float>::max()};
+        glm::vec3 max{-std::numeric_limits<float>::max()};
+
+        static Box merge(const Box& a, const Box& b) {
+            return {glm::min(a.min, b.min), glm::max(a.max, b.max)};
+        }
+
+        // 挿入先を選ぶためのコスト (表面積の半分)
+        float getArea() const {
+            glm::vec3 d = max - min;
+            return d.x * d.y + d.y * d.z + d.z * d.x;
+        }
+
+        bool overlaps(const Box& other) const {
+            return glm::all(glm::lessThanEqual(min, other.max)) &&
+                   glm::all(glm::lessThanEqual(other.min, max));
+        }
+
+        bool operator==(const Box& other) const = default;
+    };
+
+    struct Node {
+        Box box{};
+        uint32_t parent = nullNode;
+        uint32_t child0 = nullNode;
+        uint32_t child1 = nullNode;
+        uint32_t userData = 0;
+
+        bool isLeaf() const {
+            return child0 == nullNode;
+        }
+    };
+
+    static Box toBox(const rv::AABB& aabb) {
+        return {aabb.center - aabb.extents, aabb.center + aabb.extents};
+    }
+
+    static rv::AABB toAABB(const Box& box) {
+        return rv::AABB{box.min, box.max};
+    }
+
+    uint32_t allocateNode() {
+        if (!freeList.empty()) {
+            uint32_t node = freeList.back();
+            freeList.pop_back();
+            nodes[node] = Node{};
+            return node;
+        }
+        nodes.emplace_back();
+        return static_cast<uint32_t>(nodes.size() - 1);
+    }
+
+    void freeNode(uint32_t node) {
+        freeList.push_back(node);
+    }
+
+    // 表面積の増加が最も小さくなる兄弟を探して葉を繋ぐ
+    void insertLeaf(uint32_t leaf) {
+        nodes[leaf].parent = nullNode;
+        if (root == nullNode) {
+            root = leaf;
+            return;
+        }
+
+        const Box& leafBox = nodes[leaf].box;
+        uint32_t sibling = root;
+        while (!nodes[sibling].isLeaf()) {
+            const Node& node = nodes[sibling];
+            float area = node.box.getArea();
+            float combinedArea = Box::merge(node.box, leafBox).getArea();
+
+            // ここに新しい親を作るコストと、子へ降りた場合に祖先が広がるコスト
+            float cost = 2.0f * combinedArea;
+            float inheritanceCost = 2.0f * (combinedArea - area);
+
+            auto descendCost = [&](uint32_t child) {
+                const Box& childBox = nodes[child].box;
+                float mergedArea = Box::merge(childBox, leafBox).getArea();
+                if (nodes[child].isLeaf()) {
+                    return mergedArea + inheritanceCost;
+                }
+                return mergedArea - childBox.getArea() + inheritanceCost;
+            };
+            float cost0 = descendCost(node.child0);
+            float cost1 = descendCost(node.child1);
+
+            if (cost < cost0 && cost < cost1) {
+                break;
+            }
+            sibling = cost0 < cost1 ? node.child0 : node.child1;
+        }
+
+        // sibling と leaf をまとめる親を作る
+        uint32_t oldParent = nodes[sibling].parent;
+        uint32_t newParent = allocateNode();
+        nodes[newParent].parent = oldParent;
+        nodes[newParent].child0 = sibling;
+        nodes[newParent].child1 = leaf;
+        nodes[newParent].box = Box::merge(nodes[sibling].box, nodes[leaf].box);
+        nodes[sibling].parent = newParent;
+        nodes[leaf].parent = newParent;
+
+        if (oldParent == nullNode) {
+            root = newParent;
+        } else if (nodes[oldParent].child0 == sibling) {
+            nodes[oldParent].child0 = newParent;
+        } else {
+            nodes[oldParent].child1 = newParent;
+        }
+
+        refit(oldParent);
+    }
+
+    // 葉を外し、不要になった親を兄弟で置き換える
+    // NOTE: 葉のノード自体は解放しない
+    void removeLeaf(uint32_t leaf) {
+        if (leaf == root) {
+            root = nullNode;
+            return;
+        }
+
+        uint32_t parent = nodes[leaf].parent;
+        uint32_t grandParent = nodes[parent].parent;
+        uint32_t sibling = nodes[parent].child0 == leaf ? nodes[parent].child1  //
+                                                        : nodes[parent].child0;
+        if (grandParent == nullNode) {
+            root = sibling;
+            nodes[sibling].parent = nullNode;
+        } else {
+            if (nodes[grandParent].child0 == parent) {
+                nodes[grandParent].child0 = sibling;
+            } else {
+                nodes[grandParent].child1 = sibling;
+            }
+            nodes[sibling].parent = grandParent;
+            refit(grandParent);
+        }
+        freeNode(parent);
+        nodes[leaf].parent = nullNode;
+    }
+
+    // node から根に向かって包み直す
+    // 範囲が変わらなくなった時点で打ち切る
+    void refit(uint32_t node) {
+        while (node != nullNode) {
+            Node& current = nodes[node];
+            Box box = Box::merge(nodes[current.child0].box, nodes[current.child1].box);
+            if (box == current.box) {
+                break;
+            }
+            current.box = box;
+            node = current.parent;
+        }
+    }
+
+    std::vector<Node> nodes;
+    std::vector<uint32_t> freeList;
+    uint32_t root = nullNode;
+    size_t leafCount = 0;
+};
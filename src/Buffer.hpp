@@ -1,10 +1,22 @@
 #pragma once
 #include "../shader/standard.glsl"
-#include "Scene.hpp"
+#include "RenderSnapshot.hpp"
 
 struct ObjectDataBuffer {
     void init(const rv::Context& context) {
-        data.resize(maxObjectCount);
+        resize(context, initialCapacity);
+    }
+
+    bool needsResize(size_t objectCount) const {
+        return objectCount > data.size();
+    }
+
+    // NOTE: 古いバッファは破棄されるため、GPUが使用中でないことを呼び出し側で保証すること
+    //       また、ディスクリプタセットも張り替える必要がある
+    void resize(const rv::Context& context, size_t objectCount) {
+        // 頻繁な作り直しを避けるため倍々で拡張する
+        size_t capacity = std::max(objectCount, data.size() * 2);
+        data.resize(capacity);
         buffer = context.createBuffer({
             .usage = rv::BufferUsage::Storage,
             .memory = rv::MemoryUsage::Device,
@@ -17,35 +29,40 @@ struct ObjectDataBuffer {
         std::ranges::fill(data, ObjectData{});
     }
 
-    void update(const rv::CommandBuffer& commandBuffer, Scene& scene) {
-        auto& objects = scene.getObjects();
-        for (uint32_t index : scene.getUpdatedObjectIndices()) {
-            auto& object = objects[index];
-            auto* mesh = object.get<Mesh>();
-            auto* transform = object.get<Transform>();
-            if (!mesh) {
-                return;
-            }
+    void update(const rv::CommandBuffer& commandBuffer, const RenderSnapshot& snapshot) {
+        // 削除されたスロットは初期値に戻して無効化する
+        // NOTE: 描画はメッシュを持つオブジェクトだけを走査するため、無効なスロットは参照されない
+        //       スロットは再利用されるので、同じフレームで追加されたものは下で上書きされる
+        for (uint32_t index : snapshot.removedObjectIndices) {
+            data[index] = ObjectData{};
+        }
+
+        // 変更の種類に応じて必要な部分だけ書き換える
+        // NOTE: マテリアルの編集では行列を、移動ではマテリアルを書き直さない
+        for (const ObjectDataUpdate& update : snapshot.objectDataUpdates) {
+            ObjectData& dst = data[update.objectIndex];
+            const ObjectData& src = update.data;
 
             // TODO: マテリアル情報はバッファを分けてGPU側でインデックス参照する
             //       materialIndexはpushConstantでもいいかも
-            if (Material* material = mesh->material) {
-                data[index].baseColor = material->baseColor;
-                data[index].emissive.xyz = material->emissive;
-                data[index].metallic = material->metallic;
-                data[index].roughness = material->roughness;
-                data[index].ior = material->ior;
-                data[index].baseColorTextureIndex = material->baseColorTextureIndex;
-                data[index].metallicRoughnessTextureIndex = material->metallicRoughnessTextureIndex;
-                data[index].normalTextureIndex = material->normalTextureIndex;
-                data[index].occlusionTextureIndex = material->occlusionTextureIndex;
-                data[index].emissiveTextureIndex = material->emissiveTextureIndex;
-                data[index].enableNormalMapping = static_cast<int>(material->enableNormalMapping);
+            if (update.fields & ChangeField::Material) {
+                dst.baseColor = src.baseColor;
+                dst.emissive = src.emissive;
+                dst.metallic = src.metallic;
+                dst.roughness = src.roughness;
+                dst.ior = src.ior;
+                dst.baseColorTextureIndex = src.baseColorTextureIndex;
+                dst.metallicRoughnessTextureIndex = src.metallicRoughnessTextureIndex;
+                dst.normalTextureIndex = src.normalTextureIndex;
+                dst.occlusionTextureIndex = src.occlusionTextureIndex;
+                dst.emissiveTextureIndex = src.emissiveTextureIndex;
+                dst.enableNormalMapping = src.enableNormalMapping;
             }
-            if (transform) {
-                const auto& model = transform->computeTransformMatrix();
-                data[index].modelMatrix = model;
-                data[index].normalMatrix = transform->computeNormalMatrix();
+            // NOTE: 親子関係を反映したワールド行列を使う
+            //       法線行列は Scene がワールド行列の変更時に計算したものを使う
+            if (update.fields & ChangeField::Transform) {
+                dst.modelMatrix = src.modelMatrix;
+                dst.normalMatrix = src.normalMatrix;
             }
         }
 
@@ -56,7 +73,7 @@ struct ObjectDataBuffer {
             vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead);
     }
 
-    int maxObjectCount = 1000;
+    size_t initialCapacity = 1000;
     std::vector<ObjectData> data{};
     rv::BufferHandle buffer;
 };
@@ -76,7 +93,7 @@ struct SceneDataBuffer {
     }
 
     void update(const rv::CommandBuffer& commandBuffer,
-                Scene& scene,
+                const RenderSnapshot& snapshot,
                 vk::Extent3D imageExtent,
                 bool enableFXAA,
                 bool enableSSR,
@@ -84,18 +101,12 @@ struct SceneDataBuffer {
                 float ssrIntensity) {
         // Update buffer
         // NOTE: Shadow map用の行列も更新するのでShadow map passより先に計算
-        Camera* camera = &scene.getDefaultCamera();
-        if (scene.isMainCameraAvailable()) {
-            camera = scene.getMainCamera();
-        }
-
-        const auto& view = camera->getView();
-        const auto& proj = camera->getProj();
-        data.cameraView = view;
-        data.cameraProj = proj;
-        data.cameraViewProj = proj * view;
+        const CameraSnapshot& camera = snapshot.camera;
+        data.cameraView = camera.view;
+        data.cameraProj = camera.proj;
+        data.cameraViewProj = camera.proj * camera.view;
         data.cameraInvViewProj = glm::inverse(data.cameraViewProj);
-        data.cameraPos.xyz = camera->getPosition();
+        data.cameraPos.xyz = camera.position;
 
         data.screenResolution.x = static_cast<float>(imageExtent.width);
         data.screenResolution.y = static_cast<float>(imageExtent.height);
@@ -104,21 +115,19 @@ struct SceneDataBuffer {
         data.exposure = exposure;
         data.ssrIntensity = ssrIntensity;
 
-        if (Object* dirLightObj = scene.findObject<DirectionalLight>()) {
-            DirectionalLight* dirLight = dirLightObj->get<DirectionalLight>();
+        if (const auto& dirLight = snapshot.directionalLight) {
             data.existDirectionalLight = true;
-            data.lightDirection.xyz = dirLight->getDirection();
+            data.lightDirection.xyz = dirLight->direction;
             data.lightColorIntensity.xyz = dirLight->color;
             data.lightColorIntensity.w = dirLight->intensity;
-            data.shadowViewProj = dirLight->getViewProj(scene.getAABB());
+            data.shadowViewProj = dirLight->viewProj;
             data.shadowBias = dirLight->shadowBias;
             data.enableShadowMapping = dirLight->enableShadow;
         } else {
             data.existDirectionalLight = false;
             data.enableShadowMapping = false;
         }
-        if (Object* ambLightObj = scene.findObject<AmbientLight>()) {
-            auto* light = ambLightObj->get<AmbientLight>();
+        if (const auto& light = snapshot.ambientLight) {
             data.ambientColorIntensity.xyz = light->color;
             data.ambientColorIntensity.w = light->intensity;
             data.irradianceTexture = light->irradianceTexture;
@@ -0,0 +1,143 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "JobSystem.hpp"
+#include "editor/Enums.hpp"
+
+// 変更のあったフィールドのまとまり
+// 利用側は必要な種類だけを見て、関係のない変更では処理を省く
+// NOTE: コンポーネントの型ではなく「オブジェクトの何が変わったか」を表す
+enum class ChangeField : uint32_t {
+    None = 0,
+    Transform = 1 << 0,  // ワールド行列 (親が動いた場合も含む)
+    Material = 1 << 1,
+    Geometry = 1 << 2,  // 描画範囲やローカルAABB
+    Light = 1 << 3,
+    Camera = 1 << 4,
+    All = ~0u,  // コンポーネントの追加時
+};
+
+using ChangeFlags = Flags<ChangeField>;
+
+struct ChangeRecord {
+    uint32_t objectIndex;
+    uint32_t componentID;
+    ChangeFlags fields;
+};
+
+// フレーム内の変更の記録
+// コンポーネントは変更したときに (オブジェクト, コンポーネント, フィールド) を記録し、
+// 利用側は全オブジェクトを走査する代わりに記録だけを読む
+// また、型ごとにオブジェクトのビット集合を持ち、特定の変更の有無を O(1) で確認できる
+class ChangeJournal {
+public:
+    void init(uint32_t componentCount, uint32_t threadCount) {
+        dirtyBits.assign(componentCount, {});
+        dirtyFields.assign(componentCount, ChangeField::None);
+        pendingRecords.resize(threadCount);
+    }
+
+    // NOTE: ワーカースレッドからも呼べるよう、スレッドごとのバッファに追記する
+    void record(uint32_t objectIndex, uint32_t componentID, ChangeFlags fields) {
+        pendingRecords.local().push_back({objectIndex, componentID, fields});
+    }
+
+    // スレッドごとの記録をまとめ、同じ (オブジェクト, コンポーネント) の記録を一つにする
+    // NOTE: 記録するジョブが走っていないときにメインスレッドから呼ぶこと
+    void flush() {
+        pendingRecords.forEach([this](std::vector<ChangeRecord>& pending) {
+            records.insert(records.end(), pending.begin(), pending.end());
+            pending.clear();
+        });
+        if (records.empty()) {
+            return;
+        }
+
+        std::ranges::sort(records, [](const ChangeRecord& a, const ChangeRecord& b) {
+            return a.objectIndex != b.objectIndex ? a.objectIndex < b.objectIndex
+                                                  : a.componentID < b.componentID;
+        });
+        size_t count = 1;
+        for (size_t i = 1; i < records.size(); i++) {
+            ChangeRecord& last = records[count - 1];
+            if (records[i].objectIndex == last.objectIndex &&
+                records[i].componentID == last.componentID) {
+                last.fields |= records[i].fields;
+            } else {
+                records[count++] = records[i];
+            }
+        }
+        records.erase(records.begin() + static_cast<ptrdiff_t>(count), records.end());
+
+        for (const ChangeRecord& record : records) {
+            std::vector<uint64_t>& bits = dirtyBits[record.componentID];
+            uint32_t word = record.objectIndex / 64;
+            if (word >= bits.size()) {
+                bits.resize(word + 1, 0);
+            }
+            bits[word] |= uint64_t{1} << (record.objectIndex % 64);
+            dirtyFields[record.componentID] |= record.fields;
+        }
+    }
+
+    // オブジェクトインデックス順に並んだ記録 (flush 後)
+    std::span<const ChangeRecord> getRecords() const {
+        return records;
+    }
+
+    bool isDirty(uint32_t componentID, uint32_t objectIndex) const {
+        const std::vector<uint64_t>& bits = dirtyBits[componentID];
+        uint32_t word = objectIndex / 64;
+        return word < bits.size() && (bits[word] >> (objectIndex % 64) & 1) != 0;
+    }
+
+    // その型のいずれかのコンポーネントで fields のどれかが変更されたか
+    bool isDirty(uint32_t componentID, ChangeFlags fields) const {
+        return dirtyFields[componentID] & fields;
+    }
+
+    // 削除されたオブジェクトの記録を捨てる
+    void discard(uint32_t objectIndex) {
+        auto isRemoved = [objectIndex](const ChangeRecord& record) {
+            return record.objectIndex == objectIndex;
+        };
+        pendingRecords.forEach(
+            [&](std::vector<ChangeRecord>& pending) { std::erase_if(pending, isRemoved); });
+        for (const ChangeRecord& record : records) {
+            if (record.objectIndex == objectIndex) {
+                clearBit(record);
+            }
+        }
+        std::erase_if(records, isRemoved);
+    }
+
+    // 前のフレームの記録を捨てる
+    // NOTE: まだ flush していない記録は次のフレームに持ち越す
+    void clearRecords() {
+        for (const ChangeRecord& record : records) {
+            clearBit(record);
+        }
+        records.clear();
+        std::ranges::fill(dirtyFields, ChangeFlags{ChangeField::None});
+    }
+
+    void clear() {
+        clearRecords();
+        pendingRecords.forEach([](std::vector<ChangeRecord>& pending) { pending.clear(); });
+    }
+
+private:
+    void clearBit(const ChangeRecord& record) {
+        dirtyBits[record.componentID][record.objectIndex / 64] &=
+            ~(uint64_t{1} << (record.objectIndex % 64));
+    }
+
+    std::vector<ChangeRecord> records;
+    PerThread<std::vector<ChangeRecord>> pendingRecords;
+
+    std::vector<std::vector<uint64_t>> dirtyBits;  // component ID -> object index -> bit
+    std::vector<ChangeFlags> dirtyFields;          // component ID -> fields
+};
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+
+template <typename... Ts>
+struct TypeList {
+    static constexpr uint32_t size = sizeof...(Ts);
+};
+
+template <typename T, typename List>
+struct TypeIndex;
+
+template <typename T, typename... Ts>
+struct TypeIndex<T, TypeList<T, Ts...>> {
+    static constexpr uint32_t value = 0;
+};
+
+template <typename T, typename U, typename... Ts>
+struct TypeIndex<T, TypeList<U, Ts...>> {
+    static constexpr uint32_t value = 1 + TypeIndex<T, TypeList<Ts...>>::value;
+};
+
+template <typename T>
+struct TypeIndex<T, TypeList<>> {
+    static_assert(!std::is_same_v<T, T>, "T is not registered in the type list");
+};
+
+// コンポーネントの型ごとにコンパイル時に決まるIDを割り当てる
+// IDはリスト内の位置なので、型の定義が無くても前方宣言だけで求められる
+// オブジェクトは持っているコンポーネントをIDのビットマスクで保持し、
+// Scene はIDで添字アクセスする固定長配列にプールを並べる
+template <typename List>
+struct ComponentRegistry {
+    using Mask = uint32_t;
+
+    static constexpr uint32_t count = List::size;
+    static_assert(count <= sizeof(Mask) * 8, "Too many component types for the mask");
+
+    template <typename T>
+    static constexpr uint32_t id = TypeIndex<std::remove_cv_t<T>, List>::value;
+
+    template <typename T>
+    static constexpr Mask bit = Mask{1} << id<T>;
+};
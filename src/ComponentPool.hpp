@@ -0,0 +1,210 @@
+#pragma once
+#include <limits>
+#include <tuple>
+#include <vector>
+
+#include "JobSystem.hpp"
+#include "Object.hpp"
+
+class ComponentPoolBase {
+public:
+    virtual ~ComponentPoolBase() = default;
+
+    virtual Component* getComponent(uint32_t objectIndex) = 0;
+
+    virtual void remove(uint32_t objectIndex) = 0;
+
+    virtual void clear() = 0;
+
+    // 全コンポーネントを更新する
+    // NOTE: 変更はコンポーネント自身が Scene::markChanged() で記録する
+    virtual void update(Scene& scene, JobSystem& jobSystem, float dt) = 0;
+
+    virtual bool updatesOnMainThread() const = 0;
+};
+
+// Sparse set によるコンポーネントの格納
+// 同じ型のコンポーネントは components に密に詰めて保持し、
+// オブジェクトインデックスからの参照は sparse 配列で解決する
+template <typename T>
+class ComponentPool final : public ComponentPoolBase {
+public:
+    static constexpr uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+
+    template <typename... Args>
+    T& emplace(uint32_t objectIndex, Args&&... args) {
+        if (objectIndex >= sparse.size()) {
+            sparse.resize(objectIndex + 1, invalidIndex);
+        }
+        sparse[objectIndex] = static_cast<uint32_t>(components.size());
+        objectIndices.push_back(objectIndex);
+        return components.emplace_back(std::forward<Args>(args)...);
+    }
+
+    bool contains(uint32_t objectIndex) const {
+        return objectIndex < sparse.size() && sparse[objectIndex] != invalidIndex;
+    }
+
+    T* get(uint32_t objectIndex) {
+        if (!contains(objectIndex)) {
+            return nullptr;
+        }
+        return &components[sparse[objectIndex]];
+    }
+
+    const T* get(uint32_t objectIndex) const {
+        if (!contains(objectIndex)) {
+            return nullptr;
+        }
+        return &components[sparse[objectIndex]];
+    }
+
+    // NOTE: 存在確認は呼び出し側で済ませておくこと (Object のマスクなど)
+    T& getUnchecked(uint32_t objectIndex) {
+        return components[sparse[objectIndex]];
+    }
+
+    const T& getUnchecked(uint32_t objectIndex) const {
+        return components[sparse[objectIndex]];
+    }
+
+    Component* getComponent(uint32_t objectIndex) override {
+        return get(objectIndex);
+    }
+
+    // 末尾の要素と入れ替えて削除するため、密な配列の順序は保たれない
+    void remove(uint32_t objectIndex) override {
+        if (!contains(objectIndex)) {
+            return;
+        }
+        uint32_t denseIndex = sparse[objectIndex];
+        uint32_t lastIndex = static_cast<uint32_t>(components.size() - 1);
+        if (denseIndex != lastIndex) {
+            components[denseIndex] = std::move(components[lastIndex]);
+            objectIndices[denseIndex] = objectIndices[lastIndex];
+            sparse[objectIndices[denseIndex]] = denseIndex;
+        }
+        components.pop_back();
+        objectIndices.pop_back();
+        sparse[objectIndex] = invalidIndex;
+    }
+
+    void clear() override {
+        components.clear();
+        objectIndices.clear();
+        sparse.clear();
+    }
+
+    void update(Scene& scene, JobSystem& jobSystem, float dt) override {
+        auto updateRange = [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                // NOTE: 型が確定しているので仮想呼び出しを避ける
+                components[i].T::update(scene, dt);
+            }
+        };
+
+        uint32_t count = static_cast<uint32_t>(components.size());
+        if constexpr (T::updateOnMainThread) {
+            updateRange(0, count);
+        } else {
+            jobSystem.parallelFor(count, updateChunkSize, updateRange);
+        }
+    }
+
+    bool updatesOnMainThread() const override {
+        return T::updateOnMainThread;
+    }
+
+    size_t size() const {
+        return components.size();
+    }
+
+    std::vector<T>& getComponents() {
+        return components;
+    }
+
+    const std::vector<uint32_t>& getObjectIndices() const {
+        return objectIndices;
+    }
+
+private:
+    // 1ジョブあたりのコンポーネント数
+    static constexpr uint32_t updateChunkSize = 256;
+
+    std::vector<T> components;
+    std::vector<uint32_t> objectIndices;  // dense index -> object index
+    std::vector<uint32_t> sparse;         // object index -> dense index
+};
+
+// 先頭の型のプールを密に走査し、残りの型を全て持つオブジェクトだけを返すビュー
+// for (auto [object, mesh, transform] : scene.view<Mesh, Transform>()) { ... }
+template <typename T, typename... Others>
+class ComponentView {
+public:
+    using Pools = std::tuple<ComponentPool<Others>*...>;
+
+    class Iterator {
+    public:
+        Iterator(const ComponentView* _view, size_t _position) : view{_view}, position{_position} {
+            skip();
+        }
+
+        std::tuple<Object&, T&, Others&...> operator*() const {
+            uint32_t objectIndex = view->primary->getObjectIndices()[position];
+            return {(*view->objects)[objectIndex], view->primary->getComponents()[position],
+                    *std::get<ComponentPool<Others>*>(view->others)->get(objectIndex)...};
+        }
+
+        Iterator& operator++() {
+            position++;
+            skip();
+            return *this;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return position != other.position;
+        }
+
+    private:
+        void skip() {
+            size_t count = view->size();
+            while (position < count && !view->containsOthers(position)) {
+                position++;
+            }
+        }
+
+        const ComponentView* view;
+        size_t position;
+    };
+
+    ComponentView(SlotMap<Object>& _objects, ComponentPool<T>* _primary, Pools _others)
+        : objects{&_objects}, primary{_primary}, others{_others} {}
+
+    Iterator begin() const {
+        return {this, 0};
+    }
+
+    Iterator end() const {
+        return {this, size()};
+    }
+
+private:
+    size_t size() const {
+        // どれか一つでもプールが無ければ空のビューとする
+        bool allExist = primary && (std::get<ComponentPool<Others>*>(others) && ...);
+        return allExist ? primary->size() : 0;
+    }
+
+    bool containsOthers(size_t position) const {
+        if constexpr (sizeof...(Others) == 0) {
+            return true;
+        } else {
+            uint32_t objectIndex = primary->getObjectIndices()[position];
+            return (std::get<ComponentPool<Others>*>(others)->contains(objectIndex) && ...);
+        }
+    }
+
+    SlotMap<Object>* objects;
+    ComponentPool<T>* primary;
+    Pools others;
+};
@@ -0,0 +1,156 @@
+#include "JobSystem.hpp"
+
+#include <algorithm>
+
+namespace {
+thread_local uint32_t threadIndex = 0;
+}
+
+JobSystem::JobSystem(uint32_t threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    queues.reserve(threadCount);
+    for (uint32_t i = 0; i < threadCount; i++) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+
+    // 0 番は呼び出し元のスレッドが使う
+    threads.reserve(threadCount - 1);
+    for (uint32_t i = 1; i < threadCount; i++) {
+        threads.emplace_back([this, i]() { workerLoop(i); });
+    }
+}
+
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard lock{sleepMutex};
+        running = false;
+    }
+    sleepCondition.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+uint32_t JobSystem::getThreadIndex() {
+    return threadIndex;
+}
+
+void JobSystem::submit(Job job, JobCounter& counter) {
+    counter.count.fetch_add(1, std::memory_order_relaxed);
+
+    Queue& queue = *queues[threadIndex];
+    {
+        std::lock_guard lock{queue.mutex};
+        queue.jobs.push_back({std::move(job), &counter});
+    }
+
+    // NOTE: ワーカーが条件を確認してから眠るまでの間に通知が失われないよう、
+    //       sleepMutex を経由してから起こす
+    queuedJobCount.fetch_add(1, std::memory_order_release);
+    { std::lock_guard lock{sleepMutex}; }
+    sleepCondition.notify_one();
+}
+
+void JobSystem::wait(JobCounter& counter) {
+    while (!counter.isDone()) {
+        if (!tryRunJob(threadIndex)) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool JobSystem::tryRunJob(uint32_t index) {
+    Entry entry;
+
+    // 自分のキューの末尾から取る
+    {
+        Queue& queue = *queues[index];
+        std::lock_guard lock{queue.mutex};
+        if (!queue.jobs.empty()) {
+            entry = std::move(queue.jobs.back());
+            queue.jobs.pop_back();
+        }
+    }
+
+    // 空なら他のスレッドのキューの先頭から盗む
+    uint32_t count = getThreadCount();
+    for (uint32_t offset = 1; !entry.job && offset < count; offset++) {
+        Queue& queue = *queues[(index + offset) % count];
+        std::lock_guard lock{queue.mutex};
+        if (!queue.jobs.empty()) {
+            entry = std::move(queue.jobs.front());
+            queue.jobs.pop_front();
+        }
+    }
+
+    if (!entry.job) {
+        return false;
+    }
+    queuedJobCount.fetch_sub(1, std::memory_order_relaxed);
+    entry.job();
+    entry.counter->count.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void JobSystem::workerLoop(uint32_t index) {
+    threadIndex = index;
+    while (true) {
+        if (tryRunJob(index)) {
+            continue;
+        }
+
+        std::unique_lock lock{sleepMutex};
+        sleepCondition.wait(lock, [this]() {
+            return !running || queuedJobCount.load(std::memory_order_acquire) > 0;
+        });
+        if (!running) {
+            return;
+        }
+    }
+}
+
+TaskGraph::TaskID TaskGraph::add(std::function<void()> func) {
+    TaskID id = static_cast<TaskID>(tasks.size());
+    tasks.emplace_back().func = std::move(func);
+    return id;
+}
+
+void TaskGraph::precede(TaskID before, TaskID after) {
+    tasks[before].successors.push_back(after);
+    tasks[after].dependencyCount++;
+}
+
+void TaskGraph::run(JobSystem& jobSystem) {
+    for (auto& task : tasks) {
+        task.remainingDependencies.store(task.dependencyCount, std::memory_order_relaxed);
+    }
+
+    JobCounter counter;
+    for (TaskID id = 0; id < tasks.size(); id++) {
+        if (tasks[id].dependencyCount == 0) {
+            submit(jobSystem, id, counter);
+        }
+    }
+    jobSystem.wait(counter);
+}
+
+void TaskGraph::submit(JobSystem& jobSystem, TaskID id, JobCounter& counter) {
+    jobSystem.submit(
+        [this, &jobSystem, id, &counter]() {
+            Task& task = tasks[id];
+            task.func();
+
+            // 最後の依存先が終わったタスクを投入する
+            // NOTE: 自分のカウンタが減る前に投入するので、wait が途中で抜けることはない
+            for (TaskID successor : task.successors) {
+                if (tasks[successor].remainingDependencies.fetch_sub(
+                        1, std::memory_order_acq_rel) == 1) {
+                    submit(jobSystem, successor, counter);
+                }
+            }
+        },
+        counter);
+}
@@ -0,0 +1,160 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// ジョブの完了待ちに使うカウンタ
+// 投入時に増やし、ジョブが終わるたびに減らす
+struct JobCounter {
+    std::atomic<uint32_t> count = 0;
+
+    bool isDone() const {
+        return count.load(std::memory_order_acquire) == 0;
+    }
+};
+
+// Work-stealing によるスレッドプール
+// スレッドごとにジョブのキューを持ち、自分のキューは末尾から (LIFO)、
+// 他のスレッドのキューは先頭から (FIFO) 取り出して負荷を分散する
+// NOTE: スレッドインデックスは thread_local なので、インスタンスは一つだけ作ること
+class JobSystem {
+public:
+    using Job = std::function<void()>;
+
+    // threadCount は呼び出し元のスレッドを含めた数 (0 ならハードウェアのスレッド数)
+    explicit JobSystem(uint32_t threadCount = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    void submit(Job job, JobCounter& counter);
+
+    // カウンタが 0 になるまで待つ
+    // 待っている間も、呼び出し元のスレッドでジョブを実行する
+    void wait(JobCounter& counter);
+
+    // [0, count) を chunkSize ごとに分割して並列に実行し、全て終わるまで待つ
+    // func(begin, end) は別々のスレッドから同時に呼ばれる
+    template <typename Func>
+    void parallelFor(uint32_t count, uint32_t chunkSize, Func&& func) {
+        if (count == 0) {
+            return;
+        }
+        // 分割するほどの量が無ければその場で実行する
+        if (count <= chunkSize || getThreadCount() == 1) {
+            func(0u, count);
+            return;
+        }
+
+        JobCounter counter;
+        for (uint32_t begin = 0; begin < count; begin += chunkSize) {
+            uint32_t end = std::min(begin + chunkSize, count);
+            submit([&func, begin, end]() { func(begin, end); }, counter);
+        }
+        wait(counter);
+    }
+
+    // 呼び出し元を含めたスレッド数
+    uint32_t getThreadCount() const {
+        return static_cast<uint32_t>(queues.size());
+    }
+
+    // 0 は呼び出し元 (メイン) スレッド、1 以降がワーカースレッド
+    static uint32_t getThreadIndex();
+
+private:
+    // NOTE: カウンタはジョブと並べて持ち、ラップ用の std::function を作らない
+    struct Entry {
+        Job job;
+        JobCounter* counter = nullptr;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Entry> jobs;
+    };
+
+    void workerLoop(uint32_t index);
+
+    // 自分のキュー、他のスレッドのキューの順に探して一つ実行する
+    bool tryRunJob(uint32_t index);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+
+    std::atomic<uint32_t> queuedJobCount = 0;
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+    bool running = true;
+};
+
+// スレッドごとに値を持つためのバッファ
+// 各スレッドは getThreadIndex() の要素にだけ書き込み、最後にまとめて読み出す
+// NOTE: 隣のスレッドの値と同じキャッシュラインに乗らないよう揃えておく
+template <typename T>
+class PerThread {
+public:
+    explicit PerThread(uint32_t threadCount = 1) : slots(threadCount) {}
+
+    void resize(uint32_t threadCount) {
+        slots.resize(threadCount);
+    }
+
+    T& local() {
+        return slots[JobSystem::getThreadIndex()].value;
+    }
+
+    template <typename Func>
+    void forEach(Func&& func) {
+        for (auto& slot : slots) {
+            func(slot.value);
+        }
+    }
+
+private:
+    struct alignas(64) Slot {
+        T value{};
+    };
+
+    std::vector<Slot> slots;
+};
+
+// 依存関係を持つタスクの集まり
+// 依存先が全て終わったタスクから順に JobSystem へ投入する
+class TaskGraph {
+public:
+    using TaskID = uint32_t;
+
+    TaskID add(std::function<void()> func);
+
+    // before が終わってから after を実行する
+    void precede(TaskID before, TaskID after);
+
+    // 全てのタスクが終わるまで待つ
+    // NOTE: 同じグラフを繰り返し実行できる
+    void run(JobSystem& jobSystem);
+
+    void clear() {
+        tasks.clear();
+    }
+
+private:
+    struct Task {
+        std::function<void()> func;
+        std::vector<TaskID> successors;
+        uint32_t dependencyCount = 0;
+        std::atomic<uint32_t> remainingDependencies = 0;
+    };
+
+    void submit(JobSystem& jobSystem, TaskID id, JobCounter& counter);
+
+    // NOTE: atomic を含むため、追加しても要素が移動しない deque に置く
+    std::deque<Task> tasks;
+};
@@ -1,4 +1,7 @@
 #pragma once
+#include <array>
+
+#include "RenderSnapshot.hpp"
 #include "Renderer.hpp"
 #include "Scene.hpp"
 #include "ViewportRenderer.hpp"
@@ -19,6 +22,7 @@ public:
           }) {}
 
     void onShutdown() override {
+        jobSystem.wait(simulationCounter);
         editor.shutdown();
     }
 
@@ -26,9 +30,14 @@ public:
         rv::CPUTimer timer;
         std::filesystem::create_directories(DEV_SHADER_DIR / "spv");
 
-        scene.init(context);
+        scene.init(context, jobSystem);
         scene.loadFromJson(DEV_ASSET_DIR / "scenes" / "pbr_helmet.json");
 
+        // 最初のフレームで描画するスナップショットを作っておく
+        scene.updateMainThread(0.0f);
+        scene.update(0.0f);
+        snapshots[writeIndex].extract(scene);
+
         renderer.init(context, swapchain->getFormat(),  //
                       rv::Window::getWidth(), rv::Window::getHeight());
         viewportRenderer.init(context, swapchain->getFormat(), renderer.getDepthFormat());
@@ -39,6 +48,28 @@ public:
         spdlog::info("Started: {} ms", timer.elapsedInMilli());
     }
 
+    // シーンの JSON が参照する glTF をシーンパックに焼いて書き出す
+    // NOTE: 省略した場合は asset/scenes の全てのシーンを焼く
+    void cook(std::vector<std::filesystem::path> filepaths) {
+        scene.init(context, jobSystem);
+        if (filepaths.empty()) {
+            for (const auto& entry :
+                 std::filesystem::directory_iterator(DEV_ASSET_DIR / "scenes")) {
+                if (entry.path().extension() == ".json") {
+                    filepaths.push_back(entry.path());
+                }
+            }
+        }
+        for (const std::filesystem::path& filepath : filepaths) {
+            rv::CPUTimer timer;
+            if (scene.cookScenePack(filepath)) {
+                spdlog::info("  {} ms", timer.elapsedInMilli());
+            }
+        }
+        context.getDevice().waitIdle();
+        scene.clear();
+    }
+
     void onKey(int key, int scancode, int action, int mods) override {
         if (key == GLFW_KEY_P && action == GLFW_PRESS) {
             WindowAdapter::play = !WindowAdapter::play;
@@ -49,6 +80,12 @@ public:
     }
 
     void onUpdate(float dt) override {
+        // 前のフレームで投入したシミュレーションを待つ
+        // NOTE: これ以降、次のジョブを投入するまではメインスレッドがシーンを触ってよい
+        jobSystem.wait(simulationCounter);
+        renderIndex = writeIndex;
+        writeIndex = 1 - writeIndex;
+
         if (!WindowAdapter::play) {
             editor.beginCpuUpdate();
         }
@@ -82,7 +119,16 @@ public:
         }
 
         // Update
-        scene.update(dt);
+        // シミュレーションとスナップショットの作成はワーカースレッドで行い、
+        // その間にメインスレッドは前のフレームのスナップショットを描画する
+        // NOTE: エディタでの編集が画面に反映されるのは次のフレームになる
+        scene.updateMainThread(dt);
+        jobSystem.submit(
+            [this, dt, &snapshot = snapshots[writeIndex]]() {
+                scene.update(dt);
+                snapshot.extract(scene);
+            },
+            simulationCounter);
 
         frame++;
 
@@ -94,21 +140,30 @@ public:
     void onRender(const rv::CommandBufferHandle& commandBuffer) override {
         if (WindowAdapter::play) {
             commandBuffer->clearColorImage(getCurrentColorImage(), {0.0f, 0.0f, 0.0f, 1.0f});
-            renderer.render(*commandBuffer, getCurrentColorImage(), scene);
+            renderer.render(*commandBuffer, getCurrentColorImage(), snapshots[renderIndex]);
         } else {
             editor.beginCpuRender();
             commandBuffer->clearColorImage(getCurrentColorImage(), {0.0f, 0.0f, 0.0f, 1.0f});
-            renderer.render(*commandBuffer, editor.getViewportImage(), scene);
+            renderer.render(*commandBuffer, editor.getViewportImage(), snapshots[renderIndex]);
             viewportRenderer.render(*commandBuffer, editor.getViewportImage(),
-                                    renderer.getDepthImage(), scene);
+                                    renderer.getDepthImage(), snapshots[renderIndex]);
             editor.endCpuRender();
         }
     }
 
+    // NOTE: Scene より先に破棄されないよう先に宣言する
+    JobSystem jobSystem;
     Scene scene;
     Renderer renderer;
     ViewportRenderer viewportRenderer;
     Editor editor;
+
+    // 描画用とシミュレーションの書き込み用を交互に使う
+    std::array<RenderSnapshot, 2> snapshots;
+    int renderIndex = 0;
+    int writeIndex = 0;
+    JobCounter simulationCounter;
+
     int frame = 0;
     bool pendingRecompile = false;
 };
@@ -0,0 +1,235 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// メッシュを小さな三角形の塊 (クラスタ) に分け、塊ごとにカリングする
+// 塊は包む球と、三角形の法線の向きを包む円錐を持つ
+// 視錐台の外にあるか、全ての三角形が裏を向いている塊は描かない
+// NOTE: 塊の三角形はインデックスの上で連続した範囲に並べ替えるので、残った範囲をそのまま描画できる
+
+// 塊の大きさの上限 (メッシュシェーダでよく使われる大きさ)
+constexpr uint32_t maxClusterVertices = 64;
+constexpr uint32_t maxClusterTriangles = 124;
+
+struct MeshCluster {
+    glm::vec3 center{0.0f};  // 包む球 (メッシュのローカル座標)
+    float radius = 0.0f;
+    glm::vec3 coneAxis{0.0f, 0.0f, 1.0f};  // 法線の平均の向き
+    float coneCutoff = 1.0f;               // 1 なら法線の向きがばらばらで、裏向きの判定に使えない
+    uint32_t firstIndex = 0;               // メッシュの firstIndex からの位置
+    uint32_t indexCount = 0;
+    uint32_t _dummy[2]{};
+};
+
+// 視点から見て、塊の全ての三角形が裏を向いているか
+// NOTE: 球の半径の分だけ余裕を持たせるので、塊のどこから見ても裏向きの場合だけ true になる
+inline bool isClusterBackfacing(const glm::vec3& center,
+                                float radius,
+                                const glm::vec3& coneAxis,
+                                float coneCutoff,
+                                const glm::vec3& cameraPosition) {
+    glm::vec3 toCenter = center - cameraPosition;
+    return glm::dot(toCenter, coneAxis) >= coneCutoff * glm::length(toCenter) + radius;
+}
+
+namespace mesh_cluster_detail {
+inline glm::vec3 normalizeOrZero(const glm::vec3& v) {
+    float length = glm::length(v);
+    return length > 0.0f ? v * (1.0f / length) : glm::vec3{0.0f};
+}
+
+// 塊の三角形から、包む球と法線の円錐を計算する
+inline void computeClusterBounds(std::span<const uint32_t> indices,
+                                 std::span<const glm::vec3> positions,
+                                 MeshCluster& cluster) {
+    glm::vec3 min{std::numeric_limits<float>::max()};
+    glm::vec3 max{-std::numeric_limits<float>::max()};
+    for (uint32_t index : indices) {
+        min = glm::min(min, positions[index]);
+        max = glm::max(max, positions[index]);
+    }
+    cluster.center = (min + max) * 0.5f;
+    cluster.radius = 0.0f;
+    for (uint32_t index : indices) {
+        cluster.radius = std::max(cluster.radius, glm::length(positions[index] - cluster.center));
+    }
+
+    // 円錐の軸は法線の平均、開き具合は軸から最も離れた法線で決める
+    // NOTE: 軸と 85度近く離れた法線があれば、裏向きになる視点はほとんど無いので判定しない
+    glm::vec3 normalSum{0.0f};
+    std::vector<glm::vec3> normals;
+    normals.reserve(indices.size() / 3);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const glm::vec3& p0 = positions[indices[i + 0]];
+        glm::vec3 normal = normalizeOrZero(
+            glm::cross(positions[indices[i + 1]] - p0, positions[indices[i + 2]] - p0));
+        if (normal != glm::vec3{0.0f}) {
+            normals.push_back(normal);
+            normalSum += normal;
+        }
+    }
+    cluster.coneAxis = normalizeOrZero(normalSum);
+    cluster.coneCutoff = 1.0f;
+    if (normals.empty() || cluster.coneAxis == glm::vec3{0.0f}) {
+        cluster.coneAxis = glm::vec3{0.0f, 0.0f, 1.0f};
+        return;
+    }
+    float minDot = 1.0f;
+    for (const glm::vec3& normal : normals) {
+        minDot = std::min(minDot, glm::dot(normal, cluster.coneAxis));
+    }
+    if (minDot > 0.1f) {
+        cluster.coneCutoff = std::sqrt(1.0f - minDot * minDot);
+    }
+}
+}  // namespace mesh_cluster_detail
+
+// 三角形を塊に分け、塊ごとにインデックスを連続した範囲に並べ替える
+// 塊は、塊の頂点を共有する三角形のうち、新しい頂点が少なく、塊の中心に近く法線の向きが揃うものから
+// 順に広げる (小さくまとまり、法線の向きが揃った塊ほどカリングされやすい)
+// NOTE: 新しく始める塊は、まだ使っていない最初の三角形から始めるので、
+//       頂点キャッシュのために並べた順序がおおよそ保たれる
+//       入力だけで結果が決まるので、同じメッシュからは常に同じ塊になる
+inline std::vector<MeshCluster> buildMeshClusters(std::span<uint32_t> indices,
+                                                  std::span<const glm::vec3> positions,
+                                                  uint32_t maxVertices = maxClusterVertices,
+                                                  uint32_t maxTriangles = maxClusterTriangles) {
+    constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+    auto vertexCount = static_cast<uint32_t>(positions.size());
+    auto triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    std::vector<MeshCluster> clusters;
+    if (triangleCount == 0) {
+        return clusters;
+    }
+
+    // 頂点 → 三角形
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1, 0);
+    for (uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+        for (uint32_t corner = 0; corner < 3; corner++) {
+            adjacencyOffsets[indices[triangle * 3 + corner] + 1]++;
+        }
+    }
+    for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+        adjacencyOffsets[vertex + 1] += adjacencyOffsets[vertex];
+    }
+    std::vector<uint32_t> adjacency(triangleCount * 3);
+    std::vector<uint32_t> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for (uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+        for (uint32_t corner = 0; corner < 3; corner++) {
+            adjacency[cursors[indices[triangle * 3 + corner]]++] = triangle;
+        }
+    }
+
+    std::vector<glm::vec3> triangleNormals(triangleCount);
+    std::vector<glm::vec3> triangleCenters(triangleCount);
+    for (uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+        const glm::vec3& p0 = positions[indices[triangle * 3 + 0]];
+        const glm::vec3& p1 = positions[indices[triangle * 3 + 1]];
+        const glm::vec3& p2 = positions[indices[triangle * 3 + 2]];
+        triangleNormals[triangle] =
+            mesh_cluster_detail::normalizeOrZero(glm::cross(p1 - p0, p2 - p0));
+        triangleCenters[triangle] = (p0 + p1 + p2) * (1.0f / 3.0f);
+    }
+
+    // NOTE: 頂点と候補の三角形には、最後に入った塊の番号を書いて印にする
+    std::vector<uint32_t> vertexStamps(vertexCount, none);
+    std::vector<uint32_t> candidateStamps(triangleCount, none);
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> output;
+    output.reserve(triangleCount * 3);
+    std::vector<uint32_t> clusterVertices;
+    std::vector<uint32_t> candidates;
+    uint32_t nextSeed = 0;
+    while (output.size() < triangleCount * 3) {
+        while (emitted[nextSeed]) {
+            nextSeed++;
+        }
+        auto clusterIndex = static_cast<uint32_t>(clusters.size());
+        auto firstIndex = static_cast<uint32_t>(output.size());
+        uint32_t clusterTriangleCount = 0;
+        glm::vec3 normalSum{0.0f};
+        glm::vec3 centerSum{0.0f};
+        clusterVertices.clear();
+        candidates.clear();
+
+        auto countNewVertices = [&](uint32_t triangle) {
+            uint32_t count = 0;
+            for (uint32_t corner = 0; corner < 3; corner++) {
+                count += vertexStamps[indices[triangle * 3 + corner]] != clusterIndex;
+            }
+            return count;
+        };
+        auto addTriangle = [&](uint32_t triangle) {
+            emitted[triangle] = 1;
+            clusterTriangleCount++;
+            normalSum += triangleNormals[triangle];
+            centerSum += triangleCenters[triangle];
+            for (uint32_t corner = 0; corner < 3; corner++) {
+                uint32_t vertex = indices[triangle * 3 + corner];
+                output.push_back(vertex);
+                if (vertexStamps[vertex] == clusterIndex) {
+                    continue;
+                }
+                vertexStamps[vertex] = clusterIndex;
+                clusterVertices.push_back(vertex);
+                for (uint32_t i = adjacencyOffsets[vertex]; i < adjacencyOffsets[vertex + 1]; i++) {
+                    uint32_t neighbor = adjacency[i];
+                    if (!emitted[neighbor] && candidateStamps[neighbor] != clusterIndex) {
+                        candidateStamps[neighbor] = clusterIndex;
+                        candidates.push_back(neighbor);
+                    }
+                }
+            }
+        };
+
+        addTriangle(nextSeed);
+        while (clusterTriangleCount < maxTriangles) {
+            // 新しい頂点が少ない順、中心からの距離と法線のずれが小さい順、番号が小さい順に選ぶ
+            glm::vec3 axis = mesh_cluster_detail::normalizeOrZero(normalSum);
+            glm::vec3 center = centerSum * (1.0f / static_cast<float>(clusterTriangleCount));
+            uint32_t best = none;
+            uint32_t bestNewVertices = none;
+            float bestScore = 0.0f;
+            size_t candidateCount = 0;
+            for (uint32_t candidate : candidates) {
+                if (emitted[candidate]) {
+                    continue;
+                }
+                candidates[candidateCount++] = candidate;
+                uint32_t newVertices = countNewVertices(candidate);
+                if (clusterVertices.size() + newVertices > maxVertices) {
+                    continue;
+                }
+                float distance = glm::length(triangleCenters[candidate] - center);
+                float score = distance * (2.0f - glm::dot(triangleNormals[candidate], axis));
+                if (newVertices < bestNewVertices ||
+                    (newVertices == bestNewVertices &&
+                     (score < bestScore || (score == bestScore && candidate < best)))) {
+                    best = candidate;
+                    bestNewVertices = newVertices;
+                    bestScore = score;
+                }
+            }
+            candidates.resize(candidateCount);
+            if (best == none) {
+                break;
+            }
+            addTriangle(best);
+        }
+
+        MeshCluster cluster;
+        cluster.firstIndex = firstIndex;
+        cluster.indexCount = clusterTriangleCount * 3;
+        std::span<const uint32_t> clusterIndices{output.data() + firstIndex, cluster.indexCount};
+        mesh_cluster_detail::computeClusterBounds(clusterIndices, positions, cluster);
+        clusters.push_back(cluster);
+    }
+    std::copy(output.begin(), output.end(), indices.begin());
+    return clusters;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <span>
+
+// 簡略化したメッシュ (LOD) のインデックスの範囲
+// NOTE: 頂点は元のメッシュと共有し、インデックスだけを元のメッシュと同じ配列に持つ
+struct MeshLod {
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    float error = 0.0f;  // 元のメッシュからの形状の誤差 (メッシュの半径に対する割合)
+};
+
+// 元のメッシュを除く LOD の最大数
+constexpr uint32_t maxMeshLodCount = 4;
+
+struct MeshLodSettings {
+    bool enabled = true;
+    float errorPixels = 1.0f;        // 画面上の誤差がこれ以下に収まる最も粗い LOD を使う
+    float shadowErrorPixels = 4.0f;  // シャドウマップ上の誤差 (テクセル)。大きいほど粗い LOD を使う
+    float hysteresis = 0.25f;        // 粗くするときだけ、閾値をこの割合だけ厳しくする
+
+    bool operator==(const MeshLodSettings&) const = default;
+};
+
+// LOD の誤差 (半径に対する割合) を画面上のピクセル数に換算する係数
+// projScaleY は射影行列の [1][1] (= 1 / tan(fovY / 2))
+// NOTE: カメラが球の中にあれば、どの LOD も使わないよう無限大を返す
+inline float computeLodErrorScale(float radius,
+                                  float distance,
+                                  float projScaleY,
+                                  float viewportHeight) {
+    if (distance <= radius) {
+        return std::numeric_limits<float>::infinity();
+    }
+    return radius * projScaleY / distance * viewportHeight * 0.5f;
+}
+
+// 誤差が threshold ピクセル以下に収まる最も粗い LOD を選ぶ (0 は元のメッシュ、i は lods[i - 1])
+// NOTE: 前のフレームの LOD (current) から切り替えるときにヒステリシスを持たせ、ちらつきを防ぐ
+//       細かくするのは今の LOD の誤差が threshold を超えたとき、
+//       粗くするのは次の LOD の誤差が threshold * (1 - hysteresis) 以下になったとき
+inline uint32_t selectMeshLod(std::span<const MeshLod> lods,
+                              float errorScale,
+                              float threshold,
+                              float hysteresis,
+                              uint32_t current) {
+    auto fits = [&](uint32_t level, float limit) {
+        return level == 0 || lods[level - 1].error * errorScale <= limit;
+    };
+    uint32_t level = current <= lods.size() ? current : static_cast<uint32_t>(lods.size());
+    while (level > 0 && !fits(level, threshold)) {
+        level--;
+    }
+    while (level < lods.size() && fits(level + 1, threshold * (1.0f - hysteresis))) {
+        level++;
+    }
+    return level;
+}
@@ -0,0 +1,644 @@
+#pragma once
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// 読み込んだメッシュのインデックスと頂点の並びを、GPU で処理しやすい順に並べ替える
+// 1. 同じ頂点をまとめる
+// 2. 変換後の頂点キャッシュに乗りやすい順に三角形を並べる (Forsyth の方法)
+// 3. 外側を向いた三角形の塊から描くように並べ、オーバードローを減らす
+// 4. 頂点を最初に使われる順に並べ、頂点フェッチを連続したアクセスにする
+// また、辺の縮約でメッシュを簡略化し、LOD のインデックスを作る
+// NOTE: どれも入力だけで結果が決まる (乱数やハッシュの順序に依存しない) ので、
+//       同じ入力からは常に同じ出力になり、焼いたシーンパックも再現できる
+
+// 頂点キャッシュの効率
+// NOTE: ACMR は三角形あたりのキャッシュミス数 (0.5 〜 3、小さいほど良い)
+//       ATVR は頂点あたりの変換回数 (1 が最良)
+struct VertexCacheStats {
+    uint64_t transformedVertices = 0;
+    uint64_t triangles = 0;
+    uint64_t vertices = 0;
+
+    float getACMR() const {
+        if (triangles == 0) {
+            return 0.0f;
+        }
+        return static_cast<float>(transformedVertices) / static_cast<float>(triangles);
+    }
+
+    float getATVR() const {
+        if (vertices == 0) {
+            return 0.0f;
+        }
+        return static_cast<float>(transformedVertices) / static_cast<float>(vertices);
+    }
+
+    VertexCacheStats& operator+=(const VertexCacheStats& other) {
+        transformedVertices += other.transformedVertices;
+        triangles += other.triangles;
+        vertices += other.vertices;
+        return *this;
+    }
+};
+
+// FIFO の頂点キャッシュでの変換回数を数える
+inline VertexCacheStats analyzeVertexCache(std::span<const uint32_t> indices,
+                                           uint32_t vertexCount,
+                                           uint32_t cacheSize = 16) {
+    VertexCacheStats stats{};
+    stats.triangles = indices.size() / 3;
+
+    // NOTE: 最後に読み込んだ時刻が cacheSize 回以上前なら追い出されている
+    std::vector<uint32_t> timestamps(vertexCount, 0);
+    uint32_t time = cacheSize + 1;
+    for (uint32_t index : indices) {
+        if (time - timestamps[index] > cacheSize) {
+            timestamps[index] = time++;
+            stats.transformedVertices++;
+        }
+    }
+    stats.vertices = static_cast<uint64_t>(std::count_if(
+        timestamps.begin(), timestamps.end(), [](uint32_t timestamp) { return timestamp != 0; }));
+    return stats;
+}
+
+// FNV-1a
+inline uint64_t hashBytes(const void* data, size_t size, uint64_t hash = 14695981039346656037ull) {
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+    }
+    return hash;
+}
+
+// 同じ頂点をまとめ、元の頂点 → まとめた頂点 の番号を remap に書き込んで、まとめた頂点の数を返す
+// まとめた頂点の番号は、最初に現れた順に振る
+// NOTE: hash(v) と equal(a, b) は頂点の番号を受け取る。equal なら hash も等しいこと
+template <typename Hash, typename Equal>
+uint32_t buildDeduplicationRemap(uint32_t vertexCount,
+                                 Hash&& hash,
+                                 Equal&& equal,
+                                 std::vector<uint32_t>& remap) {
+    constexpr uint32_t empty = std::numeric_limits<uint32_t>::max();
+    size_t tableSize = std::bit_ceil(std::max(size_t{vertexCount} * 2, size_t{16}));
+    std::vector<uint32_t> table(tableSize, empty);
+
+    remap.resize(vertexCount);
+    uint32_t uniqueCount = 0;
+    for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+        size_t slot = hash(vertex) & (tableSize - 1);
+        while (table[slot] != empty && !equal(table[slot], vertex)) {
+            slot = (slot + 1) & (tableSize - 1);
+        }
+        if (table[slot] == empty) {
+            table[slot] = vertex;
+            remap[vertex] = uniqueCount++;
+        } else {
+            remap[vertex] = remap[table[slot]];
+        }
+    }
+    return uniqueCount;
+}
+
+namespace mesh_optimizer_detail {
+constexpr uint32_t cacheSize = 32;
+
+// 頂点のスコア (Forsyth, "Linear-Speed Vertex Cache Optimisation")
+// キャッシュの新しい位置にあるほど、残りの三角形が少ないほど高い
+inline float getVertexScore(int cachePosition, uint32_t remainingTriangles) {
+    if (remainingTriangles == 0) {
+        return -1.0f;
+    }
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+        // NOTE: 直前の三角形の頂点は、次の三角形で続けて使うと偏りが出るので一定の値にする
+        if (cachePosition < 3) {
+            score = 0.75f;
+        } else {
+            float scale = 1.0f / static_cast<float>(cacheSize - 3);
+            score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scale, 1.5f);
+        }
+    }
+    return score + 2.0f / std::sqrt(static_cast<float>(remainingTriangles));
+}
+}  // namespace mesh_optimizer_detail
+
+// 三角形を頂点キャッシュに乗りやすい順に並べ替える
+// NOTE: キャッシュ内の頂点を使う三角形から最もスコアの高いものを選び続ける
+//       同じスコアなら番号の小さい三角形を選ぶ
+inline void optimizeVertexCache(std::span<uint32_t> indices, uint32_t vertexCount) {
+    using namespace mesh_optimizer_detail;
+    uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // 頂点ごとの、まだ出力していない三角形の一覧
+    // NOTE: 頂点 v の一覧は adjacency の [firstTriangles[v], firstTriangles[v] + remaining[v])
+    std::vector<uint32_t> remaining(vertexCount, 0);
+    for (uint32_t index : indices) {
+        remaining[index]++;
+    }
+    std::vector<uint32_t> firstTriangles(vertexCount, 0);
+    for (uint32_t vertex = 1; vertex < vertexCount; vertex++) {
+        firstTriangles[vertex] = firstTriangles[vertex - 1] + remaining[vertex - 1];
+    }
+    std::vector<uint32_t> adjacency(indices.size());
+    std::vector<uint32_t> filled(vertexCount, 0);
+    for (uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+        for (uint32_t corner = 0; corner < 3; corner++) {
+            uint32_t vertex = indices[triangle * 3 + corner];
+            adjacency[firstTriangles[vertex] + filled[vertex]++] = triangle;
+        }
+    }
+
+    std::vector<int> cachePositions(vertexCount, -1);
+    std::vector<float> vertexScores(vertexCount);
+    for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+        vertexScores[vertex] = getVertexScore(-1, remaining[vertex]);
+    }
+    std::vector<float> triangleScores(triangleCount);
+    uint32_t bestTriangle = 0;
+    for (uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+        triangleScores[triangle] = vertexScores[indices[triangle * 3 + 0]] +
+                                   vertexScores[indices[triangle * 3 + 1]] +
+                                   vertexScores[indices[triangle * 3 + 2]];
+        if (triangleScores[triangle] > triangleScores[bestTriangle]) {
+            bestTriangle = triangle;
+        }
+    }
+
+    std::vector<uint8_t> emitted(triangleCount, 0);
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    std::vector<uint32_t> cache;
+    std::vector<uint32_t> nextCache;
+    uint32_t nextUnemitted = 0;
+    constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+    while (output.size() < indices.size()) {
+        // キャッシュから選べなければ、まだ出力していない三角形を先頭から探す
+        if (bestTriangle == none) {
+            while (emitted[nextUnemitted]) {
+                nextUnemitted++;
+            }
+            bestTriangle = nextUnemitted;
+        }
+        emitted[bestTriangle] = 1;
+
+        uint32_t corners[3] = {indices[bestTriangle * 3 + 0], indices[bestTriangle * 3 + 1],
+                               indices[bestTriangle * 3 + 2]};
+        for (uint32_t vertex : corners) {
+            output.push_back(vertex);
+
+            // 頂点の一覧から取り除く
+            uint32_t* first = adjacency.data() + firstTriangles[vertex];
+            uint32_t* last = first + remaining[vertex];
+            std::swap(*std::find(first, last, bestTriangle), *(last - 1));
+            remaining[vertex]--;
+        }
+
+        // 使った頂点をキャッシュの先頭に入れる (LRU)
+        nextCache.assign(corners, corners + 3);
+        for (uint32_t vertex : cache) {
+            if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2]) {
+                nextCache.push_back(vertex);
+            }
+        }
+
+        // キャッシュに出入りした頂点と、その三角形のスコアを更新する
+        for (uint32_t i = 0; i < nextCache.size(); i++) {
+            uint32_t vertex = nextCache[i];
+            cachePositions[vertex] = i < cacheSize ? static_cast<int>(i) : -1;
+            float score = getVertexScore(cachePositions[vertex], remaining[vertex]);
+            float delta = score - vertexScores[vertex];
+            vertexScores[vertex] = score;
+            uint32_t* first = adjacency.data() + firstTriangles[vertex];
+            for (uint32_t* triangle = first; triangle < first + remaining[vertex]; triangle++) {
+                triangleScores[*triangle] += delta;
+            }
+        }
+        nextCache.resize(std::min(nextCache.size(), size_t{cacheSize}));
+        std::swap(cache, nextCache);
+
+        // 次の三角形はキャッシュ内の頂点を使うものから選ぶ
+        bestTriangle = none;
+        float bestScore = -std::numeric_limits<float>::max();
+        for (uint32_t vertex : cache) {
+            uint32_t* first = adjacency.data() + firstTriangles[vertex];
+            for (uint32_t* triangle = first; triangle < first + remaining[vertex]; triangle++) {
+                float score = triangleScores[*triangle];
+                if (score > bestScore || (score == bestScore && *triangle < bestTriangle)) {
+                    bestScore = score;
+                    bestTriangle = *triangle;
+                }
+            }
+        }
+    }
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+// 頂点キャッシュの順に並んだ三角形を塊に分け、外側を向いた塊から描くように並べ替える
+// NOTE: 塊は FIFO のキャッシュで 3頂点ともミスする三角形で区切る
+//       塊の中の順序は変えないので、頂点キャッシュの効率はほとんど変わらない
+//       (Sander et al., "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw")
+inline void optimizeOverdraw(std::span<uint32_t> indices,
+                             std::span<const glm::vec3> positions,
+                             uint32_t cacheSize = 16) {
+    uint32_t triangleCount = static_cast<uint32_t>(indices.size() / 3);
+    if (triangleCount < 2) {
+        return;
+    }
+
+    // 塊の先頭の三角形
+    std::vector<uint32_t> clusterStarts;
+    std::vector<uint32_t> timestamps(positions.size(), 0);
+    uint32_t time = cacheSize + 1;
+    for (uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+        uint32_t misses = 0;
+        for (uint32_t corner = 0; corner < 3; corner++) {
+            uint32_t vertex = indices[triangle * 3 + corner];
+            if (time - timestamps[vertex] > cacheSize) {
+                timestamps[vertex] = time++;
+                misses++;
+            }
+        }
+        if (triangle == 0 || misses == 3) {
+            clusterStarts.push_back(triangle);
+        }
+    }
+    clusterStarts.push_back(triangleCount);
+    uint32_t clusterCount = static_cast<uint32_t>(clusterStarts.size() - 1);
+    if (clusterCount < 2) {
+        return;
+    }
+
+    // 面積で重み付けした、メッシュ全体と塊ごとの重心・法線
+    std::vector<glm::vec3> clusterCentroids(clusterCount, glm::vec3{0.0f});
+    std::vector<glm::vec3> clusterNormals(clusterCount, glm::vec3{0.0f});
+    std::vector<float> clusterAreas(clusterCount, 0.0f);
+    glm::vec3 meshCentroid{0.0f};
+    float meshArea = 0.0f;
+    for (uint32_t cluster = 0; cluster < clusterCount; cluster++) {
+        for (uint32_t triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1];
+             triangle++) {
+            const glm::vec3& p0 = positions[indices[triangle * 3 + 0]];
+            const glm::vec3& p1 = positions[indices[triangle * 3 + 1]];
+            const glm::vec3& p2 = positions[indices[triangle * 3 + 2]];
+            glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+            float area = glm::length(normal);
+            glm::vec3 centroid = (p0 + p1 + p2) * (area / 3.0f);
+            clusterCentroids[cluster] += centroid;
+            clusterNormals[cluster] += normal;
+            clusterAreas[cluster] += area;
+            meshCentroid += centroid;
+            meshArea += area;
+        }
+    }
+    if (meshArea > 0.0f) {
+        meshCentroid *= 1.0f / meshArea;
+    }
+
+    // 重心が中心から法線の方向に離れている (外側を向いている) 塊ほど先に描く
+    std::vector<float> sortKeys(clusterCount, 0.0f);
+    for (uint32_t cluster = 0; cluster < clusterCount; cluster++) {
+        float normalLength = glm::length(clusterNormals[cluster]);
+        if (clusterAreas[cluster] > 0.0f && normalLength > 0.0f) {
+            glm::vec3 centroid = clusterCentroids[cluster] * (1.0f / clusterAreas[cluster]);
+            sortKeys[cluster] =
+                glm::dot(centroid - meshCentroid, clusterNormals[cluster] * (1.0f / normalLength));
+        }
+    }
+    std::vector<uint32_t> order(clusterCount);
+    for (uint32_t cluster = 0; cluster < clusterCount; cluster++) {
+        order[cluster] = cluster;
+    }
+    std::stable_sort(order.begin(), order.end(),
+                     [&](uint32_t a, uint32_t b) { return sortKeys[a] > sortKeys[b]; });
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    for (uint32_t cluster : order) {
+        output.insert(output.end(), indices.begin() + clusterStarts[cluster] * 3,
+                      indices.begin() + clusterStarts[cluster + 1] * 3);
+    }
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+// 頂点を最初に使われる順に番号を振り直し、インデックスを書き換える
+// 元の頂点 → 新しい頂点 の番号を remap に書き込み (使われない頂点は max)、使われる頂点の数を返す
+inline uint32_t optimizeVertexFetch(std::span<uint32_t> indices,
+                                    uint32_t vertexCount,
+                                    std::vector<uint32_t>& remap) {
+    remap.assign(vertexCount, std::numeric_limits<uint32_t>::max());
+    uint32_t nextVertex = 0;
+    for (uint32_t& index : indices) {
+        if (remap[index] == std::numeric_limits<uint32_t>::max()) {
+            remap[index] = nextVertex++;
+        }
+        index = remap[index];
+    }
+    return nextVertex;
+}
+
+namespace mesh_optimizer_detail {
+// 面までの距離の二乗を表す二次形式 (Garland, Heckbert, "Surface Simplification Using Quadric
+// Error Metrics")。点 p での値は p^T A p + 2 b^T p + c で、面積で重み付けして足し合わせる
+struct Quadric {
+    double a00 = 0.0, a11 = 0.0, a22 = 0.0, a01 = 0.0, a02 = 0.0, a12 = 0.0;
+    double b0 = 0.0, b1 = 0.0, b2 = 0.0;
+    double c = 0.0;
+    double weight = 0.0;
+
+    // 単位法線 (x, y, z) と原点からの距離 d の面
+    static Quadric fromPlane(double x, double y, double z, double d, double area) {
+        Quadric q;
+        q.a00 = area * x * x;
+        q.a11 = area * y * y;
+        q.a22 = area * z * z;
+        q.a01 = area * x * y;
+        q.a02 = area * x * z;
+        q.a12 = area * y * z;
+        q.b0 = area * d * x;
+        q.b1 = area * d * y;
+        q.b2 = area * d * z;
+        q.c = area * d * d;
+        q.weight = area;
+        return q;
+    }
+
+    Quadric& operator+=(const Quadric& other) {
+        a00 += other.a00;
+        a11 += other.a11;
+        a22 += other.a22;
+        a01 += other.a01;
+        a02 += other.a02;
+        a12 += other.a12;
+        b0 += other.b0;
+        b1 += other.b1;
+        b2 += other.b2;
+        c += other.c;
+        weight += other.weight;
+        return *this;
+    }
+
+    // 面までの距離の二乗の (面積による) 加重平均
+    double evaluate(const glm::vec3& p) const {
+        if (weight <= 0.0) {
+            return 0.0;
+        }
+        double x = p.x, y = p.y, z = p.z;
+        double value = a00 * x * x + a11 * y * y + a22 * z * z +
+                       2.0 * (a01 * x * y + a02 * x * z + a12 * y * z) +
+                       2.0 * (b0 * x + b1 * y + b2 * z) + c;
+        return std::max(value, 0.0) / weight;
+    }
+};
+}  // namespace mesh_optimizer_detail
+
+// 辺の縮約 (頂点を隣の頂点に寄せる) でメッシュを簡略化し、新しいインデックスを返す
+// 三角形が targetIndexCount 以下になるか、誤差が targetError を超えるまで縮約する
+// 誤差は面までの距離で、使われている頂点の AABB の半径に対する割合で測り、resultError に書き込む
+// NOTE: 頂点は動かさず元のものを使うので、LOD は元のメッシュと頂点バッファを共有できる
+//       境界と継ぎ目 (同じ位置に複数の頂点がある所) の頂点は、穴やひびが開かないよう動かさない
+inline std::vector<uint32_t> simplifyMesh(std::span<const uint32_t> indices,
+                                          std::span<const glm::vec3> positions,
+                                          size_t targetIndexCount,
+                                          float targetError,
+                                          float* resultError = nullptr) {
+    using mesh_optimizer_detail::Quadric;
+    std::vector<uint32_t> result(indices.begin(), indices.end());
+    if (resultError) {
+        *resultError = 0.0f;
+    }
+    if (result.size() % 3 != 0 || result.size() <= targetIndexCount) {
+        return result;
+    }
+
+    // 位置を中心と半径で正規化する
+    auto vertexCount = static_cast<uint32_t>(positions.size());
+    glm::vec3 min{std::numeric_limits<float>::max()};
+    glm::vec3 max{-std::numeric_limits<float>::max()};
+    for (uint32_t index : result) {
+        min = glm::min(min, positions[index]);
+        max = glm::max(max, positions[index]);
+    }
+    float radius = glm::length(max - min) * 0.5f;
+    if (radius <= 0.0f) {
+        return result;
+    }
+    glm::vec3 center = (min + max) * 0.5f;
+    std::vector<glm::vec3> points(vertexCount);
+    for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+        points[vertex] = (positions[vertex] - center) * (1.0f / radius);
+    }
+
+    // 継ぎ目の頂点
+    std::vector<uint8_t> locked(vertexCount, 0);
+    std::vector<uint32_t> positionRemap;
+    uint32_t positionCount = buildDeduplicationRemap(
+        vertexCount,
+        [&](uint32_t vertex) { return hashBytes(&positions[vertex], sizeof(glm::vec3)); },
+        [&](uint32_t a, uint32_t b) { return positions[a] == positions[b]; }, positionRemap);
+    std::vector<uint32_t> positionUsers(positionCount, 0);
+    for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+        positionUsers[positionRemap[vertex]]++;
+    }
+    for (uint32_t vertex = 0; vertex < vertexCount; vertex++) {
+        locked[vertex] = positionUsers[positionRemap[vertex]] > 1;
+    }
+
+    // 境界の頂点 (逆向きの辺を持つ三角形が無い辺の頂点)
+    auto triangleCount = static_cast<uint32_t>(result.size() / 3);
+    auto makeEdge = [](uint32_t a, uint32_t b) { return (uint64_t{a} << 32) | b; };
+    std::vector<uint64_t> edges;
+    edges.reserve(result.size());
+    for (uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+        for (uint32_t corner = 0; corner < 3; corner++) {
+            edges.push_back(makeEdge(result[triangle * 3 + corner],
+                                     result[triangle * 3 + (corner + 1) % 3]));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    for (uint64_t edge : edges) {
+        auto a = static_cast<uint32_t>(edge >> 32);
+        auto b = static_cast<uint32_t>(edge);
+        if (!std::binary_search(edges.begin(), edges.end(), makeEdge(b, a))) {
+            locked[a] = 1;
+            locked[b] = 1;
+        }
+    }
+
+    // 頂点ごとに、周りの面の二次形式を足し合わせる
+    std::vector<Quadric> quadrics(vertexCount);
+    for (uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+        const glm::vec3& p0 = points[result[triangle * 3 + 0]];
+        const glm::vec3& p1 = points[result[triangle * 3 + 1]];
+        const glm::vec3& p2 = points[result[triangle * 3 + 2]];
+        glm::vec3 normal = glm::cross(p1 - p0, p2 - p0);
+        float length = glm::length(normal);
+        if (length <= 0.0f) {
+            continue;
+        }
+        normal = normal * (1.0f / length);
+        Quadric quadric = Quadric::fromPlane(normal.x, normal.y, normal.z,
+                                             -glm::dot(normal, p0), length * 0.5f);
+        for (uint32_t corner = 0; corner < 3; corner++) {
+            quadrics[result[triangle * 3 + corner]] += quadric;
+        }
+    }
+
+    // 縮約で三角形が裏返るか、潰れて細長くなるか
+    std::vector<uint32_t> adjacencyOffsets(vertexCount + 1);
+    std::vector<uint32_t> adjacency;
+    auto flips = [&](uint32_t from, uint32_t to) {
+        for (uint32_t i = adjacencyOffsets[from]; i < adjacencyOffsets[from + 1]; i++) {
+            const uint32_t* triangle = &result[adjacency[i] * 3];
+            if (triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+                continue;  // この三角形は潰れて消える
+            }
+            glm::vec3 before[3];
+            glm::vec3 after[3];
+            for (uint32_t corner = 0; corner < 3; corner++) {
+                before[corner] = points[triangle[corner]];
+                after[corner] = triangle[corner] == from ? points[to] : before[corner];
+            }
+            glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+            glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+            if (glm::dot(normalBefore, normalAfter) <= 0.0f) {
+                return true;
+            }
+            // NOTE: 面積の 2倍 (法線の長さ) を最も長い辺の長さの二乗と比べる
+            float maxEdgeLength2 = 0.0f;
+            for (uint32_t corner = 0; corner < 3; corner++) {
+                glm::vec3 edge = after[(corner + 1) % 3] - after[corner];
+                maxEdgeLength2 = std::max(maxEdgeLength2, glm::dot(edge, edge));
+            }
+            if (glm::length(normalAfter) <= 1e-3f * maxEdgeLength2) {
+                return true;
+            }
+        }
+        return false;
+    };
+
+    // 誤差の小さい辺から縮約することを繰り返す
+    // NOTE: 一回の走査では、縮約した頂点の周りの頂点をそれ以上動かさない
+    //       (周りの三角形が古いままの誤差や向きで判定されないように)
+    struct Collapse {
+        double error;
+        uint32_t from;
+        uint32_t to;
+    };
+    std::vector<Collapse> collapses;
+    std::vector<uint32_t> remap(vertexCount);
+    std::vector<uint8_t> touched(vertexCount);
+    double errorLimit = static_cast<double>(targetError) * targetError;
+    double maxError = 0.0;
+    while (result.size() > targetIndexCount) {
+        triangleCount = static_cast<uint32_t>(result.size() / 3);
+
+        // 頂点 → 三角形
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+        for (uint32_t index : result) {
+            adjacencyOffsets[index + 1]++;
+        }
+        std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(),
+                         adjacencyOffsets.begin());
+        std::vector<uint32_t> cursors(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        adjacency.resize(result.size());
+        for (uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+            for (uint32_t corner = 0; corner < 3; corner++) {
+                adjacency[cursors[result[triangle * 3 + corner]]++] = triangle;
+            }
+        }
+
+        // 辺ごとに、誤差の小さい方向に縮約する候補を作る
+        // NOTE: 内側の辺は向きを変えて二つの三角形に現れるので、a < b の向きだけを見る
+        collapses.clear();
+        for (uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+            for (uint32_t corner = 0; corner < 3; corner++) {
+                uint32_t a = result[triangle * 3 + corner];
+                uint32_t b = result[triangle * 3 + (corner + 1) % 3];
+                if (a >= b || (locked[a] && locked[b])) {
+                    continue;
+                }
+                Quadric quadric = quadrics[a];
+                quadric += quadrics[b];
+                double errorAB = locked[a] ? std::numeric_limits<double>::max()
+                                           : quadric.evaluate(points[b]);
+                double errorBA = locked[b] ? std::numeric_limits<double>::max()
+                                           : quadric.evaluate(points[a]);
+                if (errorAB <= errorBA) {
+                    collapses.push_back({errorAB, a, b});
+                } else {
+                    collapses.push_back({errorBA, b, a});
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& a, const Collapse& b) {
+            if (a.error != b.error) {
+                return a.error < b.error;
+            }
+            return a.from != b.from ? a.from < b.from : a.to < b.to;
+        });
+
+        std::iota(remap.begin(), remap.end(), 0u);
+        std::fill(touched.begin(), touched.end(), 0);
+        size_t removeLimit = (result.size() - targetIndexCount + 2) / 3;
+        size_t removed = 0;
+        bool collapsed = false;
+        for (const Collapse& collapse : collapses) {
+            if (collapse.error > errorLimit || removed >= removeLimit) {
+                break;
+            }
+            if (touched[collapse.from] || touched[collapse.to] ||
+                flips(collapse.from, collapse.to)) {
+                continue;
+            }
+            remap[collapse.from] = collapse.to;
+            quadrics[collapse.to] += quadrics[collapse.from];
+            for (uint32_t i = adjacencyOffsets[collapse.from];
+                 i < adjacencyOffsets[collapse.from + 1]; i++) {
+                const uint32_t* triangle = &result[adjacency[i] * 3];
+                bool degenerate = false;
+                for (uint32_t corner = 0; corner < 3; corner++) {
+                    touched[triangle[corner]] = 1;
+                    degenerate |= triangle[corner] == collapse.to;
+                }
+                removed += degenerate;
+            }
+            maxError = std::max(maxError, collapse.error);
+            collapsed = true;
+        }
+        if (!collapsed) {
+            break;
+        }
+
+        // 縮約した頂点を寄せた先に書き換え、潰れた三角形を取り除く
+        size_t count = 0;
+        for (uint32_t triangle = 0; triangle < triangleCount; triangle++) {
+            uint32_t a = remap[result[triangle * 3 + 0]];
+            uint32_t b = remap[result[triangle * 3 + 1]];
+            uint32_t c = remap[result[triangle * 3 + 2]];
+            if (a != b && b != c && c != a) {
+                result[count++] = a;
+                result[count++] = b;
+                result[count++] = c;
+            }
+        }
+        result.resize(count);
+    }
+
+    if (resultError) {
+        *resultError = static_cast<float>(std::sqrt(maxError));
+    }
+    return result;
+}
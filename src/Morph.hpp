@@ -0,0 +1,177 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// モーフターゲットの差分 (頂点一つ、ターゲット一つ分)
+// NOTE: コンピュートシェーダからそのまま読むため std430 の配置に合わせる
+struct MorphDelta {
+    glm::vec3 position{0.0f};
+    uint32_t target = 0;  // メッシュ内のターゲットの番号
+    glm::vec3 normal{0.0f};
+    float _dummy0{};
+    glm::vec3 tangent{0.0f};
+    float _dummy1{};
+};
+
+// glTF のプリミティブの targets 一つ分 (頂点ごとの密な差分)
+// NOTE: 持たない属性は空のまま
+struct MorphTargetAttributes {
+    std::vector<glm::vec3> positions;
+    std::vector<glm::vec3> normals;
+    std::vector<glm::vec3> tangents;
+};
+
+// メッシュデータ全体のモーフターゲットの差分を疎に保持する
+// 差分が 0 でない (頂点, ターゲット) の組だけを頂点順に詰め、頂点ごとに範囲 (先頭, 個数) を持つ
+// NOTE: 頂点ごとにまとめておくと、GPU では一つのスレッドが自分の頂点の差分を足すだけで済み、
+//       複数のターゲットが同じ頂点に書き込んで衝突することがない
+class MorphTargets {
+public:
+    // [vertexOffset, vertexOffset + vertexCount) の頂点のターゲットを追加し、追加した差分の数を返す
+    uint32_t add(uint32_t vertexOffset,
+                 uint32_t vertexCount,
+                 std::span<const MorphTargetAttributes> targets) {
+        resize(vertexOffset + vertexCount);
+        size_t firstDelta = deltas.size();
+        for (uint32_t i = 0; i < vertexCount; i++) {
+            uint32_t first = static_cast<uint32_t>(deltas.size());
+            for (uint32_t target = 0; target < targets.size(); target++) {
+                const MorphTargetAttributes& attributes = targets[target];
+                MorphDelta delta{};
+                delta.target = target;
+                if (i < attributes.positions.size()) {
+                    delta.position = attributes.positions[i];
+                }
+                if (i < attributes.normals.size()) {
+                    delta.normal = attributes.normals[i];
+                }
+                if (i < attributes.tangents.size()) {
+                    delta.tangent = attributes.tangents[i];
+                }
+                glm::vec3 zero{0.0f};
+                if (delta.position != zero || delta.normal != zero || delta.tangent != zero) {
+                    deltas.push_back(delta);
+                }
+            }
+            ranges[vertexOffset + i] = {first, static_cast<uint32_t>(deltas.size()) - first};
+        }
+        return static_cast<uint32_t>(deltas.size() - firstDelta);
+    }
+
+    // 書き出したものをそのまま読み込む
+    void assign(std::span<const glm::uvec2> newRanges, std::span<const MorphDelta> newDeltas) {
+        ranges.assign(newRanges.begin(), newRanges.end());
+        deltas.assign(newDeltas.begin(), newDeltas.end());
+    }
+
+    // モーフターゲットを持たない頂点の分は範囲 0 で埋める
+    void resize(size_t vertexCount) {
+        ranges.resize(std::max(ranges.size(), vertexCount), glm::uvec2{0});
+    }
+
+    bool empty() const {
+        return deltas.empty();
+    }
+
+    std::span<const glm::uvec2> getRanges() const {
+        return ranges;
+    }
+
+    std::span<const MorphDelta> getDeltas() const {
+        return deltas;
+    }
+
+private:
+    std::vector<glm::uvec2> ranges;  // 頂点ごと
+    std::vector<MorphDelta> deltas;
+};
+
+// 全インスタンスのモーフターゲットのウェイト
+// glTF ではウェイトをメッシュ (を持つノード) ごとに持ち、プリミティブ間で共有する
+// NOTE: アニメーションのトラックはこの配列の位置を対象にする
+class MorphWeights {
+public:
+    // 配列上の先頭位置を返す
+    uint32_t addInstance(std::span<const float> defaultWeights) {
+        uint32_t first = static_cast<uint32_t>(weights.size());
+        weights.insert(weights.end(), defaultWeights.begin(), defaultWeights.end());
+        dirty = true;
+        return first;
+    }
+
+    // NOTE: 範囲ごとに別のスレッドから書き込んでよい。書き終えたら markDirty() を呼ぶ
+    std::span<float> getWeights() {
+        return weights;
+    }
+
+    std::span<const float> getWeights() const {
+        return weights;
+    }
+
+    void markDirty() {
+        dirty = true;
+    }
+
+    // 前回の読み出しから変更があったか (リセットしない)
+    bool isDirty() const {
+        return dirty;
+    }
+
+    // 前回の読み出しから変更があったか (読み出すとリセットされる)
+    bool consumeDirty() {
+        bool wasDirty = dirty;
+        dirty = false;
+        return wasDirty;
+    }
+
+    // ウェイトが全て 0 なら、そのインスタンスはモーフの計算を丸ごと省ける
+    bool isZero(uint32_t first, uint32_t count) const {
+        return std::all_of(weights.begin() + first, weights.begin() + first + count,
+                           [](float weight) { return weight == 0.0f; });
+    }
+
+    bool empty() const {
+        return weights.empty();
+    }
+
+    void clear() {
+        weights.clear();
+        dirty = true;
+    }
+
+private:
+    std::vector<float> weights;
+    bool dirty = false;
+};
+
+// CPU でのモーフターゲットの適用 (GPU の deform.comp と同じ計算)
+// srcVertices / dstVertices はメッシュデータの vertexOffset から始まる範囲
+// NOTE: テストや検証用の参照実装。ウェイトが 0 のターゲットの差分は読み飛ばす
+template <typename Vertex>
+void applyMorphTargets(std::span<const Vertex> srcVertices,
+                       const MorphTargets& morphTargets,
+                       uint32_t vertexOffset,
+                       std::span<const float> weights,
+                       std::span<Vertex> dstVertices) {
+    std::span<const glm::uvec2> ranges = morphTargets.getRanges();
+    std::span<const MorphDelta> deltas = morphTargets.getDeltas();
+    for (size_t i = 0; i < srcVertices.size(); i++) {
+        Vertex& dst = dstVertices[i];
+        dst = srcVertices[i];
+        glm::uvec2 range = ranges[vertexOffset + i];
+        for (uint32_t d = range.x; d < range.x + range.y; d++) {
+            const MorphDelta& delta = deltas[d];
+            float weight = weights[delta.target];
+            if (weight == 0.0f) {
+                continue;
+            }
+            dst.position += weight * delta.position;
+            dst.normal += weight * delta.normal;
+            dst.tangent += glm::vec4{weight * delta.tangent, 0.0f};
+        }
+    }
+}
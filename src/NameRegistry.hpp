@@ -0,0 +1,69 @@
+#pragma once
+#include <cstdint>
+#include <format>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+// std::string をキーにしたまま string_view で検索するためのハッシュ
+struct StringHash {
+    using is_transparent = void;
+
+    size_t operator()(std::string_view str) const {
+        return std::hash<std::string_view>{}(str);
+    }
+};
+
+// 名前からハンドルを引くための索引
+// 名前の文字列はこのクラスが保持し、利用側には string_view で渡す
+// NOTE: unordered_map のノードは再ハッシュされても移動しないため、
+//       返した string_view は登録を解除するまで有効
+template <typename Handle>
+class NameRegistry {
+public:
+    // 重複しない名前で登録し、保持している名前を返す
+    // 既に使われている場合は "name 0", "name 1", ... と接尾辞を付ける
+    // NOTE: 接尾辞は元の名前ごとに続きから探すため、同名が大量にあっても線形時間で済む
+    std::string_view add(std::string_view name, Handle handle) {
+        if (!names.contains(name)) {
+            return names.emplace(std::string{name}, handle).first->first;
+        }
+
+        auto counter = suffixCounters.find(name);
+        if (counter == suffixCounters.end()) {
+            counter = suffixCounters.emplace(std::string{name}, 0).first;
+        }
+
+        std::string newName;
+        do {
+            newName = std::format("{} {}", name, counter->second++);
+        } while (names.contains(newName));
+        return names.emplace(std::move(newName), handle).first->first;
+    }
+
+    void remove(std::string_view name) {
+        if (auto it = names.find(name); it != names.end()) {
+            names.erase(it);
+        }
+    }
+
+    // 見つからなければ無効なハンドルを返す
+    Handle find(std::string_view name) const {
+        auto it = names.find(name);
+        return it != names.end() ? it->second : Handle{};
+    }
+
+    size_t size() const {
+        return names.size();
+    }
+
+    void clear() {
+        names.clear();
+        suffixCounters.clear();
+    }
+
+private:
+    std::unordered_map<std::string, Handle, StringHash, std::equal_to<>> names;
+    std::unordered_map<std::string, uint32_t, StringHash, std::equal_to<>> suffixCounters;
+};
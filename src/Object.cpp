@@ -1,5 +1,8 @@
 #include "Object.hpp"
 
+#include <numeric>
+
+#include "JobSystem.hpp"
 #include "Scene.hpp"
 #include "WindowAdapter.hpp"
 
@@ -10,15 +13,11 @@ glm::mat4 Transform::computeTransformMatrix() const {
     return T * R * S;
 }
 
-glm::mat4 Transform::computeNormalMatrix() const {
-    glm::mat4 R = glm::mat4_cast(rotation);
-    glm::mat4 S = glm::scale(glm::mat4{1.0}, glm::vec3{1.0} / scale);
-    return R * S;
-}
-
 void Transform::showAttributes(Scene& scene) {
     ImGui::SetNextItemOpen(true, ImGuiCond_Once);
     if (ImGui::TreeNode("Transform")) {
+        bool changed = false;
+
         // Translation
         changed |= ImGui::DragFloat3("Translation", glm::value_ptr(translation), 0.01f);
 
@@ -30,6 +29,23 @@ void Transform::showAttributes(Scene& scene) {
         // Scale
         changed |= ImGui::DragFloat3("Scale", glm::value_ptr(scale), 0.01f);
 
+        if (changed) {
+            scene.markChanged(*this, ChangeField::Transform);
+        }
+
+        int rateIndex = static_cast<int>(animationRate);
+        if (ImGui::Combo("Animation rate", &rateIndex,
+                         "Auto\0Full\0Half\0Quarter\0Sixteenth\0Paused\0", 6)) {
+            animationRate = static_cast<AnimationRate>(rateIndex);
+        }
+
+        // 再生中のクリップを焼き込み、以降は GPU で再生する
+        if (ImGui::Button("Bake animation")) {
+            if (Object* owner = scene.getObject(object)) {
+                scene.bakeAnimation(*owner);
+            }
+        }
+
         ImGui::TreePop();
     }
 }
@@ -45,22 +61,16 @@ glm::vec3 DirectionalLight::getDirection() const {
 
 glm::mat4 DirectionalLight::getViewProj(const rv::AABB& aabb) const {
     // Transform AABB to light space
-    std::vector<glm::vec3> corners = aabb.getCorners();
+    // NOTE: dir 方向に最も遠い頂点は、各軸で dir と同じ符号の側にある
     glm::vec3 center = aabb.center;
     glm::vec3 dir = getDirection();
-    glm::vec3 furthestCorner = aabb.getFurthestCorner(dir);
+    glm::vec3 furthestCorner = center + aabb.extents * glm::sign(dir);
     float length = glm::dot(furthestCorner, dir);
     glm::mat4 view = glm::lookAt(center, center - dir * length, glm::vec3(0, 1, 0));
 
-    // Initialize bounds
-    glm::vec3 minBounds = glm::vec3(FLT_MAX);
-    glm::vec3 maxBounds = glm::vec3(-FLT_MAX);
-
-    for (const auto& corner : corners) {
-        glm::vec3 transformedCorner = glm::vec3(view * glm::vec4(corner, 1.0f));
-        minBounds = glm::min(minBounds, transformedCorner);
-        maxBounds = glm::max(maxBounds, transformedCorner);
-    }
+    rv::AABB lightSpaceAABB = transformAABB(aabb, view);
+    glm::vec3 minBounds = lightSpaceAABB.center - lightSpaceAABB.extents;
+    glm::vec3 maxBounds = lightSpaceAABB.center + lightSpaceAABB.extents;
 
     // Calculate orthographic projection bounds
     float scaling = 1.05f;
@@ -84,6 +94,7 @@ glm::mat4 DirectionalLight::getRotationMatrix() const {
 void DirectionalLight::showAttributes(Scene& scene) {
     ImGui::SetNextItemOpen(true, ImGuiCond_Once);
     if (ImGui::TreeNode("Directional light")) {
+        bool changed = false;
         changed |= ImGui::ColorEdit3("Color", glm::value_ptr(color));
         changed |= ImGui::DragFloat("Intensity", &intensity, 0.001f, 0.0f, 100.0f);
         changed |= ImGui::SliderFloat("Phi", &phi, -180.0f, 180.0f);
@@ -95,6 +106,10 @@ void DirectionalLight::showAttributes(Scene& scene) {
             changed |= ImGui::SliderFloat("Shadow bias", &shadowBias, 0.0f, 0.01f);
         }
 
+        if (changed) {
+            scene.markChanged(*this, ChangeField::Light);
+        }
+
         ImGui::TreePop();
     }
 }
@@ -102,9 +117,13 @@ void DirectionalLight::showAttributes(Scene& scene) {
 void PointLight::showAttributes(Scene& scene) {
     ImGui::SetNextItemOpen(true, ImGuiCond_Once);
     if (ImGui::TreeNode("Point light")) {
+        bool changed = false;
         changed |= ImGui::ColorEdit3("Color", glm::value_ptr(color));
         changed |= ImGui::DragFloat("Intensity", &intensity, 0.001f, 0.0f, 100.0f);
         changed |= ImGui::DragFloat("Radius", &radius, 0.001f, 0.0f, 100.0f);
+        if (changed) {
+            scene.markChanged(*this, ChangeField::Light);
+        }
         ImGui::TreePop();
     }
 }
@@ -112,6 +131,7 @@ void PointLight::showAttributes(Scene& scene) {
 void AmbientLight::showAttributes(Scene& scene) {
     ImGui::SetNextItemOpen(true, ImGuiCond_Once);
     if (ImGui::TreeNode("Ambient light")) {
+        bool changed = false;
         changed |= ImGui::ColorEdit3("Color", glm::value_ptr(color));
         changed |= ImGui::DragFloat("Intensity", &intensity, 0.001f, 0.0f, 100.0f);
 
@@ -119,8 +139,11 @@ void AmbientLight::showAttributes(Scene& scene) {
         for (auto& tex : scene.getTexturesCube()) {
             ss << tex.name << '\0';
         }
-        ImGui::Combo("Radiance texture", &radianceTexture, ss.str().c_str());
-        ImGui::Combo("Irradiance texture", &irradianceTexture, ss.str().c_str());
+        changed |= ImGui::Combo("Radiance texture", &radianceTexture, ss.str().c_str());
+        changed |= ImGui::Combo("Irradiance texture", &irradianceTexture, ss.str().c_str());
+        if (changed) {
+            scene.markChanged(*this, ChangeField::Light);
+        }
         ImGui::TreePop();
     }
 }
@@ -171,6 +194,13 @@ MeshData::MeshData(const rv::Context& context, MeshType type) {
         for (int i = 0; i < vertices.size(); i++) {
             indices.push_back(i);
         }
+
+        // NOTE: 頂点を共有しない三角形の羅列なので、読み込んだメッシュと同じく頂点をまとめる
+        Mesh mesh;
+        mesh.indexCount = static_cast<uint32_t>(indices.size());
+        mesh.vertexCount = static_cast<uint32_t>(vertices.size());
+        Mesh* meshes[] = {&mesh};
+        optimize(meshes);
     } else if (type == MeshType::Plane) {
         vertices = {
             {glm::vec3{-1.0f, 0.0f, -1.0f}, glm::vec3{0.0f, 1.0f, 0.0f}, glm::vec2{0.0f, 0.0f}},
@@ -184,93 +214,458 @@ MeshData::MeshData(const rv::Context& context, MeshType type) {
 }
 
 void MeshData::createBuffers(const rv::Context& context) {
+    // NOTE: 変形するメッシュの頂点は変形のコンピュートシェーダからも読む
+    bool deformable = isDeformable();
     vertexBuffer = context.createBuffer({
-        .usage = rv::BufferUsage::Vertex,
+        .usage = deformable ? rv::BufferUsage::Vertex | vk::BufferUsageFlagBits::eStorageBuffer
+                            : rv::BufferUsage::Vertex,
         .memory = rv::MemoryUsage::Device,
         .size = sizeof(VertexPNUT) * vertices.size(),
         .debugName = name + "::vertexBuffer",
     });
 
+    if (deformable) {
+        // 変形しないメッシュの分はウェイト 0、差分の範囲 0 で埋める
+        // NOTE: 片方しか使わない場合も、ディスクリプタセットに渡すためバッファは必ず作る
+        skinVertices.resize(vertices.size());
+        morphTargets.resize(vertices.size());
+        skinVertexBuffer = context.createBuffer({
+            .usage = rv::BufferUsage::Storage,
+            .memory = rv::MemoryUsage::Device,
+            .size = sizeof(SkinVertex) * skinVertices.size(),
+            .debugName = name + "::skinVertexBuffer",
+        });
+        morphRangeBuffer = context.createBuffer({
+            .usage = rv::BufferUsage::Storage,
+            .memory = rv::MemoryUsage::Device,
+            .size = sizeof(glm::uvec2) * morphTargets.getRanges().size(),
+            .debugName = name + "::morphRangeBuffer",
+        });
+        morphDeltaBuffer = context.createBuffer({
+            .usage = rv::BufferUsage::Storage,
+            .memory = rv::MemoryUsage::Device,
+            .size = sizeof(MorphDelta) * std::max(morphTargets.getDeltas().size(), size_t{1}),
+            .debugName = name + "::morphDeltaBuffer",
+        });
+        deformedVertexBuffer = context.createBuffer({
+            .usage = rv::BufferUsage::Vertex | vk::BufferUsageFlagBits::eStorageBuffer,
+            .memory = rv::MemoryUsage::Device,
+            .size = sizeof(VertexPNUT) * vertices.size(),
+            .debugName = name + "::deformedVertexBuffer",
+        });
+    }
+
+    // NOTE: 32ビットと16ビットのインデックスは一つのバッファの別々の領域に置く
+    size_t indexBufferSize = getIndices16Offset() + sizeof(uint16_t) * indices16.size();
     indexBuffer = context.createBuffer({
         .usage = rv::BufferUsage::Index,
         .memory = rv::MemoryUsage::Device,
-        .size = sizeof(uint32_t) * indices.size(),
+        .size = indexBufferSize,
         .debugName = name + "::indexBuffer",
     });
+    std::vector<std::byte> indexBytes;
+    if (!indices16.empty()) {
+        indexBytes.resize(indexBufferSize);
+        std::memcpy(indexBytes.data(), indices.data(), getIndices16Offset());
+        std::memcpy(indexBytes.data() + getIndices16Offset(), indices16.data(),
+                    sizeof(uint16_t) * indices16.size());
+    }
 
     context.oneTimeSubmit([&](rv::CommandBufferHandle commandBuffer) {
         commandBuffer->copyBuffer(vertexBuffer, vertices.data());
-        commandBuffer->copyBuffer(indexBuffer, indices.data());
+        commandBuffer->copyBuffer(indexBuffer,
+                                  indexBytes.empty() ? static_cast<const void*>(indices.data())
+                                                     : indexBytes.data());
+        if (deformable) {
+            // NOTE: 変形されるまではバインドポーズ・ベースの形状で描画する
+            commandBuffer->copyBuffer(skinVertexBuffer, skinVertices.data());
+            commandBuffer->copyBuffer(morphRangeBuffer, morphTargets.getRanges().data());
+            if (!morphTargets.empty()) {
+                commandBuffer->copyBuffer(morphDeltaBuffer, morphTargets.getDeltas().data());
+            }
+            commandBuffer->copyBuffer(deformedVertexBuffer, vertices.data());
+        }
     });
 }
 
-void Mesh::computeLocalAABB() {
-    glm::vec3 min = glm::vec3{FLT_MAX, FLT_MAX, FLT_MAX};
-    glm::vec3 max = glm::vec3{-FLT_MAX, -FLT_MAX, -FLT_MAX};
-    auto& vertices = meshData->vertices;
-    auto& indices = meshData->indices;
-    for (uint32_t index = firstIndex;  //
-         index < firstIndex + indexCount; index++) {
-        auto& vert = vertices[vertexOffset + indices[index]];
-        min = glm::min(min, vert.position);
-        max = glm::max(max, vert.position);
+namespace {
+// メッシュ一つ分の最適化の結果
+struct OptimizedMesh {
+    std::vector<uint32_t> indices;  // 最適化後の頂点の番号
+    std::vector<uint32_t> sources;  // 最適化後の頂点 → 元の頂点 (どちらもメッシュ内の番号)
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+OptimizedMesh optimizeMesh(const MeshData& data, const Mesh& mesh) {
+    OptimizedMesh result;
+    auto firstIndex = data.indices.begin() + mesh.firstIndex;
+    result.indices.assign(firstIndex, firstIndex + mesh.indexCount);
+    result.before = analyzeVertexCache(result.indices, mesh.vertexCount);
+
+    // 三角形のリストでないか、範囲外の頂点を指すメッシュは並べ替えない
+    bool valid = mesh.indexCount % 3 == 0 &&
+                 std::all_of(result.indices.begin(), result.indices.end(),
+                             [&](uint32_t index) { return index < mesh.vertexCount; });
+    if (!valid) {
+        result.sources.resize(mesh.vertexCount);
+        std::iota(result.sources.begin(), result.sources.end(), 0u);
+        result.after = result.before;
+        return result;
     }
-    aabb = {min, max};
+
+    // 同じ頂点をまとめる
+    // NOTE: スキンを持つ場合は関節とウェイトも一致する頂点だけをまとめる
+    //       モーフターゲットの差分を持つ頂点は、差分が頂点ごとに異なるのでまとめない
+    const VertexPNUT* vertices = data.vertices.data() + mesh.vertexOffset;
+    const SkinVertex* skins = nullptr;
+    if (data.skinVertices.size() >= mesh.vertexOffset + mesh.vertexCount) {
+        skins = data.skinVertices.data() + mesh.vertexOffset;
+    }
+    std::span<const glm::uvec2> morphRanges = data.morphTargets.getRanges();
+    auto hasMorphDeltas = [&](uint32_t vertex) {
+        size_t index = mesh.vertexOffset + vertex;
+        return index < morphRanges.size() && morphRanges[index].y > 0;
+    };
+    auto hash = [&](uint32_t vertex) {
+        uint64_t value = hashBytes(&vertices[vertex], sizeof(VertexPNUT));
+        return skins ? hashBytes(&skins[vertex], sizeof(SkinVertex), value) : value;
+    };
+    auto equal = [&](uint32_t a, uint32_t b) {
+        if (hasMorphDeltas(a) || hasMorphDeltas(b)) {
+            return false;
+        }
+        return std::memcmp(&vertices[a], &vertices[b], sizeof(VertexPNUT)) == 0 &&
+               (!skins || std::memcmp(&skins[a], &skins[b], sizeof(SkinVertex)) == 0);
+    };
+    std::vector<uint32_t> uniqueRemap;
+    uint32_t uniqueCount = buildDeduplicationRemap(mesh.vertexCount, hash, equal, uniqueRemap);
+    std::vector<uint32_t> uniqueSources(uniqueCount);
+    for (uint32_t vertex = mesh.vertexCount; vertex-- > 0;) {
+        uniqueSources[uniqueRemap[vertex]] = vertex;
+    }
+    for (uint32_t& index : result.indices) {
+        index = uniqueRemap[index];
+    }
+
+    // 三角形を並べ替える
+    std::vector<glm::vec3> positions(uniqueCount);
+    for (uint32_t vertex = 0; vertex < uniqueCount; vertex++) {
+        positions[vertex] = vertices[uniqueSources[vertex]].position;
+    }
+    optimizeVertexCache(result.indices, uniqueCount);
+    optimizeOverdraw(result.indices, positions);
+
+    // 頂点を使われる順に並べる
+    std::vector<uint32_t> fetchRemap;
+    uint32_t vertexCount = optimizeVertexFetch(result.indices, uniqueCount, fetchRemap);
+    result.sources.resize(vertexCount);
+    for (uint32_t vertex = 0; vertex < uniqueCount; vertex++) {
+        if (fetchRemap[vertex] != std::numeric_limits<uint32_t>::max()) {
+            result.sources[fetchRemap[vertex]] = uniqueSources[vertex];
+        }
+    }
+    result.after = analyzeVertexCache(result.indices, vertexCount);
+    return result;
+}
+}  // namespace
+
+std::pair<VertexCacheStats, VertexCacheStats> MeshData::optimize(std::span<Mesh* const> meshes,
+                                                                 JobSystem* jobSystem) {
+    std::vector<OptimizedMesh> results(meshes.size());
+    auto optimizeMeshes = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            results[i] = optimizeMesh(*this, *meshes[i]);
+        }
+    };
+    if (jobSystem) {
+        jobSystem->parallelFor(static_cast<uint32_t>(meshes.size()), 1, optimizeMeshes);
+    } else {
+        optimizeMeshes(0, static_cast<uint32_t>(meshes.size()));
+    }
+
+    // 頂点ごとの配列をメッシュの順に詰め直す
+    // NOTE: インデックスの数と位置は変わらないので、元の範囲に書き戻す
+    std::span<const glm::uvec2> morphRanges = morphTargets.getRanges();
+    std::vector<VertexPNUT> newVertices;
+    std::vector<SkinVertex> newSkinVertices;
+    std::vector<glm::uvec2> newMorphRanges;
+    newVertices.reserve(vertices.size());
+    std::pair<VertexCacheStats, VertexCacheStats> stats;
+    for (size_t i = 0; i < meshes.size(); i++) {
+        Mesh& mesh = *meshes[i];
+        const OptimizedMesh& result = results[i];
+        uint32_t vertexOffset = static_cast<uint32_t>(newVertices.size());
+        for (uint32_t source : result.sources) {
+            size_t index = mesh.vertexOffset + source;
+            newVertices.push_back(vertices[index]);
+            if (!skinVertices.empty()) {
+                newSkinVertices.push_back(index < skinVertices.size() ? skinVertices[index]
+                                                                      : SkinVertex{});
+            }
+            if (!morphRanges.empty()) {
+                newMorphRanges.push_back(index < morphRanges.size() ? morphRanges[index]
+                                                                    : glm::uvec2{0});
+            }
+        }
+        std::copy(result.indices.begin(), result.indices.end(),
+                  indices.begin() + mesh.firstIndex);
+        mesh.vertexOffset = vertexOffset;
+        mesh.vertexCount = static_cast<uint32_t>(result.sources.size());
+        stats.first += result.before;
+        stats.second += result.after;
+    }
+    vertices = std::move(newVertices);
+    if (!skinVertices.empty()) {
+        skinVertices = std::move(newSkinVertices);
+    }
+    if (!morphRanges.empty()) {
+        std::vector<MorphDelta> deltas(morphTargets.getDeltas().begin(),
+                                       morphTargets.getDeltas().end());
+        morphTargets.assign(newMorphRanges, deltas);
+    }
+    return stats;
 }
 
-rv::AABB Mesh::getWorldAABB() const {
-    // WARN: frameは受け取らない
-    auto* transform = object->get<Transform>();
+void MeshData::buildClusters(std::span<Mesh* const> meshes, JobSystem* jobSystem) {
+    std::vector<std::vector<MeshCluster>> meshClusters(meshes.size());
+    auto buildMeshes = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            const Mesh& mesh = *meshes[i];
+            if (mesh.indexType != vk::IndexType::eUint32 || mesh.indexCount % 3 != 0) {
+                continue;
+            }
+            std::vector<glm::vec3> positions(mesh.vertexCount);
+            for (uint32_t vertex = 0; vertex < mesh.vertexCount; vertex++) {
+                positions[vertex] = vertices[mesh.vertexOffset + vertex].position;
+            }
+            std::span<uint32_t> meshIndices{indices.data() + mesh.firstIndex, mesh.indexCount};
+            meshClusters[i] = buildMeshClusters(meshIndices, positions);
+        }
+    };
+    if (jobSystem) {
+        jobSystem->parallelFor(static_cast<uint32_t>(meshes.size()), 1, buildMeshes);
+    } else {
+        buildMeshes(0, static_cast<uint32_t>(meshes.size()));
+    }
 
-    rv::AABB _aabb = getLocalAABB();
-    if (!transform) {
-        return _aabb;
+    auto allClusters = std::make_shared<std::vector<MeshCluster>>();
+    for (size_t i = 0; i < meshes.size(); i++) {
+        meshes[i]->firstCluster = static_cast<uint32_t>(allClusters->size());
+        meshes[i]->clusterCount = static_cast<uint32_t>(meshClusters[i].size());
+        allClusters->insert(allClusters->end(), meshClusters[i].begin(), meshClusters[i].end());
     }
+    clusters = std::move(allClusters);
+}
 
-    // Apply scale to the extents
-    _aabb.center *= transform->scale;
-    _aabb.extents *= transform->scale;
+void MeshData::generateLods(std::span<Mesh* const> meshes, JobSystem* jobSystem) {
+    // NOTE: 誤差はメッシュの半径に対する割合
+    constexpr float maxError = 0.05f;
+    constexpr float minReduction = 0.8f;  // これより減らなければ打ち切る
+    constexpr size_t minIndexCount = 3 * 32;
+
+    std::vector<std::vector<std::vector<uint32_t>>> meshLodIndices(meshes.size());
+    std::vector<std::array<float, maxMeshLodCount>> meshLodErrors(meshes.size());
+    auto simplifyMeshes = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            const Mesh& mesh = *meshes[i];
+            if (mesh.indexCount % 3 != 0 || mesh.indexCount < minIndexCount) {
+                continue;
+            }
+            std::vector<glm::vec3> positions(mesh.vertexCount);
+            for (uint32_t vertex = 0; vertex < mesh.vertexCount; vertex++) {
+                positions[vertex] = vertices[mesh.vertexOffset + vertex].position;
+            }
+            auto firstIndex = indices.begin() + mesh.firstIndex;
+            std::vector<uint32_t> source(firstIndex, firstIndex + mesh.indexCount);
+
+            // 一つ前の段階を簡略化し、誤差は各段階の誤差の和で見積もる
+            float error = 0.0f;
+            for (uint32_t level = 0; level < maxMeshLodCount; level++) {
+                float stepError = 0.0f;
+                std::vector<uint32_t> simplified = simplifyMesh(
+                    source, positions, source.size() / 2, maxError - error, &stepError);
+                if (simplified.empty() || static_cast<float>(simplified.size()) >
+                                              static_cast<float>(source.size()) * minReduction) {
+                    break;
+                }
+                optimizeVertexCache(simplified, mesh.vertexCount);
+                error += stepError;
+                meshLodErrors[i][level] = error;
+                meshLodIndices[i].push_back(simplified);
+                source = std::move(simplified);
+            }
+        }
+    };
+    if (jobSystem) {
+        jobSystem->parallelFor(static_cast<uint32_t>(meshes.size()), 1, simplifyMeshes);
+    } else {
+        simplifyMeshes(0, static_cast<uint32_t>(meshes.size()));
+    }
 
-    // Rotate corners of the AABB and find min/max extents
-    std::vector<glm::vec3> corners = _aabb.getCorners();
+    for (size_t i = 0; i < meshes.size(); i++) {
+        Mesh& mesh = *meshes[i];
+        mesh.lodCount = static_cast<uint32_t>(meshLodIndices[i].size());
+        for (uint32_t level = 0; level < mesh.lodCount; level++) {
+            const std::vector<uint32_t>& lodIndices = meshLodIndices[i][level];
+            mesh.lods[level] = {
+                .firstIndex = static_cast<uint32_t>(indices.size()),
+                .indexCount = static_cast<uint32_t>(lodIndices.size()),
+                .error = meshLodErrors[i][level],
+            };
+            indices.insert(indices.end(), lodIndices.begin(), lodIndices.end());
+        }
+    }
+}
 
-    glm::vec3 min = glm::vec3{std::numeric_limits<float>::max()};
-    glm::vec3 max = -glm::vec3{std::numeric_limits<float>::max()};
-    for (auto& corner : corners) {
-        // Apply rotation
-        glm::vec3 rotatedCorner = transform->rotation * corner;
+void MeshData::compactIndices(std::span<Mesh* const> meshes) {
+    std::vector<uint32_t> indices32;
+    indices32.reserve(indices.size());
+    indices16.clear();
+    for (Mesh* mesh : meshes) {
+        assert(mesh->indexType == vk::IndexType::eUint32);
+        auto first = indices.begin() + mesh->firstIndex;
+        auto last = first + mesh->indexCount;
+        // NOTE: LOD は元のメッシュの頂点の一部しか使わないので、元のメッシュだけで判定できる
+        uint32_t maxIndex = mesh->indexCount > 0 ? *std::max_element(first, last) : 0;
+        bool fits16 = maxIndex <= std::numeric_limits<uint16_t>::max();
+        auto moveIndices = [&](uint32_t& firstIndex, uint32_t indexCount) {
+            auto begin = indices.begin() + firstIndex;
+            if (fits16) {
+                firstIndex = static_cast<uint32_t>(indices16.size());
+                std::transform(begin, begin + indexCount, std::back_inserter(indices16),
+                               [](uint32_t index) { return static_cast<uint16_t>(index); });
+            } else {
+                firstIndex = static_cast<uint32_t>(indices32.size());
+                indices32.insert(indices32.end(), begin, begin + indexCount);
+            }
+        };
+        moveIndices(mesh->firstIndex, mesh->indexCount);
+        for (uint32_t level = 0; level < mesh->lodCount; level++) {
+            moveIndices(mesh->lods[level].firstIndex, mesh->lods[level].indexCount);
+        }
+        if (fits16) {
+            mesh->indexType = vk::IndexType::eUint16;
+        }
+    }
+    indices = std::move(indices32);
+}
 
-        // Update min and max extents
-        min = glm::min(min, rotatedCorner);
-        max = glm::max(max, rotatedCorner);
+void Mesh::computeLocalAABB(const MeshData& meshData) {
+    glm::vec3 min = glm::vec3{FLT_MAX, FLT_MAX, FLT_MAX};
+    glm::vec3 max = glm::vec3{-FLT_MAX, -FLT_MAX, -FLT_MAX};
+    auto& vertices = meshData.vertices;
+    auto expand = [&](const auto& indices) {
+        for (uint32_t index = firstIndex;  //
+             index < firstIndex + indexCount; index++) {
+            auto& vert = vertices[vertexOffset + indices[index]];
+            min = glm::min(min, vert.position);
+            max = glm::max(max, vert.position);
+        }
+    };
+    if (indexType == vk::IndexType::eUint16) {
+        expand(meshData.indices16);
+    } else {
+        expand(meshData.indices);
     }
+    aabb = {min, max};
+}
 
-    // Compute new AABB
-    rv::AABB worldAABB{min, max};
+rv::AABB Mesh::computeJointAABBs(const MeshData& meshData,
+                                 std::span<rv::AABB> jointAABBs) const {
+    // NOTE: 末尾は動かない頂点の分
+    size_t jointCount = jointAABBs.size();
+    std::vector<glm::vec3> mins(jointCount + 1, glm::vec3{FLT_MAX, FLT_MAX, FLT_MAX});
+    std::vector<glm::vec3> maxs(jointCount + 1, glm::vec3{-FLT_MAX, -FLT_MAX, -FLT_MAX});
+    auto expand = [&](size_t joint, const glm::vec3& position) {
+        mins[joint] = glm::min(mins[joint], position);
+        maxs[joint] = glm::max(maxs[joint], position);
+    };
+    for (uint32_t vertex = vertexOffset; vertex < vertexOffset + vertexCount; vertex++) {
+        const glm::vec3& position = meshData.vertices[vertex].position;
+        const SkinVertex& skin = meshData.skinVertices[vertex];
+        bool skinned = false;
+        for (int i = 0; i < 4; i++) {
+            // NOTE: 変形のシェーダーと同じく、ウェイトが 0 でない関節だけが頂点を動かす
+            if (skin.weights[i] != 0.0f && skin.joints[i] < jointCount) {
+                expand(skin.joints[i], position);
+                skinned = true;
+            }
+        }
+        if (!skinned) {
+            expand(jointCount, position);
+        }
+    }
+    for (size_t joint = 0; joint < jointCount; joint++) {
+        jointAABBs[joint] = {mins[joint], maxs[joint]};
+    }
+    return {mins[jointCount], maxs[jointCount]};
+}
 
-    // Apply translation
-    worldAABB.center += transform->translation;
-    return worldAABB;
+rv::AABB transformAABB(const rv::AABB& aabb, const glm::mat4& matrix) {
+    rv::AABB result{};
+    result.center = glm::vec3{matrix * glm::vec4{aabb.center, 1.0f}};
+    for (int i = 0; i < 3; i++) {
+        result.extents[i] = std::abs(matrix[0][i]) * aabb.extents.x +
+                            std::abs(matrix[1][i]) * aabb.extents.y +
+                            std::abs(matrix[2][i]) * aabb.extents.z;
+    }
+    return result;
+}
+
+rv::AABB Mesh::getWorldAABB(const glm::mat4& worldMatrix) const {
+    return transformAABB(aabb, worldMatrix);
 }
 
 void Mesh::showAttributes(Scene& scene) {
     ImGui::SetNextItemOpen(true, ImGuiCond_Once);
     if (ImGui::TreeNode("Mesh")) {
-        ImGui::Text(("Mesh data: " + meshData->name).c_str());
-        if (material) {
-            ImGui::Text(("Material: " + material->name).c_str());
-            changed |= ImGui::ColorEdit4("Base color", &material->baseColor[0]);
-            changed |= ImGui::ColorEdit3("Emissive", &material->emissive[0]);
-            changed |= ImGui::SliderFloat("Metallic", &material->metallic, 0.0f, 1.0f);
-            changed |= ImGui::SliderFloat("Roughness", &material->roughness, 0.0f, 1.0f);
-            changed |= ImGui::SliderFloat("IOR", &material->ior, 0.01f, 5.0f);
-            changed |= ImGui::Checkbox("Normal mapping", &material->enableNormalMapping);
+        if (const MeshData* data = scene.getMeshData(meshData)) {
+            ImGui::Text(("Mesh data: " + data->name).c_str());
+        }
+        ImGui::Text("Indices: %u (%s)", indexCount,
+                    indexType == vk::IndexType::eUint16 ? "16-bit" : "32-bit");
+        for (uint32_t level = 0; level < lodCount; level++) {
+            ImGui::Text("LOD %u: %u indices (error %.4f)", level + 1, lods[level].indexCount,
+                        lods[level].error);
+        }
+        if (clusterCount > 0) {
+            ImGui::Text("Clusters: %u", clusterCount);
+        }
+        if (Material* _material = scene.getMaterial(material)) {
+            ImGui::Text(("Material: " + _material->name).c_str());
+            bool changed = false;
+            changed |= ImGui::ColorEdit4("Base color", &_material->baseColor[0]);
+            changed |= ImGui::ColorEdit3("Emissive", &_material->emissive[0]);
+            changed |= ImGui::SliderFloat("Metallic", &_material->metallic, 0.0f, 1.0f);
+            changed |= ImGui::SliderFloat("Roughness", &_material->roughness, 0.0f, 1.0f);
+            changed |= ImGui::SliderFloat("IOR", &_material->ior, 0.01f, 5.0f);
+            changed |= ImGui::Checkbox("Normal mapping", &_material->enableNormalMapping);
+            changed |= ImGui::Checkbox("Double sided", &_material->doubleSided);
+            if (changed) {
+                scene.markChanged(*this, ChangeField::Material);
+            }
+        }
+        if (firstMorphWeight >= 0) {
+            // NOTE: ウェイトは同じノードのプリミティブ間で共有される
+            std::span<float> weights = scene.getMorphWeights().getWeights().subspan(
+                static_cast<uint32_t>(firstMorphWeight), morphTargetCount);
+            bool changed = false;
+            for (uint32_t i = 0; i < weights.size(); i++) {
+                std::string label = std::format("Morph target {}", i);
+                changed |= ImGui::SliderFloat(label.c_str(), &weights[i], 0.0f, 1.0f);
+            }
+            if (changed) {
+                scene.getMorphWeights().markDirty();
+                scene.markChanged(*this, ChangeField::Geometry);
+            }
         }
         ImGui::TreePop();
     }
 }
 
 void Camera::showAttributes(Scene& scene) {
+    bool changed = false;
     int typeIndex = static_cast<int>(type);
     if (ImGui::Combo("Type", &typeIndex, "Orbital\0FirstPerson\0", 2)) {
         // TODO: なるべく保存できる値は引き継ぐ
@@ -313,6 +708,10 @@ void Camera::showAttributes(Scene& scene) {
     } else {
         // auto& _params = std::get<FirstPersonParams>(params);
     }
+
+    if (changed) {
+        scene.markChanged(*this, ChangeField::Camera);
+    }
 }
 
 void Camera::update(Scene& scene, float dt) {
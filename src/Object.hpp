@@ -1,16 +1,45 @@
 #pragma once
-#include <map>
+#include <array>
 #include <memory>
 #include <ranges>
-#include <typeindex>
+#include <span>
 
 #include <reactive/reactive.hpp>
 
+#include "Animation.hpp"
+#include "ComponentID.hpp"
+#include "MeshCluster.hpp"
+#include "MeshLod.hpp"
+#include "MeshOptimizer.hpp"
+#include "Morph.hpp"
+#include "Skinning.hpp"
+#include "SlotMap.hpp"
 #include "editor/Enums.hpp"
 #include "editor/IconManager.hpp"
 
 class Object;
 class Scene;
+struct Material;
+struct MeshData;
+
+using ObjectHandle = Handle<Object>;
+using MaterialHandle = Handle<Material>;
+using MeshDataHandle = Handle<MeshData>;
+
+struct Transform;
+struct Mesh;
+struct Camera;
+struct DirectionalLight;
+struct PointLight;
+struct AmbientLight;
+
+// NOTE: 新しいコンポーネントの型を追加したらここにも登録する
+using Components = ComponentRegistry<
+    TypeList<Transform, Mesh, Camera, DirectionalLight, PointLight, AmbientLight>>;
+using ComponentMask = Components::Mask;
+
+template <typename T>
+constexpr uint32_t componentID = Components::id<T>;
 
 struct VertexP {
     glm::vec3 position;
@@ -63,17 +92,18 @@ struct Component {
     virtual void update(Scene& scene, float dt) {}
     virtual void showAttributes(Scene& scene) = 0;
 
-    Object* object = nullptr;
+    // true の場合、update() はメインスレッドで順に呼ばれる
+    // false の場合はワーカースレッドから並列に呼ばれるため、自身以外の状態を書き換えないこと
+    static constexpr bool updateOnMainThread = false;
 
-    // 変更を検知するためのフラグ
-    // バッファ更新を高速化するため
-    // 初回はバッファに情報を入れるために true としておく
-    bool changed = true;
+    ObjectHandle object{};
 };
 
 class Object final {
+    friend class Scene;
+
 public:
-    Object(std::string _name) : name{std::move(_name)} {}
+    explicit Object(Scene& _scene) : scene{&_scene} {}
     ~Object() = default;
 
     Object(const Object& other) = delete;
@@ -82,50 +112,50 @@ public:
     Object& operator=(const Object& other) = delete;
     Object& operator=(Object&& other) = default;
 
+    // NOTE: コンポーネント本体は Scene が型ごとに密に保持している
+    //       定義は Scene.hpp を参照
     template <typename T, typename... Args>
-    T& add(Args&&... args) {
-        const std::type_info& info = typeid(T);
-        const std::type_index& index = {info};
-        if (components.contains(index)) {
-            spdlog::warn("{} is already added.", info.name());
-            return *static_cast<T*>(components.at(index).get());
-        }
-        components[index] = std::make_unique<T>(std::forward<Args>(args)...);
-        components[index]->object = this;
-        return *static_cast<T*>(components.at(index).get());
-    }
+    T& add(Args&&... args);
 
     template <typename T>
-    T* get() {
-        const std::type_info& info = typeid(T);
-        const std::type_index& index = {info};
-        if (components.contains(index)) {
-            return static_cast<T*>(components.at(index).get());
-        }
-        return nullptr;
-    }
+    void remove();
+
+    template <typename T>
+    T* get();
+
+    template <typename T>
+    const T* get() const;
 
     template <typename T>
-    const T* get() const {
-        const std::type_info& info = typeid(T);
-        const std::type_index& index = {info};
-        if (components.contains(index)) {
-            return static_cast<T*>(components.at(index).get());
-        }
-        return nullptr;
+    bool has() const {
+        return (componentMask & Components::bit<T>) != 0;
     }
 
-    std::string getName() const {
-        return name;
+    ComponentMask getComponentMask() const {
+        return componentMask;
+    }
+
+    std::vector<Component*> getComponents() const;
+
+    // NOTE: スロットのインデックスは生存中は変わらないため、GPUバッファのインデックスとしても使う
+    uint32_t getIndex() const {
+        return handle.index;
     }
 
-    const auto& getComponents() const {
-        return components;
+    ObjectHandle getHandle() const {
+        return handle;
+    }
+
+    // NOTE: 名前の文字列は Scene の名前索引が保持している
+    std::string_view getName() const {
+        return name;
     }
 
 private:
-    std::string name;
-    std::map<std::type_index, std::unique_ptr<Component>> components;
+    Scene* scene = nullptr;
+    ObjectHandle handle{};
+    std::string_view name;
+    ComponentMask componentMask = 0;
 };
 
 struct Material {
@@ -141,76 +171,24 @@ struct Material {
     int occlusionTextureIndex{-1};
     int emissiveTextureIndex{-1};
     bool enableNormalMapping{false};
+    bool doubleSided{false};  // false なら裏面を描かない
     std::string name;
 };
 
-struct KeyFrame {
-    float time = 0.0f;  // 秒単位
-    glm::vec3 translation = {0.0f, 0.0f, 0.0f};
-    glm::quat rotation = {1.0f, 0.0f, 0.0f, 0.0f};
-    glm::vec3 scale = {1.0f, 1.0f, 1.0f};
-};
-
 struct Transform final : Component {
+    // NOTE: アニメーションの値は Scene の AnimationPlayer がまとめて書き込む
     glm::vec3 translation = {0.0f, 0.0f, 0.0f};
     glm::quat rotation = {1.0f, 0.0f, 0.0f, 0.0f};
     glm::vec3 scale = {1.0f, 1.0f, 1.0f};
 
-    // For animation
-    float currentTime = 0.0f;
-    uint32_t prevFrame = 0;
-    std::vector<KeyFrame> keyFrames;
+    // アニメーションの更新頻度 (Auto 以外なら LOD より優先する)
+    // NOTE: スキンメッシュに設定すると、それを動かす関節にも適用される
+    AnimationRate animationRate = AnimationRate::Auto;
 
+    // 親を含まないローカルの行列
     glm::mat4 computeTransformMatrix() const;
 
-    glm::mat4 computeNormalMatrix() const;
-
     void showAttributes(Scene& scene) override;
-
-    void update(Scene& scene, float dt) override {
-        if (keyFrames.empty()) {
-            return;
-        }
-
-        // WARN: floatを蓄積すると誤差も増えるので注意
-        currentTime += dt * 0.001f;
-        float offsetTime = currentTime - keyFrames[prevFrame].time;
-
-        // prevFrameを更新する必要があれば更新
-        if (prevFrame + 1 == keyFrames.size()) {
-            float interval = 0.016f;  // 30 fps
-            if (offsetTime >= interval) {
-                // reset
-                currentTime = offsetTime - interval;
-                prevFrame = 0;
-            }
-        }
-        if (prevFrame + 1 < keyFrames.size()) {
-            float interval = keyFrames[prevFrame + 1].time - keyFrames[prevFrame].time;
-            if (offsetTime >= interval) {
-                prevFrame++;  // next
-            }
-        }
-
-        // 線形補間
-        if (prevFrame + 1 < keyFrames.size()) {
-            offsetTime = currentTime - keyFrames[prevFrame].time;
-            float interval = keyFrames[prevFrame + 1].time - keyFrames[prevFrame].time;
-            float t = offsetTime / interval;
-
-            const KeyFrame& prev = keyFrames[prevFrame];
-            const KeyFrame& next = keyFrames[prevFrame + 1];
-            translation = glm::mix(prev.translation, next.translation, t);
-            rotation = glm::slerp(prev.rotation, next.rotation, t);
-            scale = glm::mix(prev.scale, next.scale, t);
-            changed = true;
-        } else {
-            translation = keyFrames[prevFrame].translation;
-            rotation = keyFrames[prevFrame].rotation;
-            scale = keyFrames[prevFrame].scale;
-            changed = true;
-        }
-    }
 };
 
 struct DirectionalLight : Component {
@@ -257,6 +235,9 @@ enum class MeshType {
     COUNT,
 };
 
+class JobSystem;
+struct Mesh;
+
 struct MeshData {
     rv::BufferHandle vertexBuffer;
     rv::BufferHandle indexBuffer;
@@ -264,31 +245,122 @@ struct MeshData {
     std::vector<uint32_t> indices;
     std::string name;
 
+    // 16ビットに収まるメッシュのインデックス
+    // NOTE: indexBuffer 上では indices の後ろ (getIndices16Offset() バイト目から) に置く
+    std::vector<uint16_t> indices16;
+
+    // メッシュの三角形の塊 (Mesh::firstCluster から clusterCount 個)
+    // NOTE: 読み込んだ後は変わらないので、描画側には複製せずに共有する
+    std::shared_ptr<const std::vector<MeshCluster>> clusters;
+
+    // スキンメッシュやモーフターゲットを含む場合のみ、vertices と同じ数だけ持つ
+    // NOTE: 変形後の頂点は deformedVertexBuffer に書き出され、描画はそちらを使う
+    std::vector<SkinVertex> skinVertices;
+    MorphTargets morphTargets;
+    rv::BufferHandle skinVertexBuffer;
+    rv::BufferHandle morphRangeBuffer;
+    rv::BufferHandle morphDeltaBuffer;
+    rv::BufferHandle deformedVertexBuffer;
+
+    bool isDeformable() const {
+        return !skinVertices.empty() || !morphTargets.empty();
+    }
+
     MeshData() = default;
 
     MeshData(const rv::Context& context, MeshType type);
 
     void createBuffers(const rv::Context& context);
+
+    // 頂点をまとめ、三角形と頂点を GPU で処理しやすい順に並べ替える (MeshOptimizer.hpp)
+    // 頂点の配列はメッシュの順に詰め直し、メッシュの vertexOffset と vertexCount も書き換える
+    // 最適化前後の頂点キャッシュの効率を返す
+    // NOTE: meshes はこのメッシュデータを使う全てのメッシュ (範囲は重ならないこと)
+    //       スキンの頂点とモーフターゲットの範囲も同じ順に並べ替える
+    //       jobSystem があればメッシュごとに並列に処理する (結果は同じ)
+    std::pair<VertexCacheStats, VertexCacheStats> optimize(std::span<Mesh* const> meshes,
+                                                           JobSystem* jobSystem = nullptr);
+
+    // メッシュの三角形を塊に分け、塊ごとに連続するようにインデックスを並べ替える (MeshCluster.hpp)
+    // NOTE: optimize() の後、generateLods() の前に呼ぶ (塊は元のメッシュの範囲だけを分ける)
+    void buildClusters(std::span<Mesh* const> meshes, JobSystem* jobSystem = nullptr);
+
+    // メッシュを段階的に簡略化した LOD を作り、そのインデックスを indices の末尾に追加する
+    // NOTE: 各段階は一つ前の段階を半分ほどに簡略化したもので、形状の誤差が大きくなるか、
+    //       ほとんど減らなくなったところで打ち切る
+    //       optimize() で頂点を並べ替えた後に呼ぶ (LOD は並べ替え後の頂点を指す)
+    void generateLods(std::span<Mesh* const> meshes, JobSystem* jobSystem = nullptr);
+
+    // 最大のインデックスが 16ビットに収まるメッシュのインデックスを indices16 に移し、
+    // 残りを indices に詰め直す。メッシュの firstIndex と indexType も書き換える
+    // NOTE: LOD のインデックスも元のメッシュと同じ配列に移す
+    // NOTE: meshes はこのメッシュデータを使う全てのメッシュ (範囲は重ならないこと)
+    //       インデックスは vertexOffset からの相対値なので、メッシュ単位の頂点数で判定できる
+    void compactIndices(std::span<Mesh* const> meshes);
+
+    vk::DeviceSize getIndices16Offset() const {
+        return sizeof(uint32_t) * indices.size();
+    }
 };
 
+// AABBを行列で変換し、それを包むAABBを返す
+// NOTE: 8頂点を変換する代わりに、中心を変換し、範囲は行列の絶対値で変換する (Arvo の方法)
+rv::AABB transformAABB(const rv::AABB& aabb, const glm::mat4& matrix);
+
 struct Mesh final : Component {
-    void computeLocalAABB();
+    void computeLocalAABB(const MeshData& meshData);
+
+    // スキンメッシュの関節ごとに、その関節がウェイトを持つ頂点のバインド姿勢でのAABBを求め、
+    // どの関節のウェイトも持たない (動かない) 頂点のAABBを返す
+    // NOTE: 該当する頂点が無ければ extents が負になる
+    rv::AABB computeJointAABBs(const MeshData& meshData, std::span<rv::AABB> jointAABBs) const;
 
     rv::AABB getLocalAABB() const {
         return aabb;
     }
 
-    rv::AABB getWorldAABB() const;
+    // NOTE: 親子関係を反映したワールド行列は Scene::getWorldMatrix() から取得する
+    rv::AABB getWorldAABB(const glm::mat4& worldMatrix) const;
 
     void showAttributes(Scene& scene) override;
 
+    // NOTE: firstIndex は indexType が eUint16 なら MeshData::indices16、
+    //       eUint32 なら MeshData::indices 上の位置
     uint32_t firstIndex{};
     uint32_t indexCount{};
+    vk::IndexType indexType = vk::IndexType::eUint32;
     uint32_t vertexOffset{};
     uint32_t vertexCount{};
-    MeshData* meshData = nullptr;
-    Material* material = nullptr;
+    MeshDataHandle meshData{};
+
+    // 簡略化したメッシュ (細かい順)。インデックスは firstIndex と同じ配列にある
+    std::array<MeshLod, maxMeshLodCount> lods{};
+    uint32_t lodCount = 0;
+
+    std::span<const MeshLod> getLods() const {
+        return {lods.data(), lodCount};
+    }
+
+    // MeshData::clusters 上の三角形の塊 (範囲は firstIndex からの相対位置)
+    uint32_t firstCluster = 0;
+    uint32_t clusterCount = 0;
+
+    MaterialHandle material{};
     rv::AABB aabb{};
+
+    // スキンメッシュの場合、Scene の JointPalette 上の先頭位置 (-1 ならスキンを持たない)
+    // NOTE: AABB は関節が動くたびに Scene が関節ごとのAABBから求め直す
+    int firstJoint = -1;
+    uint32_t jointCount = 0;
+    rv::AABB unskinnedAABB{};  // どの関節のウェイトも持たない頂点のAABB
+
+    // モーフターゲットを持つ場合、Scene の MorphWeights 上の先頭位置 (-1 なら持たない)
+    int firstMorphWeight = -1;
+    uint32_t morphTargetCount = 0;
+
+    bool isDeformed() const {
+        return firstJoint >= 0 || firstMorphWeight >= 0;
+    }
 };
 
 class Texture {
@@ -310,6 +382,9 @@ struct Camera final : rv::Camera, Component {
 
     void showAttributes(Scene& scene) override;
 
+    // NOTE: ウィンドウの入力を読むためメインスレッドで更新する
+    static constexpr bool updateOnMainThread = true;
+
     void update(Scene& scene, float dt) override;
 
     rv::Frustum getFrustum() const {
@@ -1,5 +1,247 @@
 #include "Pass.hpp"
 
+void DeformPass::init(const rv::Context& _context) {
+    Pass::init(_context);
+    context = &_context;
+
+    shader = context->createShader({
+        .code = rv::Compiler::compileOrReadShader(DEV_SHADER_DIR / "deform.comp",
+                                                  DEV_SHADER_DIR / "spv/deform.comp.spv"),
+        .stage = vk::ShaderStageFlagBits::eCompute,
+    });
+
+    descSet = {};
+    pipeline = {};
+    paletteBuffer = {};
+    morphWeightBuffer = {};
+    paletteSize = 0;
+    morphWeightCount = 0;
+    boundVertexBuffer = {};
+}
+
+void DeformPass::updateDescriptorSet(const DeformSnapshot& deform) {
+    if (pipeline && deform.vertexBuffer == boundVertexBuffer &&
+        deform.jointPalette.size() == paletteSize &&
+        deform.morphWeights.size() == morphWeightCount) {
+        return;
+    }
+
+    // NOTE: 読み込み時やスキンの追加時にしか起きないため、GPUの完了を待ってから作り直す
+    //       スキンやモーフターゲットの片方しか無い場合も、空のバッファは作れないので1要素分確保する
+    context->getDevice().waitIdle();
+    paletteSize = deform.jointPalette.size();
+    paletteBuffer = context->createBuffer({
+        .usage = rv::BufferUsage::Storage,
+        .memory = rv::MemoryUsage::Device,
+        .size = sizeof(glm::mat4) * std::max(paletteSize, size_t{1}),
+        .debugName = "DeformPass::paletteBuffer",
+    });
+    morphWeightCount = deform.morphWeights.size();
+    morphWeightBuffer = context->createBuffer({
+        .usage = rv::BufferUsage::Storage,
+        .memory = rv::MemoryUsage::Device,
+        .size = sizeof(float) * std::max(morphWeightCount, size_t{1}),
+        .debugName = "DeformPass::morphWeightBuffer",
+    });
+    boundVertexBuffer = deform.vertexBuffer;
+
+    descSet = context->createDescriptorSet({
+        .shaders = {shader},
+        .buffers =
+            {
+                {"SourceVertexBuffer", deform.vertexBuffer},
+                {"SkinVertexBuffer", deform.skinVertexBuffer},
+                {"JointPaletteBuffer", paletteBuffer},
+                {"MorphRangeBuffer", deform.morphRangeBuffer},
+                {"MorphDeltaBuffer", deform.morphDeltaBuffer},
+                {"MorphWeightBuffer", morphWeightBuffer},
+                {"DeformedVertexBuffer", deform.deformedVertexBuffer},
+            },
+    });
+    descSet->update();
+
+    pipeline = context->createComputePipeline({
+        .descSetLayout = descSet->getLayout(),
+        .pushSize = sizeof(Constants),
+        .computeShader = shader,
+    });
+}
+
+void DeformPass::render(const rv::CommandBuffer& commandBuffer, const DeformSnapshot& deform) {
+    assert(initialized);
+    if (deform.dispatches.empty()) {
+        return;
+    }
+    updateDescriptorSet(deform);
+
+    commandBuffer.beginDebugLabel("DeformPass::render()");
+    if (!deform.jointPalette.empty()) {
+        commandBuffer.copyBuffer(paletteBuffer, deform.jointPalette.data());
+        commandBuffer.bufferBarrier(
+            paletteBuffer,  //
+            vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader,
+            vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead);
+    }
+    if (!deform.morphWeights.empty()) {
+        commandBuffer.copyBuffer(morphWeightBuffer, deform.morphWeights.data());
+        commandBuffer.bufferBarrier(
+            morphWeightBuffer,  //
+            vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader,
+            vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead);
+    }
+
+    commandBuffer.bindDescriptorSet(pipeline, descSet);
+    commandBuffer.bindPipeline(pipeline);
+    commandBuffer.beginTimestamp(timer);
+    for (const DeformDispatch& dispatch : deform.dispatches) {
+        Constants constants{dispatch.vertexOffset, dispatch.vertexCount, dispatch.firstJoint,
+                            dispatch.firstMorphWeight};
+        commandBuffer.pushConstants(pipeline, &constants);
+        commandBuffer.dispatch((dispatch.vertexCount + workGroupSize - 1) / workGroupSize, 1, 1);
+    }
+    commandBuffer.endTimestamp(timer);
+
+    // シャドウマップとフォワードの頂点入力で読む
+    commandBuffer.bufferBarrier(
+        deform.deformedVertexBuffer,  //
+        vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eVertexInput,
+        vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eVertexAttributeRead);
+    commandBuffer.endDebugLabel();
+}
+
+// NOTE: baked_animation.comp は ObjectData の先頭の行列だけを書き換え、要素の大きさで歩く
+static_assert(sizeof(ObjectData) == sizeof(glm::mat4) * 2 + sizeof(glm::vec4) * 5);
+
+void BakedAnimationPass::init(const rv::Context& _context) {
+    Pass::init(_context);
+    context = &_context;
+
+    shader = context->createShader({
+        .code = rv::Compiler::compileOrReadShader(DEV_SHADER_DIR / "baked_animation.comp",
+                                                  DEV_SHADER_DIR / "spv/baked_animation.comp.spv"),
+        .stage = vk::ShaderStageFlagBits::eCompute,
+    });
+
+    descSet = {};
+    pipeline = {};
+    frameBuffer = {};
+    trackBuffer = {};
+    instanceBuffer = {};
+    frameCount = 0;
+    trackCount = 0;
+    instanceCount = 0;
+    boundObjectBuffer = {};
+}
+
+void BakedAnimationPass::updateBuffers(const rv::CommandBuffer& commandBuffer,
+                                       const BakedAnimationSnapshot& baked,
+                                       const rv::BufferHandle& objectBuffer) {
+    // NOTE: 焼き込みやインスタンスの追加時にしか起きないため、GPUの完了を待ってから作り直す
+    //       空のバッファは作れないので1要素分確保する
+    bool recreated = false;
+    auto recreate = [&](rv::BufferHandle& buffer, size_t& count, size_t newCount,
+                        size_t stride, const char* debugName) {
+        if (buffer && count == newCount) {
+            return;
+        }
+        if (!recreated) {
+            context->getDevice().waitIdle();
+            recreated = true;
+        }
+        count = newCount;
+        buffer = context->createBuffer({
+            .usage = rv::BufferUsage::Storage,
+            .memory = rv::MemoryUsage::Device,
+            .size = stride * std::max(count, size_t{1}),
+            .debugName = debugName,
+        });
+    };
+    if (baked.tracksChanged) {
+        recreate(frameBuffer, frameCount, baked.frames.size(), sizeof(glm::mat4),
+                 "BakedAnimationPass::frameBuffer");
+        recreate(trackBuffer, trackCount, baked.tracks.size(), sizeof(BakedTrack),
+                 "BakedAnimationPass::trackBuffer");
+    }
+    if (baked.instancesChanged) {
+        recreate(instanceBuffer, instanceCount, baked.instances.size(),
+                 sizeof(BakedAnimationInstance), "BakedAnimationPass::instanceBuffer");
+    }
+
+    if (frameBuffer && trackBuffer && instanceBuffer &&
+        (recreated || !pipeline || objectBuffer != boundObjectBuffer)) {
+        boundObjectBuffer = objectBuffer;
+        descSet = context->createDescriptorSet({
+            .shaders = {shader},
+            .buffers =
+                {
+                    {"BakedFrameBuffer", frameBuffer},
+                    {"BakedTrackBuffer", trackBuffer},
+                    {"BakedInstanceBuffer", instanceBuffer},
+                    {"ObjectBuffer", objectBuffer},
+                },
+        });
+        descSet->update();
+
+        pipeline = context->createComputePipeline({
+            .descSetLayout = descSet->getLayout(),
+            .pushSize = sizeof(Constants),
+            .computeShader = shader,
+        });
+    }
+
+    auto upload = [&](const rv::BufferHandle& buffer, const void* data, size_t count) {
+        if (count == 0) {
+            return;
+        }
+        commandBuffer.copyBuffer(buffer, data);
+        commandBuffer.bufferBarrier(
+            buffer,  //
+            vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader,
+            vk::AccessFlagBits::eTransferWrite, vk::AccessFlagBits::eShaderRead);
+    };
+    if (baked.tracksChanged) {
+        upload(frameBuffer, baked.frames.data(), baked.frames.size());
+        upload(trackBuffer, baked.tracks.data(), baked.tracks.size());
+    }
+    if (baked.instancesChanged) {
+        upload(instanceBuffer, baked.instances.data(), baked.instances.size());
+    }
+}
+
+void BakedAnimationPass::render(const rv::CommandBuffer& commandBuffer,
+                                const BakedAnimationSnapshot& baked,
+                                const rv::BufferHandle& objectBuffer) {
+    assert(initialized);
+    // NOTE: インスタンスが無いフレームでも、焼き込んだトラックの変更は転送しておく
+    updateBuffers(commandBuffer, baked, objectBuffer);
+    if (baked.instanceCount == 0 || !pipeline) {
+        return;
+    }
+
+    commandBuffer.beginDebugLabel("BakedAnimationPass::render()");
+    // ObjectDataBuffer の転送の後に書き込む
+    commandBuffer.bufferBarrier(
+        objectBuffer,  //
+        vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader,
+        vk::AccessFlagBits::eTransferWrite,
+        vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite);
+
+    commandBuffer.bindDescriptorSet(pipeline, descSet);
+    commandBuffer.bindPipeline(pipeline);
+    commandBuffer.beginTimestamp(timer);
+    Constants constants{baked.time, baked.instanceCount};
+    commandBuffer.pushConstants(pipeline, &constants);
+    commandBuffer.dispatch((baked.instanceCount + workGroupSize - 1) / workGroupSize, 1, 1);
+    commandBuffer.endTimestamp(timer);
+
+    // シャドウマップとフォワードで読む
+    commandBuffer.bufferBarrier(
+        objectBuffer,  //
+        vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eAllGraphics,
+        vk::AccessFlagBits::eShaderWrite, vk::AccessFlagBits::eShaderRead);
+    commandBuffer.endDebugLabel();
+}
+
 void ShadowMapPass::init(const rv::Context& context,
                          const rv::DescriptorSetHandle& _descSet,
                          vk::Format shadowMapFormat) {
@@ -35,9 +277,11 @@ void ShadowMapPass::init(const rv::Context& context,
 
 void ShadowMapPass::render(const rv::CommandBuffer& commandBuffer,
                            const rv::ImageHandle& shadowMapImage,
-                           Scene& scene,
-                           const DirectionalLight& light) const {
+                           const RenderSnapshot& snapshot,
+                           const MeshLodSettings& lodSettings) {
     assert(initialized);
+    assert(snapshot.directionalLight);
+    const DirectionalLightSnapshot& light = *snapshot.directionalLight;
     vk::Extent3D extent = shadowMapImage->getExtent();
     commandBuffer.clearDepthStencilImage(shadowMapImage, 1.0f, 0);
     commandBuffer.transitionLayout(shadowMapImage, vk::ImageLayout::eDepthAttachmentOptimal);
@@ -54,17 +298,31 @@ void ShadowMapPass::render(const rv::CommandBuffer& commandBuffer,
     commandBuffer.beginRendering(rv::ImageHandle{}, shadowMapImage, {0, 0},
                                  {extent.width, extent.height});
 
+    // 平行投影なので、ワールドでの長さとシャドウマップ上のテクセル数の比はどこでも同じ
+    const glm::mat4& viewProj = light.viewProj;
+    float texelsPerUnit = glm::length(glm::vec3{viewProj[0][1], viewProj[1][1], viewProj[2][1]}) *
+                          static_cast<float>(extent.height) * 0.5f;
+    lodLevels.resize(snapshot.objectSlotCount, 0);
+
     StandardConstants constants;
-    auto& objects = scene.getObjects();
-    for (size_t i = 0; i < objects.size(); i++) {
-        if (Mesh* mesh = objects[i].get<Mesh>()) {
-            constants.objectIndex = static_cast<int>(i);
-            commandBuffer.pushConstants(pipeline, &constants);
-
-            commandBuffer.bindVertexBuffer(mesh->meshData->vertexBuffer);
-            commandBuffer.bindIndexBuffer(mesh->meshData->indexBuffer);
-            commandBuffer.drawIndexed(mesh->indexCount, 1, mesh->firstIndex, mesh->vertexOffset, 0);
+    for (const DrawPacket& packet : snapshot.drawPackets) {
+        uint8_t& lod = lodLevels[packet.objectIndex];
+        if (lodSettings.enabled) {
+            float errorScale = glm::length(packet.worldAABB.extents) * texelsPerUnit;
+            lod = static_cast<uint8_t>(selectMeshLod(packet.getLods(), errorScale,
+                                                     lodSettings.shadowErrorPixels,
+                                                     lodSettings.hysteresis, lod));
+        } else {
+            lod = 0;
         }
+
+        const MeshBuffers& buffers = snapshot.meshBuffers[packet.meshBuffers];
+        constants.objectIndex = static_cast<int>(packet.objectIndex);
+        commandBuffer.pushConstants(pipeline, &constants);
+
+        auto [firstIndex, indexCount] = packet.getIndexRange(lod);
+        buffers.bind(commandBuffer, packet.indexType);
+        commandBuffer.drawIndexed(indexCount, 1, firstIndex, packet.vertexOffset, 0);
     }
 
     commandBuffer.endRendering();
@@ -159,6 +417,7 @@ void ForwardPass::init(const rv::Context& context,
         .vertexAttributes = VertexPNUT::getAttributeDescriptions(),
         .colorFormats = {colorFormat, normalFormat, specularBrdfFormat},
         .depthFormat = depthFormat,
+        .cullMode = "dynamic",
     });
 }
 
@@ -167,10 +426,14 @@ void ForwardPass::render(const rv::CommandBuffer& commandBuffer,
                          const rv::ImageHandle& depthImage,
                          const rv::ImageHandle& specularBrdfImage,
                          const rv::ImageHandle& normalImage,
-                         Scene& scene,
+                         const RenderSnapshot& snapshot,
                          bool frustumCulling,
-                         bool enableSorting) {
+                         bool enableSorting,
+                         const MeshLodSettings& lodSettings,
+                         bool clusterCulling) {
     vk::Extent3D extent = baseColorImage->getExtent();
+    auto viewportHeight = static_cast<float>(extent.height);
+    lodLevels.resize(snapshot.objectSlotCount, 0);
     commandBuffer.beginDebugLabel("ForwardPass::render()");
     commandBuffer.bindDescriptorSet(pipeline, descSet);
     commandBuffer.bindPipeline(pipeline);
@@ -181,64 +444,40 @@ void ForwardPass::render(const rv::CommandBuffer& commandBuffer,
     commandBuffer.beginRendering({baseColorImage, normalImage, specularBrdfImage}, depthImage,
                                  {0, 0}, {extent.width, extent.height});
 
-    // TODO: デフォルトカメラに対応
-    auto& objects = scene.getObjects();
-    Camera* camera = scene.getMainCamera();
-    if (frustumCulling && camera) {
-        std::vector<int> visibleMeshIndices;
-        visibleMeshIndices.reserve(objects.size());
-
+    if (frustumCulling) {
         // フラスタムカリング
+        // NOTE: ワールドAABBは Scene が変更のあったオブジェクトだけ計算し直し、
+        //       スナップショットの描画命令に複製されている
         meshCount = 0;
         visibleCount = 0;
-        for (int index = 0; index < objects.size(); index++) {
-            auto& object = objects[index];
-            Mesh* mesh = object.get<Mesh>();
-            if (!mesh) {
-                continue;
-            }
+        visibleMeshes.clear();
+        const rv::Frustum& frustum = snapshot.camera.frustum;
+        glm::vec3 cameraPos = snapshot.camera.position;
+        for (const DrawPacket& packet : snapshot.drawPackets) {
             meshCount++;
 
-            const auto& aabb = mesh->getWorldAABB();
-            if (aabb.isOnFrustum(camera->getFrustum())) {
-                visibleMeshIndices.push_back(index);
+            if (packet.worldAABB.isOnFrustum(frustum)) {
+                float distance = glm::distance(packet.worldAABB.center, cameraPos);
+                visibleMeshes.push_back({&packet, distance});
                 visibleCount++;
             }
         }
 
         // 手前から描画するようにソート
         if (enableSorting) {
-            glm::vec3 cameraPos = camera->getPosition();
-            std::ranges::sort(visibleMeshIndices, [&objects, &cameraPos](int index0, int index1) {
-                glm::vec3 center0 = objects[index0].get<Mesh>()->getWorldAABB().center;
-                glm::vec3 center1 = objects[index1].get<Mesh>()->getWorldAABB().center;
-                return glm::distance(center0, cameraPos) < glm::distance(center1, cameraPos);
-            });
+            std::ranges::sort(visibleMeshes, {}, &VisibleMesh::distance);
         }
 
         // フラスタム内のオブジェクトだけ描画
-        for (int index : visibleMeshIndices) {
-            auto& object = scene.getObjects()[index];
-            Mesh* mesh = object.get<Mesh>();
-
-            constants.objectIndex = index;
-            commandBuffer.pushConstants(pipeline, &constants);
-            commandBuffer.bindVertexBuffer(mesh->meshData->vertexBuffer);
-            commandBuffer.bindIndexBuffer(mesh->meshData->indexBuffer);
-            commandBuffer.drawIndexed(mesh->indexCount, 1, mesh->firstIndex, mesh->vertexOffset, 0);
+        for (const VisibleMesh& visibleMesh : visibleMeshes) {
+            const DrawPacket& packet = *visibleMesh.packet;
+            uint32_t lod = selectLod(packet, snapshot.camera, viewportHeight, lodSettings);
+            draw(commandBuffer, snapshot, packet, lod, clusterCulling);
         }
     } else {
-        for (int index = 0; index < scene.getObjects().size(); index++) {
-            auto& object = scene.getObjects()[index];
-            Mesh* mesh = object.get<Mesh>();
-            if (!mesh) {
-                continue;
-            }
-            constants.objectIndex = index;
-            commandBuffer.pushConstants(pipeline, &constants);
-            commandBuffer.bindVertexBuffer(mesh->meshData->vertexBuffer);
-            commandBuffer.bindIndexBuffer(mesh->meshData->indexBuffer);
-            commandBuffer.drawIndexed(mesh->indexCount, 1, mesh->firstIndex, mesh->vertexOffset, 0);
+        for (const DrawPacket& packet : snapshot.drawPackets) {
+            uint32_t lod = selectLod(packet, snapshot.camera, viewportHeight, lodSettings);
+            draw(commandBuffer, snapshot, packet, lod, clusterCulling);
         }
     }
 
@@ -255,6 +494,93 @@ void ForwardPass::render(const rv::CommandBuffer& commandBuffer,
     commandBuffer.endDebugLabel();
 }
 
+uint32_t ForwardPass::selectLod(const DrawPacket& packet,
+                                const CameraSnapshot& camera,
+                                float viewportHeight,
+                                const MeshLodSettings& lodSettings) {
+    uint8_t& lod = lodLevels[packet.objectIndex];
+    if (!lodSettings.enabled) {
+        lod = 0;
+        return lod;
+    }
+    // NOTE: Vulkan の射影行列は y を反転していることがあるので絶対値を使う
+    float radius = glm::length(packet.worldAABB.extents);
+    float distance = glm::distance(packet.worldAABB.center, camera.position);
+    float errorScale =
+        computeLodErrorScale(radius, distance, std::abs(camera.proj[1][1]), viewportHeight);
+    lod = static_cast<uint8_t>(selectMeshLod(packet.getLods(), errorScale,
+                                             lodSettings.errorPixels, lodSettings.hysteresis, lod));
+    return lod;
+}
+
+void ForwardPass::draw(const rv::CommandBuffer& commandBuffer,
+                       const RenderSnapshot& snapshot,
+                       const DrawPacket& packet,
+                       uint32_t lod,
+                       bool clusterCulling) {
+    const MeshBuffers& buffers = snapshot.meshBuffers[packet.meshBuffers];
+    constants.objectIndex = static_cast<int>(packet.objectIndex);
+    commandBuffer.pushConstants(pipeline, &constants);
+    buffers.bind(commandBuffer, packet.indexType);
+
+    // 片面のマテリアルは裏面を描かない
+    // NOTE: 鏡像 (行列式が負) のメッシュは三角形の向きが反転するので、裏面カリングしない
+    const glm::mat4& world = packet.worldMatrix;
+    bool mirrored = glm::determinant(glm::mat3{world}) < 0.0f;
+    bool backfaceCulling = !packet.doubleSided && !mirrored;
+    commandBuffer.setCullMode(backfaceCulling ? vk::CullModeFlagBits::eBack
+                                              : vk::CullModeFlagBits::eNone);
+
+    // NOTE: 塊は元のメッシュだけを分けているので、LOD では塊ごとのカリングをしない
+    std::span<const MeshCluster> clusters = packet.getClusters(buffers);
+    if (!clusterCulling || lod != 0 || clusters.empty()) {
+        auto [firstIndex, indexCount] = packet.getIndexRange(lod);
+        commandBuffer.drawIndexed(indexCount, 1, firstIndex, packet.vertexOffset, 0);
+        return;
+    }
+
+    // 塊ごとのフラスタムカリングと裏向きのカリング
+    // NOTE: 拡大率が軸ごとに違うと法線の向きが変わるので、その場合は裏向きの判定をしない
+    glm::vec3 scales{glm::length(world[0]), glm::length(world[1]), glm::length(world[2])};
+    float maxScale = std::max({scales.x, scales.y, scales.z});
+    float minScale = std::min({scales.x, scales.y, scales.z});
+    bool coneCulling = backfaceCulling && minScale > maxScale * 0.99f;
+    const rv::Frustum& frustum = snapshot.camera.frustum;
+
+    // 残った塊のうち、インデックスが連続するものはまとめて一回で描画する
+    uint32_t rangeBegin = 0;
+    uint32_t rangeEnd = 0;
+    auto flush = [&]() {
+        if (rangeEnd > rangeBegin) {
+            commandBuffer.drawIndexed(rangeEnd - rangeBegin, 1, packet.firstIndex + rangeBegin,
+                                      packet.vertexOffset, 0);
+        }
+    };
+    for (const MeshCluster& cluster : clusters) {
+        glm::vec3 center{world * glm::vec4{cluster.center, 1.0f}};
+        float radius = cluster.radius * maxScale;
+        rv::AABB bounds{};
+        bounds.center = center;
+        bounds.extents = glm::vec3{radius};
+        if (!bounds.isOnFrustum(frustum)) {
+            continue;
+        }
+        if (coneCulling) {
+            glm::vec3 axis = glm::normalize(glm::mat3{world} * cluster.coneAxis);
+            if (isClusterBackfacing(center, radius, axis, cluster.coneCutoff,
+                                    snapshot.camera.position)) {
+                continue;
+            }
+        }
+        if (cluster.firstIndex != rangeEnd) {
+            flush();
+            rangeBegin = cluster.firstIndex;
+        }
+        rangeEnd = cluster.firstIndex + cluster.indexCount;
+    }
+    flush();
+}
+
 void SkyboxPass::init(const rv::Context& context,
                       const rv::DescriptorSetHandle& _descSet,
                       vk::Format colorFormat) {
@@ -287,7 +613,8 @@ void SkyboxPass::init(const rv::Context& context,
 
 void SkyboxPass::render(const rv::CommandBuffer& commandBuffer,
                         const rv::ImageHandle& baseColorImage,
-                        const MeshData& cubeMesh) {
+                        const MeshBuffers& cubeMesh,
+                        uint32_t cubeIndexCount) {
     vk::Extent3D extent = baseColorImage->getExtent();
     commandBuffer.beginDebugLabel("SkyboxPass::render()");
     commandBuffer.bindDescriptorSet(pipeline, descSet);
@@ -298,9 +625,8 @@ void SkyboxPass::render(const rv::CommandBuffer& commandBuffer,
     commandBuffer.beginTimestamp(timer);
     commandBuffer.beginRendering(baseColorImage, nullptr, {0, 0}, {extent.width, extent.height});
 
-    commandBuffer.bindVertexBuffer(cubeMesh.vertexBuffer);
-    commandBuffer.bindIndexBuffer(cubeMesh.indexBuffer);
-    commandBuffer.drawIndexed(static_cast<uint32_t>(cubeMesh.indices.size()));
+    cubeMesh.bind(commandBuffer, vk::IndexType::eUint32);
+    commandBuffer.drawIndexed(cubeIndexCount);
 
     commandBuffer.endRendering();
     commandBuffer.endTimestamp(timer);
@@ -1,7 +1,7 @@
 #pragma once
 #include <reactive/reactive.hpp>
 
-#include "Scene.hpp"
+#include "RenderSnapshot.hpp"
 
 #include "../shader/standard.glsl"
 
@@ -22,20 +22,93 @@ protected:
     rv::GPUTimerHandle timer;
 };
 
+// 変形するメッシュの頂点 (モーフターゲット、スキニング) をコンピュートシェーダで一度だけ変換する
+// 結果はメッシュデータの deformedVertexBuffer に書き出し、シャドウとフォワードの両方で使う
+class DeformPass final : public Pass {
+public:
+    void init(const rv::Context& _context);
+
+    void render(const rv::CommandBuffer& commandBuffer, const DeformSnapshot& deform);
+
+private:
+    struct Constants {
+        uint32_t vertexOffset;
+        uint32_t vertexCount;
+        uint32_t firstJoint;
+        uint32_t firstMorphWeight;
+    };
+
+    // NOTE: 頂点バッファやパレット、ウェイトの数が変わったときだけディスクリプタセットを作り直す
+    void updateDescriptorSet(const DeformSnapshot& deform);
+
+    const rv::Context* context = nullptr;
+    rv::ShaderHandle shader;
+    rv::DescriptorSetHandle descSet;
+    rv::ComputePipelineHandle pipeline;
+    rv::BufferHandle paletteBuffer;
+    rv::BufferHandle morphWeightBuffer;
+    size_t paletteSize = 0;
+    size_t morphWeightCount = 0;
+    rv::BufferHandle boundVertexBuffer;
+
+    static constexpr uint32_t workGroupSize = 64;
+};
+
+// 焼き込んだアニメーションを再生し、インスタンスのモデル行列を ObjectData に書き込む
+// NOTE: ObjectDataBuffer の更新の後、それを読む描画の前に実行する
+class BakedAnimationPass final : public Pass {
+public:
+    void init(const rv::Context& _context);
+
+    void render(const rv::CommandBuffer& commandBuffer,
+                const BakedAnimationSnapshot& baked,
+                const rv::BufferHandle& objectBuffer);
+
+private:
+    struct Constants {
+        float time;
+        uint32_t instanceCount;
+    };
+
+    // 変更のあったトラックとインスタンスを転送する
+    // NOTE: copyBuffer() はバッファ全体を書き込むので、要素数が変わったら作り直す
+    void updateBuffers(const rv::CommandBuffer& commandBuffer,
+                       const BakedAnimationSnapshot& baked,
+                       const rv::BufferHandle& objectBuffer);
+
+    const rv::Context* context = nullptr;
+    rv::ShaderHandle shader;
+    rv::DescriptorSetHandle descSet;
+    rv::ComputePipelineHandle pipeline;
+    rv::BufferHandle frameBuffer;
+    rv::BufferHandle trackBuffer;
+    rv::BufferHandle instanceBuffer;
+    size_t frameCount = 0;
+    size_t trackCount = 0;
+    size_t instanceCount = 0;
+    rv::BufferHandle boundObjectBuffer;
+
+    static constexpr uint32_t workGroupSize = 64;
+};
+
 class ShadowMapPass final : public Pass {
 public:
     void init(const rv::Context& context,
               const rv::DescriptorSetHandle& _descSet,
               vk::Format shadowMapFormat);
 
+    // NOTE: LOD はシャドウマップ上の大きさで選ぶので、カメラが動いても描き直す必要は無い
     void render(const rv::CommandBuffer& commandBuffer,
                 const rv::ImageHandle& shadowMapImage,
-                Scene& scene,
-                const DirectionalLight& light) const;
+                const RenderSnapshot& snapshot,
+                const MeshLodSettings& lodSettings);
 
 private:
     rv::DescriptorSetHandle descSet;
     rv::GraphicsPipelineHandle pipeline;
+
+    // オブジェクトごとの前回の LOD (ObjectDataBuffer と同じ番号)
+    std::vector<uint8_t> lodLevels;
 };
 
 class AntiAliasingPass final : public Pass {
@@ -67,16 +140,42 @@ public:
                 const rv::ImageHandle& depthImage,
                 const rv::ImageHandle& specularBrdfImage,
                 const rv::ImageHandle& normalImage,
-                Scene& scene,
+                const RenderSnapshot& snapshot,
                 bool frustumCulling,
-                bool enableSorting);
+                bool enableSorting,
+                const MeshLodSettings& lodSettings,
+                bool clusterCulling);
 
 private:
+    struct VisibleMesh {
+        const DrawPacket* packet;
+        float distance;
+    };
+
+    // 画面上の大きさから LOD を選び、オブジェクトごとに覚えておく
+    uint32_t selectLod(const DrawPacket& packet,
+                       const CameraSnapshot& camera,
+                       float viewportHeight,
+                       const MeshLodSettings& lodSettings);
+
+    // NOTE: 元のメッシュ (lod == 0) を描くときは、見えない塊を除いた範囲だけを描画する
+    void draw(const rv::CommandBuffer& commandBuffer,
+              const RenderSnapshot& snapshot,
+              const DrawPacket& packet,
+              uint32_t lod,
+              bool clusterCulling);
+
     StandardConstants constants;
     rv::DescriptorSetHandle descSet;
     rv::GraphicsPipelineHandle pipeline;
     int meshCount = 0;
     int visibleCount = 0;
+
+    // NOTE: 毎フレームのアロケーションを避けるため使い回す
+    std::vector<VisibleMesh> visibleMeshes;
+
+    // オブジェクトごとの前のフレームの LOD (ObjectDataBuffer と同じ番号)
+    std::vector<uint8_t> lodLevels;
 };
 
 class SkyboxPass final : public Pass {
@@ -87,7 +186,8 @@ public:
 
     void render(const rv::CommandBuffer& commandBuffer,
                 const rv::ImageHandle& baseColorImage,
-                const MeshData& cubeMesh);
+                const MeshBuffers& cubeMesh,
+                uint32_t cubeIndexCount);
 
 private:
     rv::DescriptorSetHandle descSet;
@@ -0,0 +1,223 @@
+#include "RenderSnapshot.hpp"
+
+#include "Scene.hpp"
+
+void RenderSnapshot::extract(Scene& scene) {
+    status = scene.getStatus();
+    scene.resetStatus();
+
+    // 削除されたスロット
+    std::vector<uint32_t>& removed = scene.getRemovedObjectIndices();
+    removedObjectIndices.assign(removed.begin(), removed.end());
+    removed.clear();
+    objectSlotCount = scene.getObjects().getSlotCount();
+
+    // 変更のあったオブジェクトのデータ
+    // NOTE: 変更の種類も渡し、ObjectDataBuffer は必要な部分だけを書き換える
+    objectDataUpdates.clear();
+    auto& objects = scene.getObjects();
+    for (const ChangeRecord& record : scene.getChangeJournal().getRecords()) {
+        uint32_t index = record.objectIndex;
+        const Mesh* mesh = objects[index].get<Mesh>();
+        // NOTE: 形状だけの変更は ObjectData に影響しない
+        ChangeFlags dataFields = ChangeFlags{ChangeField::Transform} | ChangeField::Material;
+        if (!mesh || !(record.fields & dataFields)) {
+            continue;
+        }
+
+        ObjectData data{};
+        if (const Material* material = scene.getMaterial(mesh->material)) {
+            data.baseColor = material->baseColor;
+            data.emissive.xyz = material->emissive;
+            data.metallic = material->metallic;
+            data.roughness = material->roughness;
+            data.ior = material->ior;
+            data.baseColorTextureIndex = material->baseColorTextureIndex;
+            data.metallicRoughnessTextureIndex = material->metallicRoughnessTextureIndex;
+            data.normalTextureIndex = material->normalTextureIndex;
+            data.occlusionTextureIndex = material->occlusionTextureIndex;
+            data.emissiveTextureIndex = material->emissiveTextureIndex;
+            data.enableNormalMapping = static_cast<int>(material->enableNormalMapping);
+        }
+        data.modelMatrix = scene.getWorldMatrix(index);
+        data.normalMatrix = scene.getNormalMatrix(index);
+        objectDataUpdates.push_back({index, record.fields, data});
+    }
+
+    // 描画するメッシュ
+    // NOTE: 変形するメッシュと焼き込んだアニメーションで動くメッシュは、塊の包む球や円錐が
+    //       実際の形や位置と合わないので、塊ごとのカリングをしない
+    bakedObjects.assign(objectSlotCount, 0);
+    for (const BakedAnimationInstance& instance : scene.getBakedAnimationInstances()) {
+        bakedObjects[instance.objectIndex] = 1;
+    }
+    drawPackets.clear();
+    meshBuffers.clear();
+    meshDataKeys.clear();
+    for (auto [object, mesh] : scene.view<Mesh>()) {
+        uint32_t index = object.getIndex();
+        const Material* material = scene.getMaterial(mesh.material);
+        bool clusterCulling = !mesh.isDeformed() && !bakedObjects[index];
+        drawPackets.push_back({
+            .objectIndex = index,
+            .meshBuffers = findMeshBuffers(scene, mesh.meshData, mesh.isDeformed()),
+            .firstIndex = mesh.firstIndex,
+            .indexCount = mesh.indexCount,
+            .vertexOffset = mesh.vertexOffset,
+            .indexType = mesh.indexType,
+            .worldAABB = scene.getWorldAABB(index),
+            .lods = mesh.lods,
+            .lodCount = mesh.lodCount,
+            .worldMatrix = scene.getWorldMatrix(index),
+            .firstCluster = mesh.firstCluster,
+            .clusterCount = clusterCulling ? mesh.clusterCount : 0,
+            .doubleSided = material && material->doubleSided,
+        });
+    }
+
+    // 変形 (モーフターゲット、スキニング)
+    // NOTE: 両方の変更を読み出してリセットするため、短絡評価しない
+    deform.dispatches.clear();
+    deform.jointPalette.clear();
+    deform.morphWeights.clear();
+    bool paletteDirty = scene.getJointPalette().consumeDirty();
+    bool weightsDirty = scene.getMorphWeights().consumeDirty();
+    if (paletteDirty || weightsDirty) {
+        std::span<const glm::mat4> palette = scene.getJointPalette().getMatrices();
+        deform.jointPalette.assign(palette.begin(), palette.end());
+        const MorphWeights& weights = scene.getMorphWeights();
+        deform.morphWeights.assign(weights.getWeights().begin(), weights.getWeights().end());
+        for (auto [object, mesh] : scene.view<Mesh>()) {
+            if (!mesh.isDeformed()) {
+                continue;
+            }
+            // NOTE: 変形するメッシュは読み込んだシーンのメッシュデータにだけ含まれる
+            const MeshData* meshData = scene.getMeshData(mesh.meshData);
+            deform.vertexBuffer = meshData->vertexBuffer;
+            deform.skinVertexBuffer = meshData->skinVertexBuffer;
+            deform.morphRangeBuffer = meshData->morphRangeBuffer;
+            deform.morphDeltaBuffer = meshData->morphDeltaBuffer;
+            deform.deformedVertexBuffer = meshData->deformedVertexBuffer;
+
+            // ウェイトが全て 0 ならモーフターゲットの計算を丸ごと省く
+            uint32_t firstMorphWeight = DeformDispatch::none;
+            if (mesh.firstMorphWeight >= 0) {
+                auto first = static_cast<uint32_t>(mesh.firstMorphWeight);
+                if (!weights.isZero(first, mesh.morphTargetCount)) {
+                    firstMorphWeight = first;
+                }
+            }
+            deform.dispatches.push_back({
+                .vertexOffset = mesh.vertexOffset,
+                .vertexCount = mesh.vertexCount,
+                .firstJoint = mesh.firstJoint >= 0 ? static_cast<uint32_t>(mesh.firstJoint)
+                                                   : DeformDispatch::none,
+                .firstMorphWeight = firstMorphWeight,
+            });
+        }
+    }
+
+    // 焼き込んだアニメーション
+    BakedAnimation& baked = scene.getBakedAnimation();
+    bakedAnimation.frames.clear();
+    bakedAnimation.tracks.clear();
+    bakedAnimation.tracksChanged = baked.consumeDirty();
+    if (bakedAnimation.tracksChanged) {
+        bakedAnimation.frames.assign(baked.getFrames().begin(), baked.getFrames().end());
+        bakedAnimation.tracks.assign(baked.getTracks().begin(), baked.getTracks().end());
+    }
+    std::span<const BakedAnimationInstance> instances = scene.getBakedAnimationInstances();
+    bakedAnimation.instances.clear();
+    bakedAnimation.instancesChanged = scene.consumeBakedAnimationInstancesDirty();
+    if (bakedAnimation.instancesChanged) {
+        bakedAnimation.instances.assign(instances.begin(), instances.end());
+    }
+    bakedAnimation.instanceCount = static_cast<uint32_t>(instances.size());
+    bakedAnimation.time = static_cast<float>(scene.getBakedAnimationTime());
+
+    const MeshData& cube = scene.getCubeMesh();
+    cubeMesh = {cube.vertexBuffer, cube.indexBuffer};
+    cubeIndexCount = static_cast<uint32_t>(cube.indices.size());
+
+    // カメラ
+    Camera* activeCamera = &scene.getDefaultCamera();
+    if (scene.isMainCameraAvailable()) {
+        activeCamera = scene.getMainCamera();
+    }
+    camera.view = activeCamera->getView();
+    camera.proj = activeCamera->getProj();
+    camera.position = activeCamera->getPosition();
+    camera.frustum = activeCamera->getFrustum();
+
+    cameraFrustums.clear();
+    for (auto [object, otherCamera] : scene.view<Camera>()) {
+        if (&otherCamera != activeCamera) {
+            cameraFrustums.push_back(otherCamera.getInvView() * otherCamera.getInvProj());
+        }
+    }
+
+    // ライト
+    aabb = scene.getAABB();
+    directionalLight.reset();
+    if (const DirectionalLight* light = scene.findComponent<DirectionalLight>()) {
+        directionalLight = DirectionalLightSnapshot{
+            .direction = light->getDirection(),
+            .color = light->color,
+            .intensity = light->intensity,
+            .viewProj = light->getViewProj(aabb),
+            .rotation = light->getRotationMatrix(),
+            .shadowBias = light->shadowBias,
+            .enableShadow = light->enableShadow,
+            .enableShadowCulling = light->enableShadowCulling,
+        };
+    }
+    directionalLightRotations.clear();
+    for (auto [object, light] : scene.view<DirectionalLight>()) {
+        directionalLightRotations.push_back(light.getRotationMatrix());
+    }
+
+    ambientLight.reset();
+    if (const AmbientLight* light = scene.findComponent<AmbientLight>()) {
+        ambientLight = AmbientLightSnapshot{
+            .color = light->color,
+            .intensity = light->intensity,
+            .irradianceTexture = light->irradianceTexture,
+            .radianceTexture = light->radianceTexture,
+        };
+    }
+
+    // メッシュの移動・形状の変更・削除、ライトの変更があればシャドウマップを描き直す
+    const ChangeJournal& journal = scene.getChangeJournal();
+    ChangeFlags casterFields = ChangeFlags{ChangeField::Transform} | ChangeField::Geometry;
+    shadowCastersChanged = status & SceneStatus::Cleared ||
+                           status & SceneStatus::ObjectRemoved ||
+                           journal.isDirty(componentID<Transform>, casterFields) ||
+                           journal.isDirty(componentID<Mesh>, casterFields) ||
+                           journal.isDirty(componentID<DirectionalLight>, ChangeField::Light);
+
+    // テクスチャ
+    textures2D.clear();
+    for (const Texture& texture : scene.getTextures2D()) {
+        textures2D.push_back(texture.image);
+    }
+    texturesCube.clear();
+    for (const Texture& texture : scene.getTexturesCube()) {
+        texturesCube.push_back(texture.image);
+    }
+}
+
+uint32_t RenderSnapshot::findMeshBuffers(const Scene& scene, MeshDataHandle handle, bool deformed) {
+    // NOTE: メッシュデータの種類は少ない (テンプレートと読み込んだシーン) ので線形に探す
+    std::pair<MeshDataHandle, bool> key{handle, deformed};
+    for (uint32_t i = 0; i < meshDataKeys.size(); i++) {
+        if (meshDataKeys[i] == key) {
+            return i;
+        }
+    }
+    const MeshData* meshData = scene.getMeshData(handle);
+    meshDataKeys.push_back(key);
+    meshBuffers.push_back({deformed ? meshData->deformedVertexBuffer : meshData->vertexBuffer,
+                           meshData->indexBuffer, meshData->getIndices16Offset(),
+                           meshData->clusters});
+    return static_cast<uint32_t>(meshBuffers.size() - 1);
+}
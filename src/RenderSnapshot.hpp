@@ -0,0 +1,190 @@
+#pragma once
+#include <array>
+#include <limits>
+#include <memory>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include <reactive/Scene/Frustum.hpp>
+
+#include "../shader/standard.glsl"
+#include "Animation.hpp"
+#include "ChangeJournal.hpp"
+#include "Object.hpp"
+#include "editor/Enums.hpp"
+
+class Scene;
+
+// 描画に使う頂点・インデックスバッファ
+// NOTE: ハンドルを複製して持つので、描画中にシーンがメッシュデータを破棄しても有効なまま残る
+struct MeshBuffers {
+    rv::BufferHandle vertexBuffer;
+    rv::BufferHandle indexBuffer;
+    vk::DeviceSize indices16Offset = 0;  // indexBuffer 上の 16ビットのインデックスの先頭 (バイト)
+    std::shared_ptr<const std::vector<MeshCluster>> clusters;  // 無ければ nullptr
+
+    // NOTE: 16ビットのインデックスは領域の先頭からバインドするので、firstIndex はそのまま使える
+    void bind(const rv::CommandBuffer& commandBuffer, vk::IndexType indexType) const {
+        commandBuffer.bindVertexBuffer(vertexBuffer);
+        if (indexType == vk::IndexType::eUint16) {
+            commandBuffer.bindIndexBuffer(indexBuffer, indices16Offset, vk::IndexType::eUint16);
+        } else {
+            commandBuffer.bindIndexBuffer(indexBuffer);
+        }
+    }
+};
+
+// メッシュ一つ分の描画命令
+struct DrawPacket {
+    uint32_t objectIndex;
+    uint32_t meshBuffers;  // RenderSnapshot::meshBuffers のインデックス
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    uint32_t vertexOffset;
+    vk::IndexType indexType;
+    rv::AABB worldAABB;
+    std::array<MeshLod, maxMeshLodCount> lods;  // 簡略化したメッシュ (細かい順)
+    uint32_t lodCount;
+    glm::mat4 worldMatrix;
+    uint32_t firstCluster;  // MeshBuffers::clusters 上の位置
+    uint32_t clusterCount;  // 0 なら塊ごとのカリングをしない
+    bool doubleSided;
+
+    std::span<const MeshCluster> getClusters(const MeshBuffers& buffers) const {
+        if (clusterCount == 0 || !buffers.clusters) {
+            return {};
+        }
+        return std::span<const MeshCluster>{*buffers.clusters}.subspan(firstCluster, clusterCount);
+    }
+
+    std::span<const MeshLod> getLods() const {
+        return {lods.data(), lodCount};
+    }
+
+    // LOD を選んだ描画範囲 (0 なら元のメッシュ)
+    std::pair<uint32_t, uint32_t> getIndexRange(uint32_t lod) const {
+        if (lod == 0 || lod > lodCount) {
+            return {firstIndex, indexCount};
+        }
+        return {lods[lod - 1].firstIndex, lods[lod - 1].indexCount};
+    }
+};
+
+// ObjectDataBuffer に書き込む変更
+struct ObjectDataUpdate {
+    uint32_t objectIndex;
+    ChangeFlags fields;
+    ObjectData data;
+};
+
+// 変形するメッシュ一つ分の変形 (モーフターゲット、スキニング)
+struct DeformDispatch {
+    static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+    uint32_t vertexOffset;
+    uint32_t vertexCount;
+    uint32_t firstJoint;        // none ならスキニングしない
+    uint32_t firstMorphWeight;  // none ならモーフターゲットを足さない (ウェイトが全て 0 の場合も)
+};
+
+// 関節かモーフターゲットのウェイトが変わったフレームだけ中身を持つ
+// NOTE: 変形後の頂点は GPU 上に残るため、動かないフレームは変形し直さない
+struct DeformSnapshot {
+    rv::BufferHandle vertexBuffer;
+    rv::BufferHandle skinVertexBuffer;
+    rv::BufferHandle morphRangeBuffer;
+    rv::BufferHandle morphDeltaBuffer;
+    rv::BufferHandle deformedVertexBuffer;
+    std::vector<DeformDispatch> dispatches;
+    std::vector<glm::mat4> jointPalette;
+    std::vector<float> morphWeights;
+};
+
+// 焼き込んだアニメーション
+// トラックとインスタンスは変更があったフレームだけ中身を持ち、毎フレーム渡すのは再生時刻だけ
+struct BakedAnimationSnapshot {
+    std::vector<glm::mat4> frames;
+    std::vector<BakedTrack> tracks;
+    bool tracksChanged = false;
+    std::vector<BakedAnimationInstance> instances;
+    bool instancesChanged = false;
+    uint32_t instanceCount = 0;
+    float time = 0.0f;
+};
+
+struct CameraSnapshot {
+    glm::mat4 view{1.0f};
+    glm::mat4 proj{1.0f};
+    glm::vec3 position{0.0f};
+    rv::Frustum frustum{};
+};
+
+struct DirectionalLightSnapshot {
+    glm::vec3 direction;
+    glm::vec3 color;
+    float intensity;
+    glm::mat4 viewProj;
+    glm::mat4 rotation;
+    float shadowBias;
+    bool enableShadow;
+    bool enableShadowCulling;
+};
+
+struct AmbientLightSnapshot {
+    glm::vec3 color;
+    float intensity;
+    int irradianceTexture;
+    int radianceTexture;
+};
+
+// シミュレーションの結果から作る、描画に必要なものだけを集めた読み取り専用のコピー
+// シミュレーションが次のフレームを更新している間も、描画側はシーンに触れずにこれだけを読む
+// NOTE: 2つ用意して、片方を描画している間にもう片方へ書き込む
+//       配列は clear() で容量を残すため、毎フレームのアロケーションは起きない
+struct RenderSnapshot {
+    // シーンから描画に必要なものを取り出す
+    // シーンの状態と削除されたオブジェクトの一覧は、ここで読み出した時点でリセットする
+    void extract(Scene& scene);
+
+    SceneStatusFlags status = SceneStatus::None;
+
+    std::vector<MeshBuffers> meshBuffers;
+    std::vector<DrawPacket> drawPackets;
+    std::vector<ObjectDataUpdate> objectDataUpdates;
+    std::vector<uint32_t> removedObjectIndices;
+    size_t objectSlotCount = 0;  // ObjectDataBuffer に必要な要素数
+
+    DeformSnapshot deform{};
+    BakedAnimationSnapshot bakedAnimation{};
+
+    CameraSnapshot camera{};
+    std::optional<DirectionalLightSnapshot> directionalLight;
+    std::optional<AmbientLightSnapshot> ambientLight;
+
+    // 影を落とすメッシュやライトが変わったか
+    bool shadowCastersChanged = false;
+
+    MeshBuffers cubeMesh{};
+    uint32_t cubeIndexCount = 0;
+
+    std::vector<rv::ImageHandle> textures2D;
+    std::vector<rv::ImageHandle> texturesCube;
+
+    rv::AABB aabb{};
+
+    // エディタのビューポートに表示するもの
+    std::vector<glm::mat4> directionalLightRotations;
+    std::vector<glm::mat4> cameraFrustums;  // アクティブなカメラ以外のカメラの invView * invProj
+
+private:
+    uint32_t findMeshBuffers(const Scene& scene, MeshDataHandle handle, bool deformed);
+
+    // meshBuffers と同じ並び
+    // NOTE: 変形するメッシュは変形後の頂点バッファを使うため別の要素にする
+    std::vector<std::pair<MeshDataHandle, bool>> meshDataKeys;
+
+    // 焼き込んだアニメーションで動くオブジェクト (オブジェクトの番号で引く)
+    // NOTE: GPU が行列を書き込むので、CPU 側のワールド行列では塊をカリングできない
+    std::vector<uint8_t> bakedObjects;
+};
@@ -5,6 +5,7 @@ void Renderer::init(const rv::Context& _context,
                     uint32_t width,
                     uint32_t height) {
     context = &_context;
+    shadowMapDirty = true;
 
     createImages(width, height);
 
@@ -83,6 +84,8 @@ void Renderer::init(const rv::Context& _context,
     descSet->update();
 
     try {
+        deformPass.init(*context);
+        bakedAnimationPass.init(*context);
         skyboxPass.init(*context, descSet, colorFormat);
         shadowMapPass.init(*context, descSet, shadowMapFormat);
         forwardPass.init(*context, descSet, colorFormat, depthFormat, specularBrdfFormat,
@@ -162,7 +165,7 @@ void Renderer::createImages(uint32_t width, uint32_t height) {
 
 void Renderer::render(const rv::CommandBuffer& commandBuffer,
                       const rv::ImageHandle& colorImage,
-                      Scene& scene) {
+                      const RenderSnapshot& snapshot) {
     assert(initialized);
 
     bool shouldUpdate = false;
@@ -182,7 +185,7 @@ void Renderer::render(const rv::CommandBuffer& commandBuffer,
         shouldUpdate = true;
     }
 
-    if (scene.getStatus() & SceneStatus::Cleared) {
+    if (snapshot.status & SceneStatus::Cleared) {
         sceneDataBuffer.clear();
         objectDataBuffer.clear();
         descSet->set("textures2D", dummyTextures2D);
@@ -190,24 +193,29 @@ void Renderer::render(const rv::CommandBuffer& commandBuffer,
         shouldUpdate = true;
     }
 
-    if (!firstFrameRendered || scene.getStatus() & SceneStatus::Texture2DAdded) {
-        if (!scene.getTextures2D().empty()) {
-            std::vector<rv::ImageHandle> textures2D;
-            for (auto& tex : scene.getTextures2D()) {
-                textures2D.push_back(tex.image);
-            }
-            descSet->set("textures2D", textures2D);
+    // メッシュの移動・形状の変更・削除、ライトの変更があればシャドウマップを描き直す
+    if (snapshot.shadowCastersChanged || shadowMapLodSettings != meshLodSettings) {
+        shadowMapDirty = true;
+    }
+
+    // オブジェクト数の上限は無いため、足りなくなったらバッファを拡張する
+    if (objectDataBuffer.needsResize(snapshot.objectSlotCount)) {
+        context->getDevice().waitIdle();
+        objectDataBuffer.resize(*context, snapshot.objectSlotCount);
+        descSet->set("ObjectBuffer", objectDataBuffer.buffer);
+        shouldUpdate = true;
+    }
+
+    if (!firstFrameRendered || snapshot.status & SceneStatus::Texture2DAdded) {
+        if (!snapshot.textures2D.empty()) {
+            descSet->set("textures2D", snapshot.textures2D);
             shouldUpdate = true;
             spdlog::info("Update desc set for texture 2D");
         }
     }
-    if (!firstFrameRendered || scene.getStatus() & SceneStatus::TextureCubeAdded) {
-        if (!scene.getTexturesCube().empty()) {
-            std::vector<rv::ImageHandle> texturesCube;
-            for (auto& tex : scene.getTexturesCube()) {
-                texturesCube.push_back(tex.image);
-            }
-            descSet->set("texturesCube", texturesCube);
+    if (!firstFrameRendered || snapshot.status & SceneStatus::TextureCubeAdded) {
+        if (!snapshot.texturesCube.empty()) {
+            descSet->set("texturesCube", snapshot.texturesCube);
             shouldUpdate = true;
             spdlog::info("Update desc set for texture cube");
         }
@@ -215,10 +223,13 @@ void Renderer::render(const rv::CommandBuffer& commandBuffer,
     if (shouldUpdate) {
         descSet->update();
     }
-    scene.resetStatus();
 
-    objectDataBuffer.update(commandBuffer, scene);
-    sceneDataBuffer.update(commandBuffer, scene, extent, enableFXAA, enableSSR, exposure,
+    objectDataBuffer.update(commandBuffer, snapshot);
+
+    // Baked animation pass
+    // NOTE: 上で転送した ObjectData の行列を、焼き込んだアニメーションで上書きする
+    bakedAnimationPass.render(commandBuffer, snapshot.bakedAnimation, objectDataBuffer.buffer);
+    sceneDataBuffer.update(commandBuffer, snapshot, extent, enableFXAA, enableSSR, exposure,
                            ssrIntensity);
 
     // TODO: ここでいいのか検討
@@ -232,22 +243,32 @@ void Renderer::render(const rv::CommandBuffer& commandBuffer,
     commandBuffer.transitionLayout(normalImage, vk::ImageLayout::eColorAttachmentOptimal);
     commandBuffer.transitionLayout(depthImage, vk::ImageLayout::eDepthAttachmentOptimal);
 
+    // Deform pass
+    // NOTE: 関節やモーフターゲットのウェイトが変わったフレームだけ実行し、
+    //       結果をシャドウとフォワードで共有する
+    if (!snapshot.deform.dispatches.empty()) {
+        deformPass.render(commandBuffer, snapshot.deform);
+    }
+
     // Shadow pass
-    if (Object* dirLightObj = scene.findObject<DirectionalLight>()) {
-        DirectionalLight* dirLight = dirLightObj->get<DirectionalLight>();
-        if (dirLight->enableShadow) {
-            shadowMapPass.render(commandBuffer, shadowMapImage, scene, *dirLight);
+    if (const auto& dirLight = snapshot.directionalLight) {
+        if (dirLight->enableShadow && shadowMapDirty) {
+            shadowMapPass.render(commandBuffer, shadowMapImage, snapshot, meshLodSettings);
+            shadowMapLodSettings = meshLodSettings;
+            shadowMapDirty = false;
         }
     }
 
     // Skybox pass
-    if (scene.findObject<AmbientLight>()) {
-        skyboxPass.render(commandBuffer, baseColorImage, scene.getCubeMesh());
+    if (snapshot.ambientLight) {
+        skyboxPass.render(commandBuffer, baseColorImage, snapshot.cubeMesh,
+                          snapshot.cubeIndexCount);
     }
 
     // Forward pass
     forwardPass.render(commandBuffer, baseColorImage, depthImage, specularBrdfImage, normalImage,
-                       scene, enableFrustumCulling, enableSorting);
+                       snapshot, enableFrustumCulling, enableSorting, meshLodSettings,
+                       enableClusterCulling);
 
     // SSR pass
     if (enableSSR) {
@@ -13,7 +13,15 @@ public:
 
     void render(const rv::CommandBuffer& commandBuffer,
                 const rv::ImageHandle& colorImage,
-                Scene& scene);
+                const RenderSnapshot& snapshot);
+
+    float getPassTimeDeform() const {
+        return deformPass.getRenderingTimeMs();
+    }
+
+    float getPassTimeBakedAnimation() const {
+        return bakedAnimationPass.getRenderingTimeMs();
+    }
 
     float getPassTimeShadow() const {
         return shadowMapPass.getRenderingTimeMs();
@@ -51,13 +59,19 @@ public:
     inline static bool enableFXAA = true;
     inline static bool enableFrustumCulling = false;
     inline static bool enableSorting = false;
+    inline static bool enableClusterCulling = true;
     inline static bool enableSSR = true;
     inline static float exposure = 1.0f;
     inline static float ssrIntensity = 1.0f;
+    inline static MeshLodSettings meshLodSettings{};
 
 private:
     bool initialized = false;
     bool firstFrameRendered = false;
+
+    // シャドウマップは影を落とすものが変わったときだけ描き直す
+    bool shadowMapDirty = true;
+    MeshLodSettings shadowMapLodSettings{};  // シャドウマップを描いたときの LOD の設定
     const rv::Context* context = nullptr;
 
     rv::DescriptorSetHandle descSet;
@@ -82,6 +96,9 @@ private:
     rv::ImageHandle normalImage;
     rv::ImageHandle specularBrdfImage;
 
+    DeformPass deformPass;
+    BakedAnimationPass bakedAnimationPass;
+
     // Shadow map pass
     ShadowMapPass shadowMapPass;
     vk::Format shadowMapFormat = vk::Format::eD32Sfloat;
@@ -1,29 +1,68 @@
 #define TINYGLTF_IMPLEMENTATION
 #include "Scene.hpp"
 
-void Scene::init(const rv::Context& _context) {
-    context = &_context;
+#include <algorithm>
+#include <bit>
+#include <cfloat>
+
+#include <glm/gtc/type_ptr.hpp>
+#include <glm/gtx/matrix_decompose.hpp>
 
-    objects.reserve(maxObjectCount);
+#include "Accessor.hpp"
+#include "ScenePack.hpp"
+
+void Scene::init(const rv::Context& _context, JobSystem& _jobSystem) {
+    context = &_context;
+    init(_jobSystem);
 
     int count = static_cast<int>(MeshType::COUNT);
     templateMeshData.reserve(count);
     for (int type = 0; type < count; type++) {
-        templateMeshData.emplace_back(*context, static_cast<MeshType>(type));
+        templateMeshData.push_back(meshData.emplace(*context, static_cast<MeshType>(type)));
     }
 }
 
-Object& Scene::addObject(const std::string& name) {
-    assert(objects.size() < maxObjectCount);
+void Scene::init(JobSystem& _jobSystem) {
+    jobSystem = &_jobSystem;
+    changeJournal.init(Components::count, jobSystem->getThreadCount());
+    sceneMeshData = meshData.emplace();
+}
+
+Object& Scene::addObject(std::string_view name) {
+    return createObject(name);
+}
 
-    int index = 0;
-    std::string newName = name;
-    while (findObject(newName)) {
-        newName = name + std::format(" {}", index++);
+bool Scene::removeObject(ObjectHandle handle) {
+    if (!objects.contains(handle)) {
+        return false;
     }
 
-    objects.emplace_back(std::move(newName));
-    return objects.back();
+    // NOTE: 部分木は親子関係の上で連続しているので、グラフからは一度にまとめて外す
+    //       (一つずつ外すと子の付け替えとノードを詰める処理が部分木の大きさだけ繰り返される)
+    std::vector<uint32_t> removingIndices{handle.index};
+    sceneGraph.collectDescendants(handle.index, removingIndices);
+    sceneGraph.removeSubtree(handle.index);
+    for (auto it = removingIndices.rbegin(); it != removingIndices.rend(); ++it) {
+        uint32_t index = *it;
+        Object& object = objects[index];
+        for (uint32_t id = 0; id < Components::count; id++) {
+            if (object.componentMask & (ComponentMask{1} << id)) {
+                detachComponent(index, id);
+                componentPools[id]->remove(index);
+            }
+        }
+        objectNames.remove(object.getName());
+        changeJournal.discard(index);
+
+        ObjectHandle objectHandle = object.getHandle();
+        if (objectHandle == mainCamera) {
+            mainCamera = {};
+            isMainCameraActive = false;
+        }
+        objects.erase(objectHandle);
+    }
+    status |= SceneStatus::ObjectRemoved;
+    return true;
 }
 
 void Scene::loadFromGltf(const std::filesystem::path& filepath) {
@@ -31,7 +70,36 @@ void Scene::loadFromGltf(const std::filesystem::path& filepath) {
     clear();
 
     tinygltf::Model model;
+    readGltf(filepath, model);
+    loadTextures(model);
+    loadMaterials(model);
+    loadNodes(model);
+    spdlog::info("Loaded glTF file: {}", filepath.string());
+    spdlog::info("  Texture: {}", textures2D.size());
+    spdlog::info("  Material: {}", materials.size());
+    spdlog::info("  Node: {}", objects.size());
+}
+
+void Scene::readGltf(const std::filesystem::path& filepath, tinygltf::Model& model) {
+    // NOTE: 画像のデコードはパースの後にまとめて並列に行うため、
+    //       パース中はエンコードされたままの中身を取っておく
+    struct EncodedImage {
+        int index;
+        int reqWidth;
+        int reqHeight;
+        std::vector<unsigned char> bytes;
+    };
+    std::vector<EncodedImage> encodedImages;
+    auto deferImage = [](tinygltf::Image*, const int imageIndex, std::string*, std::string*,
+                         int reqWidth, int reqHeight, const unsigned char* bytes, int byteCount,
+                         void* userData) {
+        auto& images = *static_cast<std::vector<EncodedImage>*>(userData);
+        images.push_back({imageIndex, reqWidth, reqHeight, {bytes, bytes + byteCount}});
+        return true;
+    };
+
     tinygltf::TinyGLTF loader;
+    loader.SetImageLoader(deferImage, &encodedImages);
     std::string err;
     std::string warn;
     auto extension = filepath.extension();
@@ -41,6 +109,32 @@ void Scene::loadFromGltf(const std::filesystem::path& filepath) {
     } else if (extension == ".glb") {
         ret = loader.LoadBinaryFromFile(&model, &err, &warn, filepath.string());
     }
+
+    // 画像ごとに別々のスレッドでデコードし、RGBA8 に変換する
+    // NOTE: エラーと警告は画像ごとに溜めておき、画像の順に出力する
+    std::vector<std::string> imageErrors(encodedImages.size());
+    std::vector<std::string> imageWarnings(encodedImages.size());
+    std::vector<uint8_t> decoded(encodedImages.size(), 0);
+    if (ret) {
+        auto decodeImages = [&](uint32_t begin, uint32_t end) {
+            for (uint32_t i = begin; i < end; i++) {
+                EncodedImage& encoded = encodedImages[i];
+                decoded[i] = tinygltf::LoadImageData(
+                    &model.images[encoded.index], encoded.index, &imageErrors[i],
+                    &imageWarnings[i], encoded.reqWidth, encoded.reqHeight, encoded.bytes.data(),
+                    static_cast<int>(encoded.bytes.size()), nullptr);
+                // NOTE: エンコードされた中身は大きいので、デコードしたらすぐに解放する
+                encoded.bytes = {};
+            }
+        };
+        jobSystem->parallelFor(static_cast<uint32_t>(encodedImages.size()), 1, decodeImages);
+    }
+    for (size_t i = 0; i < encodedImages.size(); i++) {
+        warn += imageWarnings[i];
+        err += imageErrors[i];
+        ret = ret && decoded[i] != 0;
+    }
+
     if (!warn.empty()) {
         std::cerr << "Warn: " << warn.c_str() << std::endl;
     }
@@ -50,66 +144,106 @@ void Scene::loadFromGltf(const std::filesystem::path& filepath) {
     if (!ret) {
         throw std::runtime_error("Failed to parse glTF: " + filepath.string());
     }
+}
 
-    loadTextures(model);
-    loadMaterials(model);
-    loadNodes(model);
-    spdlog::info("Loaded glTF file: {}", filepath.string());
-    spdlog::info("  Texture: {}", textures2D.size());
-    spdlog::info("  Material: {}", materials.size());
-    spdlog::info("  Node: {}", objects.size());
+std::vector<uint8_t> Scene::findSrgbTextures(const tinygltf::Model& gltfModel) {
+    std::vector<uint8_t> srgb(gltfModel.textures.size(), 0);
+    auto mark = [&](int textureIndex) {
+        if (textureIndex >= 0 && static_cast<size_t>(textureIndex) < srgb.size()) {
+            srgb[textureIndex] = 1;
+        }
+    };
+    for (const tinygltf::Material& material : gltfModel.materials) {
+        mark(material.pbrMetallicRoughness.baseColorTexture.index);
+        mark(material.emissiveTexture.index);
+    }
+    return srgb;
+}
+
+uint32_t Scene::computeMipLevelCount(uint32_t width, uint32_t height) {
+    return static_cast<uint32_t>(std::bit_width(std::max({width, height, 1u})));
 }
 
 void Scene::loadTextures(tinygltf::Model& gltfModel) {
+    std::vector<uint8_t> srgb = findSrgbTextures(gltfModel);
+    std::vector<Texture2DSource> sources;
     for (size_t i = 0; i < gltfModel.textures.size(); ++i) {
         const tinygltf::Texture& texture = gltfModel.textures[i];
 
         // texture.source はイメージのインデックスを指す
         if (texture.source >= 0) {
             const tinygltf::Image& image = gltfModel.images[texture.source];
-            textures2D.push_back({});
-            Texture& tex = textures2D.back();
-            tex.name = image.name;
-            if (tex.name.empty()) {
-                tex.name = std::format("Image {}", textures2D.size());
-            }
-
-            // TODO: 本来はUnormかSrgbかを正しく指定してシェーダ側での色空間変換を省略するべき
-            //       ただし、Texture本体には色空間の情報はなく、マテリアル側から指定されるため、
-            //       読み込みを遅延する必要がある
-            tex.image = context->createImage({
-                .usage = rv::ImageUsage::Sampled,
-                .extent = {static_cast<uint32_t>(image.width), static_cast<uint32_t>(image.height),
-                           1},
-                .format = vk::Format::eR8G8B8A8Unorm,
-                .viewInfo = rv::ImageViewCreateInfo{},
-                .samplerInfo = rv::SamplerCreateInfo{},
-                .debugName = tex.name,
-            });
-
-            rv::BufferHandle buffer = context->createBuffer({
-                .usage = rv::BufferUsage::Staging,
-                .memory = rv::MemoryUsage::Host,
-                .size = image.image.size(),
-                .debugName = "Scene::loadTextures::buffer",
-            });
-
-            buffer->copy(image.image.data());
+            std::string name = image.name;
+            if (name.empty()) {
+                name = std::format("Image {}", textures2D.size() + sources.size() + 1);
+            }
+            sources.push_back({std::move(name), static_cast<uint32_t>(image.width),
+                               static_cast<uint32_t>(image.height), image.image, srgb[i] != 0});
+        }
+    }
+    createTextures2D(sources);
+}
 
-            context->oneTimeSubmit([&](auto commandBuffer) {
-                commandBuffer->transitionLayout(tex.image, vk::ImageLayout::eTransferDstOptimal);
-                commandBuffer->copyBufferToImage(buffer, tex.image);
-                commandBuffer->transitionLayout(tex.image, vk::ImageLayout::eShaderReadOnlyOptimal);
-            });
+void Scene::createTextures2D(std::span<const Texture2DSource> sources) {
+    if (sources.empty()) {
+        return;
+    }
 
-            IconManager::addIcon(tex.name, tex.image);
+    // NOTE: イメージとバッファの作成はコンテキストを介するので、メインスレッドで順に行う
+    size_t firstTexture = textures2D.size();
+    std::vector<rv::BufferHandle> buffers;
+    buffers.reserve(sources.size());
+    for (const Texture2DSource& source : sources) {
+        textures2D.push_back({});
+        Texture& tex = textures2D.back();
+        tex.name = source.name;
+
+        // NOTE: 色のテクスチャは sRGB のフォーマットにし、サンプリング時に GPU がリニアに変換する
+        //       ミップマップの縮小もリニアな値で行われる
+        tex.image = context->createImage({
+            .usage = rv::ImageUsage::Sampled | vk::ImageUsageFlagBits::eTransferSrc,
+            .extent = {source.width, source.height, 1},
+            .format = source.srgb ? vk::Format::eR8G8B8A8Srgb : vk::Format::eR8G8B8A8Unorm,
+            .viewInfo = rv::ImageViewCreateInfo{},
+            .samplerInfo = rv::SamplerCreateInfo{},
+            .mipLevels = computeMipLevelCount(source.width, source.height),
+            .debugName = tex.name,
+        });
+
+        buffers.push_back(context->createBuffer({
+            .usage = rv::BufferUsage::Staging,
+            .memory = rv::MemoryUsage::Host,
+            .size = source.pixels.size(),
+            .debugName = "Scene::createTextures2D::buffer",
+        }));
+    }
 
-            status |= SceneStatus::Texture2DAdded;
+    auto copyPixels = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            buffers[i]->copy(sources[i].pixels.data());
+        }
+    };
+    jobSystem->parallelFor(static_cast<uint32_t>(sources.size()), 1, copyPixels);
+
+    context->oneTimeSubmit([&](auto commandBuffer) {
+        for (size_t i = 0; i < sources.size(); i++) {
+            const rv::ImageHandle& image = textures2D[firstTexture + i].image;
+            commandBuffer->transitionLayout(image, vk::ImageLayout::eTransferDstOptimal);
+            commandBuffer->copyBufferToImage(buffers[i], image);
+            commandBuffer->generateMipmaps(image);
+            commandBuffer->transitionLayout(image, vk::ImageLayout::eShaderReadOnlyOptimal);
         }
+    });
+
+    for (size_t i = firstTexture; i < textures2D.size(); i++) {
+        IconManager::addIcon(textures2D[i].name, textures2D[i].image);
     }
+
+    status |= SceneStatus::Texture2DAdded;
 }
 
 void Scene::loadMaterials(tinygltf::Model& gltfModel) {
+    gltfMaterials.clear();
     for (auto& mat : gltfModel.materials) {
         Material material;
 
@@ -152,216 +286,695 @@ void Scene::loadMaterials(tinygltf::Model& gltfModel) {
                 mat.additionalValues["occlusionTexture"].TextureIndex();
         }
 
-        materials.push_back(material);
+        material.doubleSided = mat.doubleSided;
+
+        gltfMaterials.push_back(materials.emplace(std::move(material)));
     }
 }
 
-void Scene::loadMesh(tinygltf::Model& gltfModel, tinygltf::Primitive& gltfPrimitive, Mesh& mesh) {
-    // WARN: Since different attributes may refer to the same data, creating a
-    // vertex/index buffer for each attribute will result in data duplication.
-    auto& vertices = meshData.vertices;
-    auto& indices = meshData.indices;
+AccessorView getAccessorView(const tinygltf::Model& gltfModel, const tinygltf::Accessor& accessor) {
+    AccessorView view{
+        .count = accessor.count,
+        .componentType = static_cast<AccessorComponentType>(accessor.componentType),
+        .normalized = accessor.normalized,
+    };
+    if (accessor.bufferView != -1) {
+        const tinygltf::BufferView& bufferView = gltfModel.bufferViews[accessor.bufferView];
+        const tinygltf::Buffer& buffer = gltfModel.buffers[bufferView.buffer];
+        view.data = buffer.data.data() + bufferView.byteOffset + accessor.byteOffset;
+        view.byteStride = bufferView.byteStride;
+    }
+    return view;
+}
 
-    size_t vertexOffset = vertices.size();
-    size_t indexOffset = indices.size();
+AccessorSparseView getAccessorSparseView(const tinygltf::Model& gltfModel,
+                                         const tinygltf::Accessor& accessor) {
+    if (!accessor.sparse.isSparse) {
+        return {};
+    }
+    const auto& sparse = accessor.sparse;
+    const tinygltf::BufferView& indexView = gltfModel.bufferViews[sparse.indices.bufferView];
+    const tinygltf::BufferView& valueView = gltfModel.bufferViews[sparse.values.bufferView];
+    const tinygltf::Buffer& indexBuffer = gltfModel.buffers[indexView.buffer];
+    const tinygltf::Buffer& valueBuffer = gltfModel.buffers[valueView.buffer];
+    return {
+        .indices = indexBuffer.data.data() + indexView.byteOffset + sparse.indices.byteOffset,
+        .values = valueBuffer.data.data() + valueView.byteOffset + sparse.values.byteOffset,
+        .count = static_cast<size_t>(sparse.count),
+        .indexComponentType = static_cast<AccessorComponentType>(sparse.indices.componentType),
+    };
+}
 
-    // Vertex attributes
+// アクセサの先頭 maxCount 個までの要素を N 成分の D として dst に読み出す
+// NOTE: 正規化された整数 (KHR_mesh_quantization など) は float にする
+//       sparse のアクセサは元の値 (bufferView が無ければ 0) に疎な値を上書きする
+template <typename D, uint32_t N>
+void readGltfAccessor(const tinygltf::Model& gltfModel,
+                      const tinygltf::Accessor& accessor,
+                      D* dst,
+                      size_t dstStride,
+                      size_t maxCount) {
+    AccessorView view = getAccessorView(gltfModel, accessor);
+    view.count = std::min(view.count, maxCount);
+    readAccessor<D, N>(view, dst, dstStride, getAccessorSparseView(gltfModel, accessor));
+}
+
+// プリミティブの属性を、構造体の配列の各要素のメンバに読み出す
+// NOTE: 持たない属性は書き込まない。要素数がアクセサより少なければ、その分だけ読む
+template <typename Element, glm::length_t N, typename D>
+void readAttribute(const tinygltf::Model& gltfModel,
+                   const tinygltf::Primitive& gltfPrimitive,
+                   const std::string& name,
+                   std::span<Element> elements,
+                   glm::vec<N, D> Element::*member) {
+    auto it = gltfPrimitive.attributes.find(name);
+    if (it == gltfPrimitive.attributes.end() || elements.empty()) {
+        return;
+    }
+    readGltfAccessor<D, static_cast<uint32_t>(N)>(gltfModel, gltfModel.accessors[it->second],
+                                                  glm::value_ptr(elements[0].*member),
+                                                  sizeof(Element), elements.size());
+}
+
+// アクセサを T の配列として読み出す
+// NOTE: 成分の数が T と合わない場合は false を返す
+template <typename T>
+bool readFloatAccessor(const tinygltf::Model& gltfModel, int accessorIndex, std::vector<T>& out) {
+    const tinygltf::Accessor& accessor = gltfModel.accessors[accessorIndex];
+    constexpr uint32_t componentCount = sizeof(T) / sizeof(float);
+    if (static_cast<uint32_t>(tinygltf::GetNumComponentsInType(accessor.type)) != componentCount ||
+        (accessor.bufferView == -1 && !accessor.sparse.isSparse)) {
+        return false;
+    }
+    out.resize(accessor.count);
+    readGltfAccessor<float, componentCount>(gltfModel, accessor,
+                                            reinterpret_cast<float*>(out.data()), sizeof(T),
+                                            out.size());
+    return true;
+}
+
+void Scene::loadMesh(tinygltf::Model& gltfModel, tinygltf::Primitive& gltfPrimitive, Mesh& mesh) {
+    MeshData& data = *meshData.get(sceneMeshData);
     auto& attributes = gltfPrimitive.attributes;
 
     assert(attributes.contains("POSITION"));
-    int positionIndex = attributes.find("POSITION")->second;
-    tinygltf::Accessor* positionAccessor = &gltfModel.accessors[positionIndex];
-    tinygltf::BufferView* positionBufferView = &gltfModel.bufferViews[positionAccessor->bufferView];
+    const tinygltf::Accessor& positionAccessor =
+        gltfModel.accessors[attributes.find("POSITION")->second];
+
+    // NOTE: インデックスを持たないプリミティブは頂点の順に並べる
+    size_t vertexCount = positionAccessor.count;
+    size_t indexCount = vertexCount;
+    if (gltfPrimitive.indices != -1) {
+        const tinygltf::Accessor& indexAccessor = gltfModel.accessors[gltfPrimitive.indices];
+        switch (indexAccessor.componentType) {
+            case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT:
+            case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT:
+            case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE:
+                indexCount = indexAccessor.count;
+                break;
+            default:
+                std::cerr << "Index component type " << indexAccessor.componentType
+                          << " not supported!" << std::endl;
+                indexCount = 0;
+                break;
+        }
+    }
 
-    tinygltf::Accessor* normalAccessor = nullptr;
-    tinygltf::BufferView* normalBufferView = nullptr;
-    if (attributes.contains("NORMAL")) {
-        int normalIndex = attributes.find("NORMAL")->second;
-        normalAccessor = &gltfModel.accessors[normalIndex];
-        normalBufferView = &gltfModel.bufferViews[normalAccessor->bufferView];
+    // WARN: Since different attributes may refer to the same data, creating a
+    // vertex/index buffer for each attribute will result in data duplication.
+    size_t vertexOffset = data.vertices.size();
+    size_t indexOffset = data.indices.size();
+    data.vertices.resize(vertexOffset + vertexCount);
+    data.indices.resize(indexOffset + indexCount);
+
+    // Skin
+    // NOTE: 先に読み込んだスキンを持たないメッシュの分はウェイト 0 で埋める
+    if (attributes.contains("JOINTS_0") && attributes.contains("WEIGHTS_0")) {
+        data.skinVertices.resize(vertexOffset + vertexCount);
     }
 
-    tinygltf::Accessor* texCoordAccessor = nullptr;
-    tinygltf::BufferView* texCoordBufferView = nullptr;
-    if (attributes.contains("TEXCOORD_0")) {
-        int texCoordIndex = attributes.find("TEXCOORD_0")->second;
-        texCoordAccessor = &gltfModel.accessors[texCoordIndex];
-        texCoordBufferView = &gltfModel.bufferViews[texCoordAccessor->bufferView];
+    // Morph targets
+    // NOTE: 差分が 0 でない頂点だけを残す。ウェイトはノード単位なので loadNodes() で割り当てる
+    //       差分は可変長で詰めていくため、並列にはせずプリミティブの順に追加する
+    if (!gltfPrimitive.targets.empty()) {
+        std::vector<MorphTargetAttributes> targets(gltfPrimitive.targets.size());
+        for (size_t target = 0; target < targets.size(); target++) {
+            for (const auto& [attribute, accessorIndex] : gltfPrimitive.targets[target]) {
+                if (attribute == "POSITION") {
+                    readFloatAccessor(gltfModel, accessorIndex, targets[target].positions);
+                } else if (attribute == "NORMAL") {
+                    readFloatAccessor(gltfModel, accessorIndex, targets[target].normals);
+                } else if (attribute == "TANGENT") {
+                    readFloatAccessor(gltfModel, accessorIndex, targets[target].tangents);
+                }
+            }
+        }
+        if (data.morphTargets.add(static_cast<uint32_t>(vertexOffset),
+                                  static_cast<uint32_t>(vertexCount), targets) > 0) {
+            mesh.morphTargetCount = static_cast<uint32_t>(targets.size());
+        }
     }
 
-    bool hasTangent = false;
-    tinygltf::Accessor* tangentAccessor = nullptr;
-    tinygltf::BufferView* tangentBufferView = nullptr;
-    if (attributes.contains("TANGENT")) {
-        hasTangent = true;
-        int tangentIndex = attributes.find("TANGENT")->second;
-        tangentAccessor = &gltfModel.accessors[tangentIndex];
-        tangentBufferView = &gltfModel.bufferViews[tangentAccessor->bufferView];
+    mesh.meshData = sceneMeshData;
+    if (gltfPrimitive.material != -1) {
+        mesh.material = gltfMaterials[gltfPrimitive.material];
+        Material& material = *materials.get(mesh.material);
+        material.enableNormalMapping =
+            attributes.contains("TANGENT") && material.normalTextureIndex != -1;
     }
+    mesh.firstIndex = static_cast<uint32_t>(indexOffset);
+    mesh.vertexOffset = static_cast<uint32_t>(vertexOffset);
+    mesh.indexCount = static_cast<uint32_t>(indexCount);
+    mesh.vertexCount = static_cast<uint32_t>(vertexCount);
+}
 
-    // Loop over the vertices
-    for (size_t i = 0; i < positionAccessor->count; i++) {
-        VertexPNUT vertex{};
+void Scene::convertMesh(const tinygltf::Model& gltfModel,
+                        const tinygltf::Primitive& gltfPrimitive,
+                        Mesh& mesh) {
+    MeshData& data = *meshData.get(sceneMeshData);
 
-        // NOTE:
-        // byteStride が 0 の場合、データは密に詰まっている
-        size_t positionByteStride = positionBufferView->byteStride;
-        if (positionByteStride == 0) {
-            positionByteStride = sizeof(glm::vec3);
+    // Vertex attributes
+    // NOTE: 属性ごとにまとめて変換し、頂点の配列のメンバへ直接書き込む
+    //       持たない属性は loadMesh() で確保したときの 0 のまま残る
+    std::span<VertexPNUT> vertices{data.vertices.data() + mesh.vertexOffset, mesh.vertexCount};
+    readAttribute(gltfModel, gltfPrimitive, "POSITION", vertices, &VertexPNUT::position);
+    readAttribute(gltfModel, gltfPrimitive, "NORMAL", vertices, &VertexPNUT::normal);
+    readAttribute(gltfModel, gltfPrimitive, "TEXCOORD_0", vertices, &VertexPNUT::texCoord);
+    readAttribute(gltfModel, gltfPrimitive, "TANGENT", vertices, &VertexPNUT::tangent);
+
+    // Skin
+    // NOTE: 関節の番号はスキン内のインデックスのまま持ち、パレットの位置は loadSkins() で決める
+    const auto& attributes = gltfPrimitive.attributes;
+    if (attributes.contains("JOINTS_0") && attributes.contains("WEIGHTS_0")) {
+        std::span<SkinVertex> skins{data.skinVertices.data() + mesh.vertexOffset,
+                                    mesh.vertexCount};
+        readAttribute(gltfModel, gltfPrimitive, "JOINTS_0", skins, &SkinVertex::joints);
+        readAttribute(gltfModel, gltfPrimitive, "WEIGHTS_0", skins, &SkinVertex::weights);
+    }
+
+    // Get indices
+    uint32_t* indices = data.indices.data() + mesh.firstIndex;
+    if (gltfPrimitive.indices == -1) {
+        for (uint32_t i = 0; i < mesh.indexCount; i++) {
+            indices[i] = i;
         }
+    } else {
+        // NOTE: 符号なし整数は幅によらず uint32_t にする。対応しない型は loadMesh() で除いている
+        readGltfAccessor<uint32_t, 1>(gltfModel, gltfModel.accessors[gltfPrimitive.indices],
+                                      indices, sizeof(uint32_t), mesh.indexCount);
+    }
+
+    mesh.computeLocalAABB(data);
+}
+
+void Scene::updateAnimation(float dt) {
+    // NOTE: dt はミリ秒
+    //       焼き込んだアニメーションはクリップが無くても再生を続ける
+    bakedAnimationTime += dt * 0.001;
+
+    AnimationClip* clip = animationPlayer.getActiveClip();
+    ComponentPool<Transform>* pool = getPool<Transform>();
+    if (!clip) {
+        return;
+    }
 
-        size_t positionByteOffset =
-            positionAccessor->byteOffset + positionBufferView->byteOffset + i * positionByteStride;
-        vertex.position = *reinterpret_cast<const glm::vec3*>(
-            &(gltfModel.buffers[positionBufferView->buffer].data[positionByteOffset]));
+    animationPlayer.advance(dt * 0.001);
+    float time = animationPlayer.getClipTime();
+    updateAnimationLod();
+
+    auto shouldSample = [this](uint32_t target) {
+        return animationUpdateMask[target] != 0;
+    };
+    auto sampleTracks = [&]<typename T>(AnimationTracks<T>& tracks, T Transform::*member) {
+        auto sampleRange = [&](uint32_t begin, uint32_t end) {
+            tracks.sample(time, begin, end, shouldSample);
+            std::span<const uint32_t> targets = tracks.getTargets();
+            std::span<const T> results = tracks.getResults();
+            for (uint32_t track = begin; track < end; track++) {
+                Transform* transform = pool->get(targets[track]);
+                if (!transform || !shouldSample(targets[track])) {
+                    continue;
+                }
+                transform->*member = results[track];
+                changeJournal.record(targets[track], componentID<Transform>,
+                                     ChangeField::Transform);
+            }
+        };
+        jobSystem->parallelFor(tracks.size(), animationChunkSize, sampleRange);
+    };
+    if (pool) {
+        sampleTracks(clip->translations, &Transform::translation);
+        sampleTracks(clip->rotations, &Transform::rotation);
+        sampleTracks(clip->scales, &Transform::scale);
+    }
 
-        if (normalBufferView) {
-            size_t normalByteStride = normalBufferView->byteStride;
-            if (normalByteStride == 0) {
-                normalByteStride = sizeof(glm::vec3);
+    // モーフターゲットのウェイト
+    // NOTE: トラックごとに書き込む位置が異なるので、範囲ごとに並列に書き込める
+    AnimationTracks<float>& weightTracks = clip->weights;
+    if (weightTracks.size() > 0) {
+        std::span<float> weights = morphWeights.getWeights();
+        auto sampleWeights = [&](uint32_t begin, uint32_t end) {
+            weightTracks.sample(time, begin, end);
+            std::span<const uint32_t> targets = weightTracks.getTargets();
+            std::span<const float> results = weightTracks.getResults();
+            for (uint32_t track = begin; track < end; track++) {
+                weights[targets[track]] = results[track];
             }
-            size_t normalByteOffset =
-                normalAccessor->byteOffset + normalBufferView->byteOffset + i * normalByteStride;
-            vertex.normal = *reinterpret_cast<const glm::vec3*>(
-                &(gltfModel.buffers[normalBufferView->buffer].data[normalByteOffset]));
+        };
+        jobSystem->parallelFor(weightTracks.size(), animationChunkSize, sampleWeights);
+        morphWeights.markDirty();
+    }
+}
+
+void Scene::updateAnimationLod() {
+    if (animationLodSourcesDirty) {
+        buildAnimationLodSources();
+        animationLodSourcesDirty = false;
+    }
+    animationFrame++;
+
+    size_t slotCount = objects.getSlotCount();
+    animationLodRates.resize(slotCount, AnimationRate::Full);
+    animationUpdateMask.resize(slotCount, 1);
+
+    // 測るメッシュごとに頻度を決める
+    // NOTE: AABB はまだこのフレームのアニメーションを反映していない (前フレームの位置)
+    //       視錐台の外でも間引いて更新し続けるので、AABB は自身の動きに遅れて追従する
+    Camera* camera = isMainCameraAvailable() ? getMainCamera() : &defaultCamera;
+    rv::Frustum frustum = camera->getFrustum();
+    glm::vec3 cameraPosition = camera->getPosition();
+    float projScaleY = camera->getProj()[1][1];
+    const ComponentPool<Mesh>* meshPool = getPool<Mesh>();
+    for (uint32_t source : animationLodSourceObjects) {
+        AnimationRate rate = AnimationRate::Full;
+        if (meshPool && meshPool->get(source) && source < worldAABBs.size()) {
+            const rv::AABB& worldAABB = worldAABBs[source];
+            float distance = glm::length(worldAABB.center - cameraPosition);
+            float screenSize =
+                computeScreenSize(glm::length(worldAABB.extents), distance, projScaleY);
+            rate = chooseAnimationRate(worldAABB.isOnFrustum(frustum), screenSize,
+                                       animationLodSettings);
         }
+        animationLodRates[source] = rate;
+    }
 
-        if (texCoordBufferView) {
-            size_t texCoordByteStride = texCoordBufferView->byteStride;
-            if (texCoordByteStride == 0) {
-                texCoordByteStride = sizeof(glm::vec2);
+    // 対象ごとに、設定があればそれを優先し、無ければメッシュの頻度を使う
+    const ComponentPool<Transform>* transformPool = getPool<Transform>();
+    auto getOverride = [transformPool](uint32_t objectIndex) {
+        const Transform* transform = transformPool ? transformPool->get(objectIndex) : nullptr;
+        return transform ? transform->animationRate : AnimationRate::Auto;
+    };
+    for (uint32_t target : animationLodTargets) {
+        uint32_t source = animationLodSources[target];
+        bool hasSource = source != SceneGraph::nullIndex;
+        AnimationRate rate = getOverride(target);
+        if (rate == AnimationRate::Auto && hasSource) {
+            rate = getOverride(source);
+        }
+        if (rate == AnimationRate::Auto) {
+            rate = hasSource ? animationLodRates[source] : AnimationRate::Full;
+        }
+        uint32_t staggerKey = hasSource ? source : target;
+        animationUpdateMask[target] = shouldUpdateAnimation(rate, animationFrame, staggerKey);
+    }
+}
+
+void Scene::buildAnimationLodSources() {
+    // アニメーションの対象
+    animationLodTargets.clear();
+    for (const AnimationClip& clip : animationPlayer.getClips()) {
+        for (std::span<const uint32_t> targets :
+             {clip.translations.getTargets(), clip.rotations.getTargets(),
+              clip.scales.getTargets()}) {
+            for (uint32_t target : targets) {
+                if (target != AnimationTracks<float>::invalidTarget) {
+                    animationLodTargets.push_back(target);
+                }
             }
-            size_t texCoordByteOffset = texCoordAccessor->byteOffset +
-                                        texCoordBufferView->byteOffset + i * texCoordByteStride;
-            vertex.texCoord = *reinterpret_cast<const glm::vec2*>(
-                &(gltfModel.buffers[texCoordBufferView->buffer].data[texCoordByteOffset]));
         }
+    }
+    std::ranges::sort(animationLodTargets);
+    auto [first, last] = std::ranges::unique(animationLodTargets);
+    animationLodTargets.erase(first, last);
 
-        if (tangentAccessor) {
-            size_t tangentByteStride = tangentBufferView->byteStride;
-            if (tangentByteStride == 0) {
-                tangentByteStride = sizeof(glm::vec4);
+    animationLodSources.assign(objects.getSlotCount(), SceneGraph::nullIndex);
+    if (animationLodTargets.empty()) {
+        animationLodSourceObjects.clear();
+        return;
+    }
+
+    // 関節は、それが動かすスキンメッシュで測る
+    // NOTE: 複数のメッシュを動かす関節は最初のメッシュで代表する
+    jointPalette.forEachJoint([this](uint32_t joint, uint32_t meshObject) {
+        if (animationLodSources[joint] == SceneGraph::nullIndex) {
+            animationLodSources[joint] = meshObject;
+        }
+    });
+
+    // それ以外は自身のメッシュ、無ければ最初に見つかった子孫のメッシュで測る
+    // (複数のプリミティブを持つノードはプリミティブが子になっている)
+    // NOTE: 子孫は行きがけ順に連続した範囲なので、グラフ全体は走査しない
+    for (uint32_t target : animationLodTargets) {
+        uint32_t& source = animationLodSources[target];
+        if (source != SceneGraph::nullIndex) {
+            continue;
+        }
+        if (objects[target].has<Mesh>()) {
+            source = target;
+            continue;
+        }
+        for (uint32_t descendant : sceneGraph.getDescendants(target)) {
+            if (objects[descendant].has<Mesh>()) {
+                source = descendant;
+                break;
             }
-            size_t tangentByteOffset =
-                tangentAccessor->byteOffset + tangentBufferView->byteOffset + i * tangentByteStride;
-            vertex.tangent = *reinterpret_cast<const glm::vec4*>(
-                &(gltfModel.buffers[tangentBufferView->buffer].data[tangentByteOffset]));
         }
+    }
 
-        vertices.push_back(vertex);
+    animationLodSourceObjects.clear();
+    for (uint32_t target : animationLodTargets) {
+        if (animationLodSources[target] != SceneGraph::nullIndex) {
+            animationLodSourceObjects.push_back(animationLodSources[target]);
+        }
     }
+    std::ranges::sort(animationLodSourceObjects);
+    auto [firstSource, lastSource] = std::ranges::unique(animationLodSourceObjects);
+    animationLodSourceObjects.erase(firstSource, lastSource);
+}
 
-    // Get indices
-    auto& accessor = gltfModel.accessors[gltfPrimitive.indices];
-    auto& bufferView = gltfModel.bufferViews[accessor.bufferView];
-    auto& buffer = gltfModel.buffers[bufferView.buffer];
-
-    size_t indicesCount = accessor.count;
-    switch (accessor.componentType) {
-        case TINYGLTF_PARAMETER_TYPE_UNSIGNED_INT: {
-            uint32_t* buf = new uint32_t[indicesCount];
-            size_t size = indicesCount * sizeof(uint32_t);
-            memcpy(buf, &buffer.data[accessor.byteOffset + bufferView.byteOffset], size);
-            for (size_t i = 0; i < indicesCount; i++) {
-                indices.push_back(buf[i]);
-            }
-            break;
-        }
-        case TINYGLTF_PARAMETER_TYPE_UNSIGNED_SHORT: {
-            uint16_t* buf = new uint16_t[indicesCount];
-            size_t size = indicesCount * sizeof(uint16_t);
-            memcpy(buf, &buffer.data[accessor.byteOffset + bufferView.byteOffset], size);
-            for (size_t i = 0; i < indicesCount; i++) {
-                indices.push_back(buf[i]);
-            }
-            break;
-        }
-        case TINYGLTF_PARAMETER_TYPE_UNSIGNED_BYTE: {
-            uint8_t* buf = new uint8_t[indicesCount];
-            size_t size = indicesCount * sizeof(uint8_t);
-            memcpy(buf, &buffer.data[accessor.byteOffset + bufferView.byteOffset], size);
-            for (size_t i = 0; i < indicesCount; i++) {
-                indices.push_back(buf[i]);
-            }
-            break;
-        }
-        default:
-            std::cerr << "Index component type " << accessor.componentType << " not supported!"
-                      << std::endl;
-            return;
-    }
-
-    mesh.meshData = &meshData;
-    if (gltfPrimitive.material != -1) {
-        mesh.material = &materials[gltfPrimitive.material];
-        mesh.material->enableNormalMapping = hasTangent && mesh.material->normalTextureIndex != -1;
+uint32_t Scene::bakeAnimation(Object& object, float frameRate) {
+    AnimationClip* clip = animationPlayer.getActiveClip();
+    const Transform* transform = object.get<Transform>();
+    if (!clip || !transform) {
+        return BakedAnimation::invalidTrack;
     }
-    mesh.firstIndex = static_cast<uint32_t>(indexOffset);
-    mesh.vertexOffset = static_cast<uint32_t>(vertexOffset);
-    mesh.indexCount = static_cast<uint32_t>(indices.size() - indexOffset);
-    mesh.vertexCount = static_cast<uint32_t>(vertices.size() - vertexOffset);
-    mesh.computeLocalAABB();
-}
-
-bool findAnimationSampler(const tinygltf::Model& gltfModel,
-                          int node,
-                          std::string_view path,
-                          tinygltf::AnimationSampler& outSampler) {
-    for (const auto& animation : gltfModel.animations) {
-        for (const auto& channel : animation.channels) {
-            if (channel.target_node == node && channel.target_path == path) {
-                outSampler = animation.samplers[channel.sampler];
-                return true;
-            }
+    // NOTE: クリップに無いチャンネルは今の値のまま固定する
+    uint32_t track = bakedAnimation.bake(*clip, object.getIndex(), frameRate,
+                                         transform->translation, transform->rotation,
+                                         transform->scale);
+    if (track == BakedAnimation::invalidTrack) {
+        spdlog::warn("{} is not animated by the active clip.", object.getName());
+        return track;
+    }
+    addBakedAnimationInstance(object, track, 0.0f);
+    return track;
+}
+
+void Scene::addBakedAnimationInstance(Object& object, uint32_t track, float timeOffset) {
+    if (track >= bakedAnimation.getTracks().size() || !object.has<Transform>()) {
+        spdlog::warn("Failed to add baked animation instance to {}.", object.getName());
+        return;
+    }
+    // CPU での再生をやめる
+    uint32_t anchor = object.getIndex();
+    animationPlayer.removeTarget(anchor);
+    animationLodSourcesDirty = true;
+
+    std::vector<uint32_t> meshObjects;
+    if (object.has<Mesh>()) {
+        meshObjects.push_back(anchor);
+    }
+    for (uint32_t descendant : sceneGraph.getDescendants(anchor)) {
+        if (objects[descendant].has<Mesh>()) {
+            meshObjects.push_back(descendant);
         }
     }
-    return false;
+
+    // NOTE: 既にインスタンスを持つメッシュは上書きする
+    bakedInstanceOfObject.resize(objects.getSlotCount(), SceneGraph::nullIndex);
+    for (uint32_t meshObject : meshObjects) {
+        uint32_t& instanceIndex = bakedInstanceOfObject[meshObject];
+        if (instanceIndex == SceneGraph::nullIndex) {
+            instanceIndex = static_cast<uint32_t>(bakedAnimationInstances.size());
+            bakedAnimationInstances.emplace_back();
+            bakedAnimationAnchors.push_back(anchor);
+        }
+        BakedAnimationInstance& instance = bakedAnimationInstances[instanceIndex];
+        instance.objectIndex = meshObject;
+        instance.track = track;
+        instance.timeOffset = timeOffset;
+        bakedAnimationAnchors[instanceIndex] = anchor;
+        updateBakedAnimationInstance(instanceIndex);
+    }
+    bakedAnimationInstancesDirty = true;
 }
 
-void loadKeyFrame(tinygltf::Model& gltfModel,
-                  int node,
-                  std::string_view path,
-                  std::vector<KeyFrame>& keyFrames) {
-    tinygltf::AnimationSampler sampler;
-    bool found = findAnimationSampler(gltfModel, node, path, sampler);
-    if (!found) {
+void Scene::updateBakedAnimationInstances() {
+    if (bakedAnimationInstances.empty() ||
+        !changeJournal.isDirty(componentID<Transform>, ChangeField::Transform)) {
         return;
     }
+    // NOTE: アンカーが動けばその子孫も記録されるので、メッシュの記録だけを見ればよい
+    for (const ChangeRecord& record : changeJournal.getRecords()) {
+        uint32_t index = record.objectIndex;
+        if (record.componentID != componentID<Transform> ||
+            !(record.fields & ChangeField::Transform) || index >= bakedInstanceOfObject.size() ||
+            bakedInstanceOfObject[index] == SceneGraph::nullIndex) {
+            continue;
+        }
+        updateBakedAnimationInstance(bakedInstanceOfObject[index]);
+        bakedAnimationInstancesDirty = true;
+    }
+}
 
-    tinygltf::Accessor& inputAccessor = gltfModel.accessors[sampler.input];
-    tinygltf::BufferView& inputBufferView = gltfModel.bufferViews[inputAccessor.bufferView];
-    tinygltf::Buffer& inputBuffer = gltfModel.buffers[inputBufferView.buffer];
-    const float* inputData = reinterpret_cast<const float*>(
-        &inputBuffer.data[inputBufferView.byteOffset + inputAccessor.byteOffset]);
-    const size_t inputCount = inputAccessor.count;
+void Scene::recordGeometryChanges() {
+    if (jointPalette.isDirty() || morphWeights.isDirty()) {
+        for (auto [object, mesh] : view<Mesh>()) {
+            if (mesh.isDeformed()) {
+                markChanged(mesh, ChangeField::Geometry);
+            }
+        }
+    }
+    // NOTE: 焼き込んだアニメーションは毎フレーム GPU で行列が書き換わる
+    for (const BakedAnimationInstance& instance : bakedAnimationInstances) {
+        changeJournal.record(instance.objectIndex, componentID<Mesh>, ChangeField::Geometry);
+    }
+}
 
-    tinygltf::Accessor& outputAccessor = gltfModel.accessors[sampler.output];
-    tinygltf::BufferView& outputBufferView = gltfModel.bufferViews[outputAccessor.bufferView];
-    tinygltf::Buffer& outputBuffer = gltfModel.buffers[outputBufferView.buffer];
-    const float* outputData = reinterpret_cast<const float*>(
-        &outputBuffer.data[outputBufferView.byteOffset + outputAccessor.byteOffset]);
+rv::AABB Scene::computeWorldAABB(uint32_t objectIndex, const Mesh& mesh) const {
+    if (objectIndex < bakedInstanceOfObject.size() &&
+        bakedInstanceOfObject[objectIndex] != SceneGraph::nullIndex) {
+        // 焼き込んだアニメーションで動くメッシュは、トラックの全フレームで通る範囲で包む
+        // NOTE: 再生時刻によらないので、インスタンスの時刻のずれは考えなくてよい
+        const BakedAnimationInstance& instance =
+            bakedAnimationInstances[bakedInstanceOfObject[objectIndex]];
+        rv::AABB anchorAABB = transformAABB(mesh.getLocalAABB(), instance.postMatrix);
+        auto [min, max] = bakedAnimation.computeBounds(instance.track, anchorAABB.center,
+                                                       anchorAABB.extents);
+        return transformAABB(rv::AABB{min, max}, instance.preMatrix);
+    }
+    return mesh.getWorldAABB(sceneGraph.getWorldMatrix(objectIndex));
+}
 
-    if (keyFrames.empty()) {
-        keyFrames.resize(inputCount);
+void Scene::updateBakedAnimationInstance(uint32_t instanceIndex) {
+    // GPU では preMatrix * (焼き込んだローカル行列) * postMatrix をワールド行列とする
+    BakedAnimationInstance& instance = bakedAnimationInstances[instanceIndex];
+    uint32_t anchor = bakedAnimationAnchors[instanceIndex];
+    instance.preMatrix = sceneGraph.getParentWorldMatrix(anchor);
+    instance.postMatrix = glm::inverse(sceneGraph.getWorldMatrix(anchor)) *
+                          sceneGraph.getWorldMatrix(instance.objectIndex);
+}
+
+void Scene::removeBakedAnimationInstances(uint32_t index, bool anchored) {
+    // NOTE: 末尾と入れ替えて詰める
+    for (uint32_t i = 0; i < bakedAnimationInstances.size();) {
+        uint32_t objectIndex = bakedAnimationInstances[i].objectIndex;
+        if (objectIndex != index && !(anchored && bakedAnimationAnchors[i] == index)) {
+            i++;
+            continue;
+        }
+        bakedInstanceOfObject[objectIndex] = SceneGraph::nullIndex;
+        // NOTE: アンカーだけが外れたメッシュは、ワールドAABBを元の行列で求め直させる
+        if (objectIndex != index) {
+            changeJournal.record(objectIndex, componentID<Mesh>, ChangeField::Geometry);
+        }
+        uint32_t last = static_cast<uint32_t>(bakedAnimationInstances.size() - 1);
+        if (i != last) {
+            bakedAnimationInstances[i] = bakedAnimationInstances[last];
+            bakedAnimationAnchors[i] = bakedAnimationAnchors[last];
+            bakedInstanceOfObject[bakedAnimationInstances[i].objectIndex] = i;
+        }
+        bakedAnimationInstances.pop_back();
+        bakedAnimationAnchors.pop_back();
+        bakedAnimationInstancesDirty = true;
     }
+}
 
-    for (size_t i = 0; i < inputCount; i++) {
-        keyFrames[i].time = inputData[i];
+void Scene::loadAnimations(tinygltf::Model& gltfModel,
+                           std::span<const uint32_t> nodeObjectIndices,
+                           std::span<const int> nodeMorphWeights) {
+    std::vector<float> times;
+    std::vector<float> floatValues;
+    std::vector<float> targetValues;
+    std::vector<glm::vec3> vec3Values;
+    std::vector<glm::vec4> vec4Values;
+    std::vector<glm::quat> quatValues;
+    for (const tinygltf::Animation& gltfAnimation : gltfModel.animations) {
+        AnimationClip clip;
+        clip.name = gltfAnimation.name;
+        for (const tinygltf::AnimationChannel& channel : gltfAnimation.channels) {
+            if (channel.target_node < 0) {
+                continue;
+            }
+            const tinygltf::AnimationSampler& sampler = gltfAnimation.samplers[channel.sampler];
+            Interpolation interpolation = Interpolation::Linear;
+            if (sampler.interpolation == "STEP") {
+                interpolation = Interpolation::Step;
+            } else if (sampler.interpolation == "CUBICSPLINE") {
+                interpolation = Interpolation::CubicSpline;
+            }
+
+            if (!readFloatAccessor(gltfModel, sampler.input, times) || times.empty()) {
+                spdlog::warn("Unsupported animation input in {}", gltfAnimation.name);
+                continue;
+            }
+
+            uint32_t target = nodeObjectIndices[channel.target_node];
+            const std::string& path = channel.target_path;
+            bool loaded = false;
+            if (path == "translation" || path == "scale") {
+                loaded = readFloatAccessor(gltfModel, sampler.output, vec3Values);
+                if (loaded) {
+                    auto& tracks = path == "translation" ? clip.translations : clip.scales;
+                    tracks.add(target, interpolation, times, vec3Values);
+                }
+            } else if (path == "rotation") {
+                loaded = readFloatAccessor(gltfModel, sampler.output, vec4Values);
+                if (loaded) {
+                    // NOTE: glTF は (x, y, z, w) の順
+                    quatValues.clear();
+                    for (const glm::vec4& v : vec4Values) {
+                        quatValues.emplace_back(v.w, v.x, v.y, v.z);
+                    }
+                    clip.rotations.add(target, interpolation, times, quatValues);
+                }
+            } else if (path == "weights") {
+                int firstWeight = nodeMorphWeights[channel.target_node];
+                loaded = firstWeight >= 0 &&
+                         readFloatAccessor(gltfModel, sampler.output, floatValues);
+                if (loaded) {
+                    // NOTE: キーごとに全ターゲットのウェイトが並ぶので、ターゲットごとに分ける
+                    //       CUBICSPLINE は inTangent, value, outTangent ごとに全ターゲット分並ぶ
+                    size_t valuesPerKey = interpolation == Interpolation::CubicSpline ? 3 : 1;
+                    size_t targetCount = floatValues.size() / (times.size() * valuesPerKey);
+                    size_t weightCount = morphWeights.getWeights().size();
+                    for (size_t morphTarget = 0; morphTarget < targetCount; morphTarget++) {
+                        if (firstWeight + morphTarget >= weightCount) {
+                            break;
+                        }
+                        targetValues.clear();
+                        for (size_t value = 0; value < times.size() * valuesPerKey; value++) {
+                            targetValues.push_back(floatValues[value * targetCount + morphTarget]);
+                        }
+                        clip.weights.add(static_cast<uint32_t>(firstWeight + morphTarget),
+                                         interpolation, times, targetValues);
+                    }
+                }
+            } else {
+                continue;
+            }
+            if (!loaded) {
+                spdlog::warn("Unsupported animation output in {}", gltfAnimation.name);
+            }
+        }
+        animationPlayer.addClip(std::move(clip));
+    }
+    animationLodSourcesDirty = true;
+}
+
+void Scene::loadSkins(tinygltf::Model& gltfModel,
+                      std::span<const uint32_t> nodeObjectIndices,
+                      std::span<const std::pair<int, uint32_t>> skinnedMeshes) {
+    std::vector<uint32_t> jointObjectIndices;
+    std::vector<glm::mat4> inverseBindMatrices;
+    for (auto [skin, meshObjectIndex] : skinnedMeshes) {
+        const tinygltf::Skin& gltfSkin = gltfModel.skins[skin];
+        jointObjectIndices.clear();
+        for (int joint : gltfSkin.joints) {
+            jointObjectIndices.push_back(nodeObjectIndices[joint]);
+        }
+        inverseBindMatrices.clear();
+        if (gltfSkin.inverseBindMatrices != -1) {
+            readFloatAccessor(gltfModel, gltfSkin.inverseBindMatrices, inverseBindMatrices);
+        }
+
+        // NOTE: 同じスキンを共有するメッシュも、メッシュのワールド行列が違うためパレットを分ける
+        addSkin(meshObjectIndex, jointObjectIndices, inverseBindMatrices);
+    }
+}
 
-        if (path == "translation") {
-            keyFrames[i].translation =
-                glm::vec3(outputData[i * 3 + 0], -outputData[i * 3 + 1], outputData[i * 3 + 2]);
-        } else if (path == "rotation") {
-            keyFrames[i].rotation = glm::quat(outputData[i * 4 + 3], outputData[i * 4 + 0],
-                                              outputData[i * 4 + 1], outputData[i * 4 + 2]);
-        } else if (path == "scale") {
-            keyFrames[i].scale =
-                glm::vec3(outputData[i * 3 + 0], outputData[i * 3 + 1], outputData[i * 3 + 2]);
+void Scene::addSkin(uint32_t meshObjectIndex,
+                    std::span<const uint32_t> jointObjectIndices,
+                    std::span<const glm::mat4> inverseBindMatrices) {
+    Mesh* mesh = objects[meshObjectIndex].get<Mesh>();
+    uint32_t firstJoint =
+        jointPalette.addInstance(meshObjectIndex, jointObjectIndices, inverseBindMatrices);
+    mesh->firstJoint = static_cast<int>(firstJoint);
+    mesh->jointCount = static_cast<uint32_t>(jointObjectIndices.size());
+
+    jointAABBs.resize(firstJoint + mesh->jointCount);
+    mesh->unskinnedAABB = mesh->computeJointAABBs(
+        *meshData.get(mesh->meshData), std::span{jointAABBs}.subspan(firstJoint, mesh->jointCount));
+}
+
+void Scene::updateSkinnedAABBs() {
+    std::span<const glm::mat4> matrices = jointPalette.getMatrices();
+    for (auto [object, mesh] : view<Mesh>()) {
+        if (mesh.firstJoint < 0) {
+            continue;
+        }
+        glm::vec3 min = glm::vec3{FLT_MAX, FLT_MAX, FLT_MAX};
+        glm::vec3 max = glm::vec3{-FLT_MAX, -FLT_MAX, -FLT_MAX};
+        auto expand = [&](const rv::AABB& aabb) {
+            // NOTE: 頂点を一つも含まないAABBは extents が負になる (変換しても負のまま)
+            if (aabb.extents.x >= 0.0f) {
+                min = glm::min(min, aabb.center - aabb.extents);
+                max = glm::max(max, aabb.center + aabb.extents);
+            }
+        };
+        expand(mesh.unskinnedAABB);
+        auto firstJoint = static_cast<uint32_t>(mesh.firstJoint);
+        for (uint32_t joint = firstJoint; joint < firstJoint + mesh.jointCount; joint++) {
+            expand(transformAABB(jointAABBs[joint], matrices[joint]));
+        }
+        if (min.x <= max.x) {
+            mesh.aabb = {min, max};
         }
     }
 }
 
 void Scene::loadNodes(tinygltf::Model& gltfModel) {
+    std::vector<uint32_t> nodeObjectIndices(gltfModel.nodes.size());
+    std::vector<std::pair<int, uint32_t>> skinnedMeshes;
+    std::vector<int> nodeMorphWeights(gltfModel.nodes.size(), -1);
+    std::vector<uint32_t> morphedMeshes;
+
+    // プリミティブの頂点・インデックスは、まず順に範囲だけを確保して後から並列に変換する
+    // NOTE: 範囲はプリミティブの順に決まるため、変換の順序によらず結果は同じになる
+    std::vector<std::pair<const tinygltf::Primitive*, uint32_t>> meshPrimitives;
+    size_t totalVertexCount = 0;
+    size_t totalIndexCount = 0;
+    for (const tinygltf::Node& gltfNode : gltfModel.nodes) {
+        if (gltfNode.mesh == -1) {
+            continue;
+        }
+        const tinygltf::Mesh& gltfMesh = gltfModel.meshes[gltfNode.mesh];
+        for (const tinygltf::Primitive& gltfPrimitive : gltfMesh.primitives) {
+            auto position = gltfPrimitive.attributes.find("POSITION");
+            if (position == gltfPrimitive.attributes.end()) {
+                continue;
+            }
+            size_t vertexCount = gltfModel.accessors[position->second].count;
+            totalVertexCount += vertexCount;
+            totalIndexCount += gltfPrimitive.indices != -1
+                                   ? gltfModel.accessors[gltfPrimitive.indices].count
+                                   : vertexCount;
+        }
+    }
+    MeshData& data = *meshData.get(sceneMeshData);
+    data.vertices.reserve(data.vertices.size() + totalVertexCount);
+    data.indices.reserve(data.indices.size() + totalIndexCount);
+
     for (int node = 0; node < gltfModel.nodes.size(); node++) {
         auto& gltfNode = gltfModel.nodes[node];
 
@@ -385,40 +998,187 @@ void Scene::loadNodes(tinygltf::Model& gltfModel) {
                               gltfNode.scale[1],  //
                               gltfNode.scale[2]};
         }
+        if (gltfNode.matrix.size() == 16) {
+            glm::mat4 matrix{glm::make_mat4(gltfNode.matrix.data())};
+            glm::vec3 skew;
+            glm::vec4 perspective;
+            glm::decompose(matrix, scale, rotation, translation, skew, perspective);
+        }
 
-        // Load animation
-        std::vector<KeyFrame> keyFrames;
-        loadKeyFrame(gltfModel, node, "translation", keyFrames);
-        loadKeyFrame(gltfModel, node, "rotation", keyFrames);
-        loadKeyFrame(gltfModel, node, "scale", keyFrames);
+        std::string name = gltfNode.name;
+        if (name.empty() && gltfNode.mesh != -1) {
+            name = gltfModel.meshes[gltfNode.mesh].name;
+        }
+        if (name.empty()) {
+            name = std::format("Object {}", objects.size());
+        }
+
+        // メッシュを持たないノードも親子関係を保つためにオブジェクトにする
+        // NOTE: オブジェクトやコンポーネントを追加すると参照が無効になるので、インデックスで保持する
+        Object& obj = createObject(name);
+        uint32_t objectIndex = obj.getIndex();
+        nodeObjectIndices[node] = objectIndex;
+
+        Transform& trans = obj.add<Transform>();
+        trans.translation = translation;
+        trans.rotation = rotation;
+        trans.scale = scale;
 
         // Load mesh
         if (gltfNode.mesh != -1) {
             auto& gltfMesh = gltfModel.meshes.at(gltfNode.mesh);
+            auto isSkinned = [&](const tinygltf::Primitive& gltfPrimitive) {
+                return gltfNode.skin != -1 && gltfPrimitive.attributes.contains("JOINTS_0");
+            };
+            morphedMeshes.clear();
+            if (gltfMesh.primitives.size() == 1) {
+                Mesh& mesh = obj.add<Mesh>();
+                loadMesh(gltfModel, gltfMesh.primitives[0], mesh);
+                meshPrimitives.emplace_back(&gltfMesh.primitives[0], objectIndex);
+                if (isSkinned(gltfMesh.primitives[0])) {
+                    skinnedMeshes.emplace_back(gltfNode.skin, objectIndex);
+                }
+                if (mesh.morphTargetCount > 0) {
+                    morphedMeshes.push_back(objectIndex);
+                }
+            } else {
+                // 複数のプリミティブはノードの子オブジェクトとして持つ
+                for (auto& gltfPrimitive : gltfMesh.primitives) {
+                    Object& primitiveObj = createObject(name);
+                    primitiveObj.add<Transform>();
+                    sceneGraph.setParent(primitiveObj.getIndex(), objectIndex);
+
+                    Mesh& mesh = primitiveObj.add<Mesh>();
+                    loadMesh(gltfModel, gltfPrimitive, mesh);
+                    meshPrimitives.emplace_back(&gltfPrimitive, primitiveObj.getIndex());
+                    if (isSkinned(gltfPrimitive)) {
+                        skinnedMeshes.emplace_back(gltfNode.skin, primitiveObj.getIndex());
+                    }
+                    if (mesh.morphTargetCount > 0) {
+                        morphedMeshes.push_back(primitiveObj.getIndex());
+                    }
+                }
+            }
 
-            for (auto& gltfPrimitive : gltfMesh.primitives) {
-                std::string name = gltfMesh.name;
-                if (name.empty()) {
-                    name = std::format("Object {}", objects.size());
+            // モーフターゲットのウェイトはノードごとに確保し、プリミティブ間で共有する
+            // NOTE: 初期値はノードの weights、無ければメッシュの weights
+            if (!morphedMeshes.empty()) {
+                size_t targetCount = 0;
+                for (const tinygltf::Primitive& gltfPrimitive : gltfMesh.primitives) {
+                    targetCount = std::max(targetCount, gltfPrimitive.targets.size());
+                }
+                const std::vector<double>& defaultWeights =
+                    gltfNode.weights.empty() ? gltfMesh.weights : gltfNode.weights;
+                std::vector<float> weights(targetCount, 0.0f);
+                for (size_t i = 0; i < std::min(targetCount, defaultWeights.size()); i++) {
+                    weights[i] = static_cast<float>(defaultWeights[i]);
                 }
+                int firstWeight = static_cast<int>(morphWeights.addInstance(weights));
+                nodeMorphWeights[node] = firstWeight;
+                for (uint32_t meshObjectIndex : morphedMeshes) {
+                    objects[meshObjectIndex].get<Mesh>()->firstMorphWeight = firstWeight;
+                }
+            }
+        }
+    }
 
-                objects.emplace_back(name);
-                Object& obj = objects.back();
+    // 頂点・インデックスの変換
+    // NOTE: プリミティブごとに大きさが大きく異なるので、一つずつジョブにして偏りを減らす
+    auto convertMeshes = [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            auto [gltfPrimitive, meshObjectIndex] = meshPrimitives[i];
+            convertMesh(gltfModel, *gltfPrimitive, *objects[meshObjectIndex].get<Mesh>());
+        }
+    };
+    jobSystem->parallelFor(static_cast<uint32_t>(meshPrimitives.size()), 1, convertMeshes);
 
-                // Mesh
-                Mesh& mesh = obj.add<Mesh>();
-                loadMesh(gltfModel, gltfPrimitive, mesh);
+    std::vector<Mesh*> meshes;
+    meshes.reserve(meshPrimitives.size());
+    for (const auto& meshPrimitive : meshPrimitives) {
+        meshes.push_back(objects[meshPrimitive.second].get<Mesh>());
+    }
+
+    // 頂点キャッシュ・オーバードロー・頂点フェッチのために並べ替える
+    // NOTE: 読み込み時に行うので、書き出したシーンパックにも並べ替えた結果が入る
+    auto [before, after] = data.optimize(meshes, jobSystem);
+    spdlog::info("Optimized meshes: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}",
+                 before.getACMR(), after.getACMR(), before.getATVR(), after.getATVR());
+
+    // 塊ごとにカリングできるよう、三角形を塊に分けて並べる
+    data.buildClusters(meshes, jobSystem);
+
+    // 遠くで使う簡略化したメッシュ
+    data.generateLods(meshes, jobSystem);
+
+    // 16ビットに収まるメッシュのインデックスは 16ビットにする
+    data.compactIndices(meshes);
+
+    // 親子関係を繋ぐ
+    for (int node = 0; node < gltfModel.nodes.size(); node++) {
+        for (int child : gltfModel.nodes[node].children) {
+            sceneGraph.setParent(nodeObjectIndices[child], nodeObjectIndices[node]);
+        }
+    }
+
+    loadAnimations(gltfModel, nodeObjectIndices, nodeMorphWeights);
+    loadSkins(gltfModel, nodeObjectIndices, skinnedMeshes);
+
+    data.createBuffers(*context);
+}
+
+bool Scene::isScenePackStale(const std::filesystem::path& packPath,
+                             const std::filesystem::path& gltfPath) {
+    // NOTE: 更新時刻が読めないファイルは更新されたものとみなす
+    std::error_code error;
+    auto packTime = std::filesystem::last_write_time(packPath, error);
+    auto isNewer = [&](const std::filesystem::path& path) {
+        std::error_code fileError;
+        auto time = std::filesystem::last_write_time(path, fileError);
+        return fileError || time > packTime;
+    };
+    if (error || isNewer(gltfPath)) {
+        return true;
+    }
+
+    std::ifstream file(gltfPath, std::ios::binary);
+    std::string text;
+    if (gltfPath.extension() == ".glb") {
+        // NOTE: ヘッダ (magic, version, length) の直後が JSON のチャンク (length, type)
+        std::array<uint32_t, 5> header{};
+        file.read(reinterpret_cast<char*>(header.data()), sizeof(header));
+        constexpr uint32_t glbMagic = 0x46546C67;  // "glTF"
+        constexpr uint32_t jsonChunk = 0x4E4F534A;  // "JSON"
+        if (header[0] != glbMagic || header[4] != jsonChunk || header[3] > header[2]) {
+            return true;
+        }
+        text.resize(header[3]);
+        file.read(text.data(), header[3]);
+    } else {
+        text.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+    }
+    nlohmann::json json = nlohmann::json::parse(text, nullptr, false);
+    if (json.is_discarded()) {
+        return true;
+    }
 
-                // Transform
-                Transform& trans = obj.add<Transform>();
-                trans.translation = translation;
-                trans.rotation = rotation;
-                trans.scale = scale;
-                trans.keyFrames = keyFrames;
+    // 外部ファイルのバッファと画像 (data URI で埋め込まれたものは glTF 自身の更新時刻で分かる)
+    for (const char* key : {"buffers", "images"}) {
+        auto resources = json.find(key);
+        if (resources == json.end()) {
+            continue;
+        }
+        for (const nlohmann::json& resource : *resources) {
+            auto uri = resource.find("uri");
+            if (uri == resource.end() || !uri->is_string()) {
+                continue;
+            }
+            const std::string& path = uri->get_ref<const std::string&>();
+            if (!path.starts_with("data:") && isNewer(gltfPath.parent_path() / path)) {
+                return true;
             }
         }
     }
-    meshData.createBuffers(*context);
+    return false;
 }
 
 void Scene::loadFromJson(const std::filesystem::path& filepath) {
@@ -435,7 +1195,12 @@ void Scene::loadFromJson(const std::filesystem::path& filepath) {
     if (json.contains("gltf")) {
         std::filesystem::path gltfPath = json["gltf"];
         if (!gltfPath.empty()) {
-            loadFromGltf(filepath.parent_path() / gltfPath);
+            // 焼いたシーンパックが glTF より新しければ、パースせずにそちらを使う
+            gltfPath = filepath.parent_path() / gltfPath;
+            std::filesystem::path packPath = getScenePackPath(filepath);
+            if (isScenePackStale(packPath, gltfPath) || !loadFromScenePack(packPath)) {
+                loadFromGltf(gltfPath);
+            }
         }
     }
 
@@ -457,13 +1222,15 @@ void Scene::loadFromJson(const std::filesystem::path& filepath) {
         }
     }
 
+    // NOTE: オブジェクトの "material" はこのファイル内のマテリアルのインデックスを指す
+    std::vector<MaterialHandle> jsonMaterials;
     for (const auto& material : json["materials"]) {
         if (material["type"] == "Standard") {
             const auto& baseColor = material["baseColor"];
-            materials.push_back(Material{
+            jsonMaterials.push_back(materials.emplace(Material{
                 .baseColor = {baseColor[0], baseColor[1], baseColor[2], baseColor[3]},
                 .name = material["name"],
-            });
+            }));
         } else {
             assert(false && "Not implemented");
         }
@@ -472,9 +1239,7 @@ void Scene::loadFromJson(const std::filesystem::path& filepath) {
     for (const auto& object : json["objects"]) {
         assert(object.contains("name"));
 
-        // NOTE: objはcopy, moveされるとcomponentが持つポインタが壊れるため注意
-        objects.emplace_back(object["name"]);
-        Object& obj = objects.back();
+        Object& obj = createObject(object["name"].get<std::string>());
         status |= SceneStatus::ObjectAdded;
 
         if (object.contains("translation")) {
@@ -510,17 +1275,18 @@ void Scene::loadFromJson(const std::filesystem::path& filepath) {
             auto& mesh = obj.add<Mesh>();
 
             if (object["mesh"] == "Cube") {
-                mesh.meshData = &templateMeshData[static_cast<int>(MeshType::Cube)];
+                mesh.meshData = templateMeshData[static_cast<int>(MeshType::Cube)];
             } else if (object["mesh"] == "Plane") {
-                mesh.meshData = &templateMeshData[static_cast<int>(MeshType::Plane)];
+                mesh.meshData = templateMeshData[static_cast<int>(MeshType::Plane)];
             }
+            const MeshData& data = *meshData.get(mesh.meshData);
             mesh.firstIndex = 0;
-            mesh.indexCount = static_cast<uint32_t>(mesh.meshData->indices.size());
-            mesh.vertexCount = static_cast<uint32_t>(mesh.meshData->vertices.size());
-            mesh.computeLocalAABB();
+            mesh.indexCount = static_cast<uint32_t>(data.indices.size());
+            mesh.vertexCount = static_cast<uint32_t>(data.vertices.size());
+            mesh.computeLocalAABB(data);
 
             if (object.contains("material")) {
-                mesh.material = &materials[object["material"]];
+                mesh.material = jsonMaterials[object["material"].get<size_t>()];
             }
         } else if (object["type"] == "DirectionalLight") {
             if (findObject<DirectionalLight>()) {
@@ -572,10 +1338,9 @@ void Scene::loadFromJson(const std::filesystem::path& filepath) {
     if (json.contains("camera")) {
         const auto& _camera = json["camera"];
 
-        objects.emplace_back("Camera");
-        Object& obj = objects.back();
+        Object& obj = createObject("Camera");
         Camera& camera = obj.add<Camera>();
-        mainCamera = &camera;
+        mainCamera = obj.getHandle();
         isMainCameraActive = true;
         status |= SceneStatus::ObjectAdded;
 
@@ -597,3 +1362,423 @@ void Scene::loadFromJson(const std::filesystem::path& filepath) {
         }
     }
 }
+
+bool Scene::cookScenePack(const std::filesystem::path& filepath) {
+    std::ifstream jsonFile(filepath);
+    if (!jsonFile.is_open()) {
+        throw std::runtime_error("Failed to open scene file.");
+    }
+    nlohmann::json json;
+    jsonFile >> json;
+    if (!json.contains("gltf") || json["gltf"].get<std::string>().empty()) {
+        spdlog::info("Skipped cooking {} (no glTF)", filepath.string());
+        return false;
+    }
+    std::filesystem::path gltfPath = filepath.parent_path() / json["gltf"].get<std::string>();
+
+    // NOTE: 読み込みは通常と同じ経路を通し、出来上がったシーンをそのまま書き出す
+    //       テクスチャの画素だけは転送後に残らないので glTF から取る
+    context->getDevice().waitIdle();
+    clear();
+    tinygltf::Model model;
+    readGltf(gltfPath, model);
+    loadTextures(model);
+    loadMaterials(model);
+    loadNodes(model);
+
+    ScenePackWriter writer;
+
+    // パック上ではオブジェクトとマテリアルを詰めて番号を振り直す
+    std::vector<uint32_t> packObjectIndices(objects.getSlotCount(), ScenePackObject::none);
+    std::vector<uint32_t> objectIndices;
+    for (uint32_t index = 0; index < objects.getSlotCount(); index++) {
+        if (objects.isAlive(index)) {
+            packObjectIndices[index] = static_cast<uint32_t>(objectIndices.size());
+            objectIndices.push_back(index);
+        }
+    }
+    auto toPackObjectIndex = [&](uint32_t objectIndex) {
+        return objectIndex < packObjectIndices.size() ? packObjectIndices[objectIndex]
+                                                      : ScenePackObject::none;
+    };
+
+    std::vector<uint32_t> packMaterialIndices(materials.getSlotCount(), ScenePackObject::none);
+    for (uint32_t index = 0; index < materials.getSlotCount(); index++) {
+        if (!materials.isAlive(index)) {
+            continue;
+        }
+        const Material& material = materials[index];
+        packMaterialIndices[index] = writer.add(ScenePackSection::Materials, ScenePackMaterial{
+            .baseColor = material.baseColor,
+            .emissive = material.emissive,
+            .metallic = material.metallic,
+            .roughness = material.roughness,
+            .ior = material.ior,
+            .baseColorTextureIndex = material.baseColorTextureIndex,
+            .metallicRoughnessTextureIndex = material.metallicRoughnessTextureIndex,
+            .normalTextureIndex = material.normalTextureIndex,
+            .occlusionTextureIndex = material.occlusionTextureIndex,
+            .emissiveTextureIndex = material.emissiveTextureIndex,
+            .enableNormalMapping = material.enableNormalMapping ? 1u : 0u,
+            .doubleSided = material.doubleSided ? 1u : 0u,
+            .name = writer.addString(material.name),
+        });
+    }
+
+    for (uint32_t index : objectIndices) {
+        const Object& object = objects[index];
+        ScenePackObject packObject{};
+        packObject.name = writer.addString(object.getName());
+        packObject.parent = toPackObjectIndex(sceneGraph.getParent(index));
+        if (const Transform* transform = object.get<Transform>()) {
+            packObject.translation = transform->translation;
+            packObject.rotation = transform->rotation;
+            packObject.scale = transform->scale;
+        }
+        if (const Mesh* mesh = object.get<Mesh>()) {
+            packObject.hasMesh = 1;
+            if (materials.contains(mesh->material)) {
+                packObject.material = packMaterialIndices[mesh->material.index];
+            }
+            packObject.firstIndex = mesh->firstIndex;
+            packObject.indexCount = mesh->indexCount;
+            packObject.indices16 = mesh->indexType == vk::IndexType::eUint16 ? 1 : 0;
+            packObject.vertexOffset = mesh->vertexOffset;
+            packObject.vertexCount = mesh->vertexCount;
+            packObject.firstJoint = mesh->firstJoint;
+            packObject.firstMorphWeight = mesh->firstMorphWeight;
+            packObject.morphTargetCount = mesh->morphTargetCount;
+            packObject.firstLod = writer.add(ScenePackSection::MeshLods, mesh->getLods());
+            packObject.lodCount = mesh->lodCount;
+            if (mesh->clusterCount > 0) {
+                std::span<const MeshCluster> clusters{*meshData.get(mesh->meshData)->clusters};
+                packObject.firstCluster =
+                    writer.add(ScenePackSection::MeshClusters,
+                               clusters.subspan(mesh->firstCluster, mesh->clusterCount));
+                packObject.clusterCount = mesh->clusterCount;
+            }
+        }
+        writer.add(ScenePackSection::Objects, packObject);
+    }
+
+    // 頂点とインデックスは描画に使う形のまま
+    const MeshData& data = *meshData.get(sceneMeshData);
+    writer.add<VertexPNUT>(ScenePackSection::Vertices, data.vertices);
+    writer.add<uint32_t>(ScenePackSection::Indices, data.indices);
+    writer.add<uint16_t>(ScenePackSection::Indices16, data.indices16);
+    writer.add<SkinVertex>(ScenePackSection::SkinVertices, data.skinVertices);
+    writer.add(ScenePackSection::MorphRanges, data.morphTargets.getRanges());
+    writer.add(ScenePackSection::MorphDeltas, data.morphTargets.getDeltas());
+    writer.add(ScenePackSection::MorphWeights, std::as_const(morphWeights).getWeights());
+
+    // テクスチャはデコード済みの RGBA8
+    // NOTE: loadTextures() と同じく source を持つものだけを同じ順に並べる
+    std::vector<uint8_t> srgb = findSrgbTextures(model);
+    uint32_t textureIndex = 0;
+    for (size_t i = 0; i < model.textures.size(); i++) {
+        const tinygltf::Texture& texture = model.textures[i];
+        if (texture.source < 0) {
+            continue;
+        }
+        const tinygltf::Image& image = model.images[texture.source];
+        writer.add(ScenePackSection::Textures, ScenePackTexture{
+            .name = writer.addString(textures2D[textureIndex++].name),
+            .width = static_cast<uint32_t>(image.width),
+            .height = static_cast<uint32_t>(image.height),
+            .pixelOffset = writer.getSize(ScenePackSection::TexturePixels),
+            .pixelSize = image.image.size(),
+            .srgb = srgb[i],
+        });
+        writer.add<unsigned char>(ScenePackSection::TexturePixels, image.image);
+    }
+
+    // アニメーション
+    for (const AnimationClip& clip : animationPlayer.getClips()) {
+        ScenePackClip packClip{
+            .name = writer.addString(clip.name),
+            .firstTrack = writer.getCount<ScenePackTrack>(ScenePackSection::Tracks),
+        };
+        auto addTracks = [&]<typename T>(const AnimationTracks<T>& tracks,
+                                         ScenePackChannel channel) {
+            tracks.forEachTrack([&](uint32_t target, Interpolation interpolation,
+                                    std::span<const float> times, std::span<const T> values) {
+                // NOTE: ウェイトの対象はオブジェクトではないので振り直さない
+                if (channel != ScenePackChannel::Weights) {
+                    target = toPackObjectIndex(target);
+                }
+                if (target == ScenePackObject::none) {
+                    return;
+                }
+                std::span<const float> floatValues{reinterpret_cast<const float*>(values.data()),
+                                                   values.size_bytes() / sizeof(float)};
+                writer.add(ScenePackSection::Tracks, ScenePackTrack{
+                    .channel = channel,
+                    .target = target,
+                    .interpolation = static_cast<uint32_t>(interpolation),
+                    .firstTime = writer.add(ScenePackSection::TrackTimes, times),
+                    .timeCount = static_cast<uint32_t>(times.size()),
+                    .firstValue = writer.add(ScenePackSection::TrackValues, floatValues),
+                    .valueCount = static_cast<uint32_t>(floatValues.size()),
+                });
+                packClip.trackCount++;
+            });
+        };
+        addTracks(clip.translations, ScenePackChannel::Translation);
+        addTracks(clip.rotations, ScenePackChannel::Rotation);
+        addTracks(clip.scales, ScenePackChannel::Scale);
+        addTracks(clip.weights, ScenePackChannel::Weights);
+        writer.add(ScenePackSection::Clips, packClip);
+    }
+
+    // スキン
+    // NOTE: 読み込み時に同じ順で追加すれば、メッシュの firstJoint はそのまま使える
+    jointPalette.forEachInstance([&](uint32_t meshObject, std::span<const uint32_t> joints,
+                                     std::span<const glm::mat4> inverseBinds) {
+        ScenePackSkin skin{
+            .meshObject = toPackObjectIndex(meshObject),
+            .firstJoint = writer.getCount<uint32_t>(ScenePackSection::SkinJoints),
+            .jointCount = static_cast<uint32_t>(joints.size()),
+        };
+        for (uint32_t joint : joints) {
+            writer.add(ScenePackSection::SkinJoints, toPackObjectIndex(joint));
+        }
+        writer.add(ScenePackSection::SkinInverseBinds, inverseBinds);
+        writer.add(ScenePackSection::Skins, skin);
+    });
+
+    std::filesystem::path packPath = getScenePackPath(filepath);
+    if (!writer.write(packPath)) {
+        spdlog::error("Failed to write scene pack: {}", packPath.string());
+        return false;
+    }
+    spdlog::info("Cooked scene pack: {}", packPath.string());
+    return true;
+}
+
+// [first, first + count) が size 個の配列に収まるか
+bool isRangeValid(uint64_t first, uint64_t count, size_t size) {
+    return first <= size && count <= size - first;
+}
+
+bool Scene::loadFromScenePack(const std::filesystem::path& filepath) {
+    ScenePackFile pack;
+    if (!pack.open(filepath)) {
+        spdlog::warn("Invalid scene pack: {}", filepath.string());
+        return false;
+    }
+    context->getDevice().waitIdle();
+    clear();
+
+    // テクスチャ
+    std::span<const unsigned char> pixels =
+        pack.get<unsigned char>(ScenePackSection::TexturePixels);
+    std::vector<Texture2DSource> textureSources;
+    for (const ScenePackTexture& texture : pack.get<ScenePackTexture>(ScenePackSection::Textures)) {
+        if (!isRangeValid(texture.pixelOffset, texture.pixelSize, pixels.size()) ||
+            texture.pixelSize < uint64_t{texture.width} * texture.height * 4) {
+            spdlog::warn("Invalid texture in scene pack: {}", filepath.string());
+            return false;
+        }
+        textureSources.push_back({std::string{pack.getString(texture.name)}, texture.width,
+                                  texture.height,
+                                  pixels.subspan(texture.pixelOffset, texture.pixelSize),
+                                  texture.srgb != 0});
+    }
+    createTextures2D(textureSources);
+
+    // マテリアル
+    gltfMaterials.clear();
+    for (const ScenePackMaterial& material :
+         pack.get<ScenePackMaterial>(ScenePackSection::Materials)) {
+        gltfMaterials.push_back(materials.emplace(Material{
+            .baseColor = material.baseColor,
+            .emissive = material.emissive,
+            .metallic = material.metallic,
+            .roughness = material.roughness,
+            .ior = material.ior,
+            .baseColorTextureIndex = material.baseColorTextureIndex,
+            .metallicRoughnessTextureIndex = material.metallicRoughnessTextureIndex,
+            .normalTextureIndex = material.normalTextureIndex,
+            .occlusionTextureIndex = material.occlusionTextureIndex,
+            .emissiveTextureIndex = material.emissiveTextureIndex,
+            .enableNormalMapping = material.enableNormalMapping != 0,
+            .doubleSided = material.doubleSided != 0,
+            .name = std::string{pack.getString(material.name)},
+        }));
+    }
+
+    // 頂点とインデックス
+    MeshData& data = *meshData.get(sceneMeshData);
+    auto assign = [](auto& vector, auto values) { vector.assign(values.begin(), values.end()); };
+    assign(data.vertices, pack.get<VertexPNUT>(ScenePackSection::Vertices));
+    assign(data.indices, pack.get<uint32_t>(ScenePackSection::Indices));
+    assign(data.indices16, pack.get<uint16_t>(ScenePackSection::Indices16));
+    assign(data.skinVertices, pack.get<SkinVertex>(ScenePackSection::SkinVertices));
+    data.morphTargets.assign(pack.get<glm::uvec2>(ScenePackSection::MorphRanges),
+                             pack.get<MorphDelta>(ScenePackSection::MorphDeltas));
+    std::span<const float> weights = pack.get<float>(ScenePackSection::MorphWeights);
+    if (!weights.empty()) {
+        morphWeights.addInstance(weights);
+    }
+
+    std::span<const MeshLod> packLods = pack.get<MeshLod>(ScenePackSection::MeshLods);
+    std::span<const MeshCluster> packClusters =
+        pack.get<MeshCluster>(ScenePackSection::MeshClusters);
+    data.clusters =
+        std::make_shared<std::vector<MeshCluster>>(packClusters.begin(), packClusters.end());
+
+    // オブジェクト
+    // NOTE: 全てのオブジェクトが Transform を持つ (glTF のノードとプリミティブ)
+    std::span<const ScenePackObject> packObjects =
+        pack.get<ScenePackObject>(ScenePackSection::Objects);
+    std::vector<uint32_t> objectIndices;
+    objectIndices.reserve(packObjects.size());
+    for (const ScenePackObject& packObject : packObjects) {
+        Object& object = createObject(pack.getString(packObject.name));
+        objectIndices.push_back(object.getIndex());
+
+        Transform& transform = object.add<Transform>();
+        transform.translation = packObject.translation;
+        transform.rotation = packObject.rotation;
+        transform.scale = packObject.scale;
+
+        if (packObject.hasMesh) {
+            size_t indexSize = packObject.indices16 ? data.indices16.size() : data.indices.size();
+            bool valid =
+                isRangeValid(packObject.vertexOffset, packObject.vertexCount,
+                             data.vertices.size()) &&
+                isRangeValid(packObject.firstIndex, packObject.indexCount, indexSize) &&
+                packObject.lodCount <= maxMeshLodCount &&
+                isRangeValid(packObject.firstLod, packObject.lodCount, packLods.size());
+            for (uint32_t level = 0; valid && level < packObject.lodCount; level++) {
+                const MeshLod& lod = packLods[packObject.firstLod + level];
+                valid = isRangeValid(lod.firstIndex, lod.indexCount, indexSize);
+            }
+            valid = valid && isRangeValid(packObject.firstCluster, packObject.clusterCount,
+                                          packClusters.size());
+            for (uint32_t i = 0; valid && i < packObject.clusterCount; i++) {
+                const MeshCluster& cluster = packClusters[packObject.firstCluster + i];
+                valid = isRangeValid(cluster.firstIndex, cluster.indexCount, packObject.indexCount);
+            }
+            if (!valid) {
+                spdlog::warn("Invalid mesh in scene pack: {}", filepath.string());
+                return false;
+            }
+            Mesh& mesh = object.add<Mesh>();
+            mesh.meshData = sceneMeshData;
+            if (packObject.material < gltfMaterials.size()) {
+                mesh.material = gltfMaterials[packObject.material];
+            }
+            mesh.firstIndex = packObject.firstIndex;
+            mesh.indexCount = packObject.indexCount;
+            mesh.indexType = packObject.indices16 ? vk::IndexType::eUint16 : vk::IndexType::eUint32;
+            mesh.vertexOffset = packObject.vertexOffset;
+            mesh.vertexCount = packObject.vertexCount;
+            mesh.firstJoint = packObject.firstJoint;
+            mesh.firstMorphWeight = packObject.firstMorphWeight;
+            mesh.morphTargetCount = packObject.morphTargetCount;
+            std::copy_n(packLods.begin() + packObject.firstLod, packObject.lodCount,
+                        mesh.lods.begin());
+            mesh.lodCount = packObject.lodCount;
+            mesh.firstCluster = packObject.firstCluster;
+            mesh.clusterCount = packObject.clusterCount;
+            mesh.computeLocalAABB(data);
+        }
+    }
+    auto toObjectIndex = [&](uint32_t packObjectIndex) {
+        return packObjectIndex < objectIndices.size() ? objectIndices[packObjectIndex]
+                                                      : SceneGraph::nullIndex;
+    };
+    for (size_t i = 0; i < packObjects.size(); i++) {
+        if (packObjects[i].parent != ScenePackObject::none) {
+            sceneGraph.setParent(objectIndices[i], toObjectIndex(packObjects[i].parent));
+        }
+    }
+
+    // アニメーション
+    std::span<const ScenePackTrack> tracks = pack.get<ScenePackTrack>(ScenePackSection::Tracks);
+    std::span<const float> times = pack.get<float>(ScenePackSection::TrackTimes);
+    std::span<const float> values = pack.get<float>(ScenePackSection::TrackValues);
+    for (const ScenePackClip& packClip : pack.get<ScenePackClip>(ScenePackSection::Clips)) {
+        if (!isRangeValid(packClip.firstTrack, packClip.trackCount, tracks.size())) {
+            spdlog::warn("Invalid animation in scene pack: {}", filepath.string());
+            return false;
+        }
+        AnimationClip clip;
+        clip.name = pack.getString(packClip.name);
+        for (const ScenePackTrack& track :
+             tracks.subspan(packClip.firstTrack, packClip.trackCount)) {
+            if (track.timeCount == 0 ||
+                !isRangeValid(track.firstTime, track.timeCount, times.size()) ||
+                !isRangeValid(track.firstValue, track.valueCount, values.size())) {
+                spdlog::warn("Invalid animation in scene pack: {}", filepath.string());
+                return false;
+            }
+            std::span<const float> trackTimes = times.subspan(track.firstTime, track.timeCount);
+            const float* trackValues = &values[track.firstValue];
+            auto interpolation = static_cast<Interpolation>(track.interpolation);
+            size_t valuesPerKey = interpolation == Interpolation::CubicSpline ? 3 : 1;
+            auto addTrack = [&]<typename T>(AnimationTracks<T>& animationTracks, uint32_t target) {
+                std::span<const T> typedValues{reinterpret_cast<const T*>(trackValues),
+                                               track.valueCount * sizeof(float) / sizeof(T)};
+                if (typedValues.size() != trackTimes.size() * valuesPerKey) {
+                    return false;
+                }
+                animationTracks.add(target, interpolation, trackTimes, typedValues);
+                return true;
+            };
+            bool added = false;
+            switch (track.channel) {
+                case ScenePackChannel::Translation:
+                    added = addTrack(clip.translations, toObjectIndex(track.target));
+                    break;
+                case ScenePackChannel::Rotation:
+                    added = addTrack(clip.rotations, toObjectIndex(track.target));
+                    break;
+                case ScenePackChannel::Scale:
+                    added = addTrack(clip.scales, toObjectIndex(track.target));
+                    break;
+                case ScenePackChannel::Weights:
+                    added = addTrack(clip.weights, track.target);
+                    break;
+            }
+            if (!added) {
+                spdlog::warn("Invalid animation in scene pack: {}", filepath.string());
+                return false;
+            }
+        }
+        animationPlayer.addClip(std::move(clip));
+    }
+    animationLodSourcesDirty = true;
+
+    // スキン
+    std::span<const uint32_t> joints = pack.get<uint32_t>(ScenePackSection::SkinJoints);
+    std::span<const glm::mat4> inverseBinds =
+        pack.get<glm::mat4>(ScenePackSection::SkinInverseBinds);
+    std::vector<uint32_t> jointObjectIndices;
+    for (const ScenePackSkin& skin : pack.get<ScenePackSkin>(ScenePackSection::Skins)) {
+        if (!isRangeValid(skin.firstJoint, skin.jointCount, joints.size()) ||
+            !isRangeValid(skin.firstJoint, skin.jointCount, inverseBinds.size())) {
+            spdlog::warn("Invalid skin in scene pack: {}", filepath.string());
+            return false;
+        }
+        uint32_t meshObject = toObjectIndex(skin.meshObject);
+        if (meshObject == SceneGraph::nullIndex || !objects[meshObject].has<Mesh>()) {
+            spdlog::warn("Invalid skin in scene pack: {}", filepath.string());
+            return false;
+        }
+        jointObjectIndices.clear();
+        for (uint32_t joint : joints.subspan(skin.firstJoint, skin.jointCount)) {
+            jointObjectIndices.push_back(toObjectIndex(joint));
+        }
+        addSkin(meshObject, jointObjectIndices,
+                inverseBinds.subspan(skin.firstJoint, skin.jointCount));
+    }
+
+    data.createBuffers(*context);
+    spdlog::info("Loaded scene pack: {}", filepath.string());
+    spdlog::info("  Texture: {}", textures2D.size());
+    spdlog::info("  Material: {}", materials.size());
+    spdlog::info("  Node: {}", objects.size());
+    return true;
+}
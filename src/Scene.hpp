@@ -1,5 +1,14 @@
 #pragma once
 #include <tiny_gltf.h>
+#include <array>
+#include <span>
+
+#include "Animation.hpp"
+#include "BoundsTree.hpp"
+#include "ChangeJournal.hpp"
+#include "ComponentPool.hpp"
+#include "NameRegistry.hpp"
+#include "SceneGraph.hpp"
 #include "Object.hpp"
 #include "reactive/Scene/Camera.hpp"
 
@@ -7,92 +16,279 @@ class Scene {
     friend struct Camera;
 
 public:
-    void init(const rv::Context& _context);
+    void init(const rv::Context& _context, JobSystem& _jobSystem);
 
-    Object& addObject(const std::string& name);
+    // GPU を使わない部分だけを初期化する (テンプレートのメッシュデータは作らない)
+    // NOTE: オブジェクトの追加・削除など、シーンの構造だけをテストで扱うときに使う
+    void init(JobSystem& _jobSystem);
 
+    // 名前が重複する場合は接尾辞を付けて一意にする
+    Object& addObject(std::string_view name);
+
+    // オブジェクトを子孫ごと削除する
+    // 空いたスロットは次に追加されるオブジェクトが再利用するため、GPUバッファも伸び続けない
+    // NOTE: 削除したスロットは removedObjectIndices に積まれ、Renderer がバッファ上で無効化する
+    bool removeObject(ObjectHandle handle);
+
+    // T を持つオブジェクトのインデックス一覧
+    // NOTE: プールの密な配列をそのまま返すため、コンポーネントの追加・削除に合わせて
+    //       常に最新に保たれており、オブジェクト全体を走査する必要はない
+    //       追加・削除を行うと並び順が変わり、span も無効になる
     template <typename T>
-    Object* findObject() {
-        for (auto& object : objects) {
-            if (object.get<T>()) {
-                return &object;
-            }
+    std::span<const uint32_t> queryObjects() const {
+        const ComponentPool<T>* pool = getPool<T>();
+        if (!pool) {
+            return {};
         }
-        return nullptr;
+        return pool->getObjectIndices();
+    }
+
+    template <typename T>
+    Object* findObject() {
+        std::span<const uint32_t> indices = queryObjects<T>();
+        return indices.empty() ? nullptr : &objects[indices.front()];
     }
 
     template <typename T>
     const Object* findObject() const {
-        for (auto& object : objects) {
-            if (object.get<T>()) {
-                return &object;
-            }
+        std::span<const uint32_t> indices = queryObjects<T>();
+        return indices.empty() ? nullptr : &objects[indices.front()];
+    }
+
+    // T のコンポーネントを一つ返す (ライトなどシーンに一つだけ置くもの向け)
+    template <typename T>
+    T* findComponent() {
+        ComponentPool<T>* pool = getPool<T>();
+        if (!pool || pool->size() == 0) {
+            return nullptr;
         }
-        return nullptr;
+        return &pool->getComponents().front();
+    }
+
+    Object* findObject(std::string_view name) {
+        return objects.get(objectNames.find(name));
     }
 
-    const Object* findObject(const std::string& name) const;
+    const Object* findObject(std::string_view name) const {
+        return objects.get(objectNames.find(name));
+    }
 
     template <typename T>
     uint32_t countObjects() const {
-        uint32_t count = 0;
-        for (auto& object : objects) {
-            if (object.get<T>()) {
-                count++;
+        return static_cast<uint32_t>(queryObjects<T>().size());
+    }
+
+    template <typename T, typename... Args>
+    T& addComponent(Object& object, Args&&... args) {
+        ComponentPool<T>& pool = getOrCreatePool<T>();
+        if (object.has<T>()) {
+            spdlog::warn("{} is already added.", typeid(T).name());
+            return pool.getUnchecked(object.getIndex());
+        }
+        T& component = pool.emplace(object.getIndex(), std::forward<Args>(args)...);
+        component.object = object.getHandle();
+        object.componentMask |= Components::bit<T>;
+        if constexpr (std::is_same_v<T, Transform>) {
+            sceneGraph.add(object.getIndex());
+        }
+        changeJournal.record(object.getIndex(), componentID<T>, ChangeField::All);
+        return component;
+    }
+
+    template <typename T>
+    void removeComponent(Object& object) {
+        if (!object.has<T>()) {
+            return;
+        }
+        uint32_t index = object.getIndex();
+        detachComponent(index, componentID<T>);
+        getPool<T>()->remove(index);
+        object.componentMask &= ~Components::bit<T>;
+
+        // ワールド行列が単位行列に戻るので、メッシュのバッファとAABBを更新させる
+        if constexpr (std::is_same_v<T, Transform>) {
+            if (const Mesh* mesh = object.get<Mesh>()) {
+                markChanged(*mesh, ChangeField::Transform);
             }
         }
-        return count;
     }
 
-    void update(float dt) {
-        if (!isMainCameraAvailable()) {
-            defaultCamera.update(*this, dt);
+    // コンポーネントの変更を記録する
+    // NOTE: ワーカースレッドから呼ばれる update() の中でも使える
+    template <typename T>
+    void markChanged(const T& component, ChangeFlags fields) {
+        // NOTE: デフォルトカメラのようにシーンに属さないものは記録しない
+        if (objects.contains(component.object)) {
+            changeJournal.record(component.object.index, componentID<T>, fields);
         }
+    }
 
-        updatedObjectIndices.clear();
+    template <typename T>
+    ComponentPool<T>* getPool() {
+        return static_cast<ComponentPool<T>*>(componentPools[componentID<T>].get());
+    }
+
+    template <typename T>
+    const ComponentPool<T>* getPool() const {
+        return static_cast<const ComponentPool<T>*>(componentPools[componentID<T>].get());
+    }
 
-        for (size_t index = 0; index < objects.size(); index++) {
-            auto& object = objects[index];
-            bool changed = false;
-            for (auto& comp : object.getComponents() | std::views::values) {
-                comp->update(*this, dt);
-                changed |= comp->changed;
-                comp->changed = false;  // reset
+    // 指定した全てのコンポーネントを持つオブジェクトを走査する
+    template <typename T, typename... Others>
+    ComponentView<T, Others...> view() {
+        return {objects, getPool<T>(), {getPool<Others>()...}};
+    }
+
+    std::vector<Component*> getComponents(uint32_t objectIndex) const {
+        std::vector<Component*> components;
+        for (auto& pool : componentPools) {
+            if (!pool) {
+                continue;
             }
-            if (changed) {
-                updatedObjectIndices.push_back(static_cast<uint32_t>(index));
+            if (Component* component = pool->getComponent(objectIndex)) {
+                components.push_back(component);
             }
         }
+        return components;
+    }
 
-        computeAABB();
+    // ウィンドウの入力を読む更新
+    // NOTE: update() の前にメインスレッドで呼ぶ
+    void updateMainThread(float dt) {
+        // 前のフレームの記録を捨てる
+        // NOTE: エディタなどで update() より前に記録された変更はこのフレームに含まれる
+        changeJournal.clearRecords();
+
+        if (!isMainCameraAvailable()) {
+            defaultCamera.update(*this, dt);
+        }
+        for (auto& pool : componentPools) {
+            if (pool && pool->updatesOnMainThread()) {
+                pool->update(*this, *jobSystem, dt);
+            }
+        }
+    }
+
+    // シミュレーションの更新
+    // NOTE: 描画と重ねるためワーカースレッドから呼ばれる
+    //       実行中はメインスレッドからシーンに触れないこと
+    void update(float dt) {
+        updateAnimation(dt);
+
+        // 型ごとに密に並んだコンポーネントをまとめて更新する
+        // プールの中はチャンクに分けて並列に更新し、変更はスレッドごとの記録に集める
+        // NOTE: 更新順はコンポーネントIDの順で固定される
+        for (auto& pool : componentPools) {
+            if (pool && !pool->updatesOnMainThread()) {
+                pool->update(*this, *jobSystem, dt);
+            }
+        }
+        changeJournal.flush();
+
+        updateTransforms();
+        changeJournal.flush();
+
+        updateBakedAnimationInstances();
+        updateJointPalette();
+        recordGeometryChanges();
+        changeJournal.flush();
+
+        updateAABB();
     }
 
     void loadFromGltf(const std::filesystem::path& filepath);
 
     void loadTextures(tinygltf::Model& gltfModel);
 
+    // glTF のテクスチャごとに、色 (sRGB) として読むか
+    // NOTE: glTF ではベースカラーとエミッシブだけが sRGB で、それ以外はリニアな値を持つ
+    //       両方から使われるテクスチャは、見た目への影響が大きい色の方に合わせる
+    static std::vector<uint8_t> findSrgbTextures(const tinygltf::Model& gltfModel);
+
+    // 1x1 まで半分ずつ縮めたミップマップの段数
+    static uint32_t computeMipLevelCount(uint32_t width, uint32_t height);
+
     void loadMaterials(tinygltf::Model& gltfModel);
 
+    // プリミティブの頂点・インデックスの範囲をメッシュデータ上に確保し、
+    // モーフターゲットとマテリアルを設定する
+    // NOTE: 範囲はアクセサの要素数から決まるので、中身は convertMesh() で後から書き込む
     void loadMesh(tinygltf::Model& gltfModel, tinygltf::Primitive& gltfPrimitive, Mesh& mesh);
 
+    // loadMesh() で確保した範囲に頂点・スキン・インデックスを変換して書き込む
+    // NOTE: 書き込む範囲はメッシュごとに重ならないため、別々のメッシュなら並列に呼べる
+    void convertMesh(const tinygltf::Model& gltfModel,
+                     const tinygltf::Primitive& gltfPrimitive,
+                     Mesh& mesh);
+
     void loadNodes(tinygltf::Model& gltfModel);
 
+    // nodeMorphWeights はノードごとの MorphWeights 上の先頭位置 (-1 ならモーフターゲットを持たない)
+    void loadAnimations(tinygltf::Model& gltfModel,
+                        std::span<const uint32_t> nodeObjectIndices,
+                        std::span<const int> nodeMorphWeights);
+
+    // skinnedMeshes は (glTF のスキンインデックス, メッシュを持つオブジェクト) の組
+    void loadSkins(tinygltf::Model& gltfModel,
+                   std::span<const uint32_t> nodeObjectIndices,
+                   std::span<const std::pair<int, uint32_t>> skinnedMeshes);
+
+    // メッシュの関節をパレットに追加し、関節ごとのAABBを求めておく
+    void addSkin(uint32_t meshObjectIndex,
+                 std::span<const uint32_t> jointObjectIndices,
+                 std::span<const glm::mat4> inverseBindMatrices);
+
+    // NOTE: 焼いたシーンパックが glTF より新しければ、glTF の代わりにそれを読み込む
     void loadFromJson(const std::filesystem::path& filepath);
 
-    std::vector<Object>& getObjects() {
+    // シーンの JSON が参照する glTF を読み込み、シーンパックに焼いて書き出す
+    // glTF を参照しないシーンは何もせずに false を返す
+    bool cookScenePack(const std::filesystem::path& filepath);
+
+    // 焼いたシーンパックを読み込む (壊れているか古いバージョンなら false を返す)
+    // NOTE: デコードや変換はせず、マップしたファイルから GPU に転送するだけにする
+    bool loadFromScenePack(const std::filesystem::path& filepath);
+
+    // シーンの JSON に対応するシーンパックのパス
+    static std::filesystem::path getScenePackPath(const std::filesystem::path& filepath) {
+        return std::filesystem::path{filepath}.replace_extension(".pack");
+    }
+
+    // シーンパックが無いか、焼いた後に glTF かそれが参照するバッファ・画像が更新されたか
+    // NOTE: 参照を知るために glTF の JSON だけを読み、バッファや画像の中身は読まない
+    static bool isScenePackStale(const std::filesystem::path& packPath,
+                                 const std::filesystem::path& gltfPath);
+
+    JobSystem& getJobSystem() {
+        return *jobSystem;
+    }
+
+    SlotMap<Object>& getObjects() {
         return objects;
     }
 
-    std::vector<uint32_t>& getUpdatedObjectIndices() {
-        return updatedObjectIndices;
+    Object* getObject(ObjectHandle handle) {
+        return objects.get(handle);
     }
 
-    Camera* getMainCamera() const {
-        return mainCamera;
+    // このフレームで変更のあったコンポーネントの記録
+    const ChangeJournal& getChangeJournal() const {
+        return changeJournal;
+    }
+
+    // 前回の描画以降に削除された (またはメッシュを外された) オブジェクトのインデックス
+    // NOTE: ObjectDataBuffer が読み出した時点で空にする
+    std::vector<uint32_t>& getRemovedObjectIndices() {
+        return removedObjectIndices;
+    }
+
+    Camera* getMainCamera() {
+        Object* object = objects.get(mainCamera);
+        return object ? object->get<Camera>() : nullptr;
     }
 
     bool isMainCameraAvailable() const {
-        return mainCamera && isMainCameraActive;
+        return objects.contains(mainCamera) && isMainCameraActive;
     }
 
     Camera& getDefaultCamera() {
@@ -100,19 +296,36 @@ public:
     }
 
     void setMainCamera(Camera& camera) {
-        mainCamera = &camera;
+        mainCamera = camera.object;
         isMainCameraActive = true;
     }
 
     const MeshData& getCubeMesh() {
-        return templateMeshData[static_cast<int>(MeshType::Cube)];
+        return *meshData.get(templateMeshData[static_cast<int>(MeshType::Cube)]);
     }
 
-    const MeshData& getMeshData() {
-        return meshData;
+    MeshData* getMeshData(MeshDataHandle handle) {
+        return meshData.get(handle);
     }
 
-    const std::vector<Material>& getMaterials() {
+    // 読み込んだシーンのメッシュが共有するメッシュデータ
+    MeshDataHandle getSceneMeshData() const {
+        return sceneMeshData;
+    }
+
+    const MeshData* getMeshData(MeshDataHandle handle) const {
+        return meshData.get(handle);
+    }
+
+    Material* getMaterial(MaterialHandle handle) {
+        return materials.get(handle);
+    }
+
+    const Material* getMaterial(MaterialHandle handle) const {
+        return materials.get(handle);
+    }
+
+    const SlotMap<Material>& getMaterials() {
         return materials;
     }
 
@@ -134,18 +347,181 @@ public:
         status |= SceneStatus::TextureCubeAdded;
     }
 
-    void computeAABB() {
-        for (auto& obj : objects) {
-            if (const Mesh* mesh = obj.get<Mesh>()) {
-                aabb = rv::AABB::merge(aabb, mesh->getWorldAABB());
+    // 再生中のクリップをサンプリングし、対象の Transform とモーフターゲットのウェイトに書き込む
+    // NOTE: トラックは型ごとに密に並んでいるので、チャンクに分けて並列にサンプリングする
+    void updateAnimation(float dt);
+
+    AnimationPlayer& getAnimationPlayer() {
+        return animationPlayer;
+    }
+
+    // 前フレームのワールドAABBとカメラから、アニメーションの対象ごとに今フレーム更新するかを決める
+    // 視錐台の外や画面上で小さいものは更新を間引き、止める
+    void updateAnimationLod();
+
+    inline static AnimationLodSettings animationLodSettings{};
+
+    // 関節が動いたフレームだけ、全スキンメッシュの関節行列をまとめて計算し直す
+    void updateJointPalette() {
+        if (jointPalette.empty() ||
+            !changeJournal.isDirty(componentID<Transform>, ChangeField::Transform)) {
+            return;
+        }
+        jointPalette.update([this](uint32_t objectIndex) -> const glm::mat4& {
+            return getWorldMatrix(objectIndex);
+        });
+        updateSkinnedAABBs();
+    }
+
+    // スキンメッシュのローカルAABBを、関節ごとのAABBを関節行列で動かしたものの和にする
+    // NOTE: 頂点は関節行列で動かした位置の重み付き平均なので、この和からはみ出さない
+    void updateSkinnedAABBs();
+
+    JointPalette& getJointPalette() {
+        return jointPalette;
+    }
+
+    MorphWeights& getMorphWeights() {
+        return morphWeights;
+    }
+
+    // 再生中のクリップのうち object を対象とするトラックを焼き込み、GPU で再生させる
+    // 以降 object は CPU ではサンプリングされず、自身と子孫のメッシュの行列は
+    // BakedAnimationPass が毎フレーム書き込む
+    // 焼き込んだトラックを返す (再生中のクリップに object のトラックが無ければ invalidTrack)
+    uint32_t bakeAnimation(Object& object, float frameRate = 30.0f);
+
+    // 焼き込んだトラックで object を再生させる (同じトラックを時刻をずらして何体にも使える)
+    // NOTE: 子孫のメッシュは object に固定されて一緒に動く。子孫自身のアニメーションは再生しない
+    void addBakedAnimationInstance(Object& object, uint32_t track, float timeOffset);
+
+    // 動いたアンカーやメッシュのインスタンスの行列を計算し直す
+    // NOTE: updateTransforms() で伝播させた後に呼ぶ
+    void updateBakedAnimationInstances();
+
+    // GPU で形が変わるメッシュの形状の変更を記録する
+    // (関節やウェイトが変わった変形メッシュと、焼き込んだアニメーションで動くメッシュ)
+    // NOTE: シャドウマップはこの記録を見て描き直される
+    void recordGeometryChanges();
+
+    const BakedAnimation& getBakedAnimation() const {
+        return bakedAnimation;
+    }
+
+    BakedAnimation& getBakedAnimation() {
+        return bakedAnimation;
+    }
+
+    std::span<const BakedAnimationInstance> getBakedAnimationInstances() const {
+        return bakedAnimationInstances;
+    }
+
+    // 前回の読み出しからインスタンスに変更があったか (読み出すとリセットされる)
+    bool consumeBakedAnimationInstancesDirty() {
+        bool wasDirty = bakedAnimationInstancesDirty;
+        bakedAnimationInstancesDirty = false;
+        return wasDirty;
+    }
+
+    // NOTE: 精度を保つため double で積算し、使う側で float にする
+    double getBakedAnimationTime() const {
+        return bakedAnimationTime;
+    }
+
+    // 変更のあった Transform のローカル行列をシーングラフに渡し、ワールド行列を伝播する
+    // 親が動いてワールド行列が変わった子孫も変更として記録する
+    void updateTransforms() {
+        for (const ChangeRecord& record : changeJournal.getRecords()) {
+            if (record.componentID != componentID<Transform> ||
+                !(record.fields & ChangeField::Transform)) {
+                continue;
             }
+            if (const Transform* transform = objects[record.objectIndex].get<Transform>()) {
+                sceneGraph.setLocalMatrix(record.objectIndex, transform->computeTransformMatrix());
+            }
+        }
+
+        worldChangedObjectIndices.clear();
+        sceneGraph.update(worldChangedObjectIndices);
+        for (uint32_t index : worldChangedObjectIndices) {
+            changeJournal.record(index, componentID<Transform>, ChangeField::Transform);
+        }
+    }
+
+    // 親を付け替える (parent が nullptr ならルートにする)
+    // どちらも Transform を持っている必要があり、循環する場合は失敗する
+    bool setParent(Object& child, const Object* parent) {
+        uint32_t parentIndex = parent ? parent->getIndex() : SceneGraph::nullIndex;
+        if (!sceneGraph.setParent(child.getIndex(), parentIndex)) {
+            spdlog::warn("Failed to set parent of {}.", child.getName());
+            return false;
         }
+        return true;
+    }
+
+    Object* getParent(const Object& object) {
+        uint32_t parentIndex = sceneGraph.getParent(object.getIndex());
+        return parentIndex == SceneGraph::nullIndex ? nullptr : &objects[parentIndex];
+    }
+
+    // NOTE: Transform を持たないオブジェクトは単位行列
+    const glm::mat4& getWorldMatrix(uint32_t objectIndex) const {
+        return sceneGraph.getWorldMatrix(objectIndex);
+    }
+
+    const glm::mat4& getNormalMatrix(uint32_t objectIndex) const {
+        return sceneGraph.getNormalMatrix(objectIndex);
+    }
+
+    // NOTE: updateAABB() で変更のあったメッシュだけ計算し直したものを返す
+    const rv::AABB& getWorldAABB(uint32_t objectIndex) const {
+        return worldAABBs[objectIndex];
+    }
+
+    const SceneGraph& getSceneGraph() const {
+        return sceneGraph;
+    }
+
+    // ワールド行列か形状が変わったメッシュだけ木の葉を更新し、根のAABBをシーンの範囲とする
+    // NOTE: 何も動いていなければ何もしない
+    void updateAABB() {
+        uint32_t lastIndex = SceneGraph::nullIndex;
+        for (const ChangeRecord& record : changeJournal.getRecords()) {
+            // NOTE: 記録はオブジェクト順に並んでいるので、同じオブジェクトは続けて現れる
+            uint32_t index = record.objectIndex;
+            if (index == lastIndex ||
+                !(record.fields & (ChangeFlags{ChangeField::Transform} | ChangeField::Geometry))) {
+                continue;
+            }
+            const Mesh* mesh = objects[index].get<Mesh>();
+            if (!mesh) {
+                continue;
+            }
+            lastIndex = index;
+
+            if (index >= boundsLeaves.size()) {
+                boundsLeaves.resize(index + 1, BoundsTree::nullNode);
+                worldAABBs.resize(index + 1);
+            }
+            const rv::AABB& worldAABB = worldAABBs[index] = computeWorldAABB(index, *mesh);
+            uint32_t& leaf = boundsLeaves[index];
+            if (leaf == BoundsTree::nullNode) {
+                leaf = boundsTree.insert(worldAABB, index);
+            } else {
+                boundsTree.update(leaf, worldAABB);
+            }
+        }
+        aabb = boundsTree.getRootAABB();
     }
 
     rv::AABB getAABB() const {
         return aabb;
     }
 
+    const BoundsTree& getBoundsTree() const {
+        return boundsTree;
+    }
+
     SceneStatusFlags getStatus() const {
         return status;
     }
@@ -156,51 +532,207 @@ public:
 
     void clear() {
         objects.clear();
-        objects.reserve(maxObjectCount);
+        objects.compact();
+        objectNames.clear();
+        changeJournal.clear();
+        removedObjectIndices.clear();
+        sceneGraph.clear();
+        animationPlayer.clear();
+        animationLodTargets.clear();
+        animationLodSourcesDirty = true;
+        jointPalette.clear();
+        jointAABBs.clear();
+        morphWeights.clear();
+        bakedAnimation.clear();
+        bakedAnimationInstances.clear();
+        bakedAnimationAnchors.clear();
+        bakedInstanceOfObject.clear();
+        bakedAnimationInstancesDirty = true;
+        bakedAnimationTime = 0.0;
+        boundsTree.clear();
+        boundsLeaves.clear();
+        worldAABBs.clear();
+        aabb = {};
+        for (auto& pool : componentPools) {
+            if (pool) {
+                pool->clear();
+            }
+        }
 
-        mainCamera = nullptr;
+        mainCamera = {};
 
-        meshData = MeshData{};
+        // テンプレートは残し、読み込んだメッシュデータだけを破棄する
+        meshData.erase(sceneMeshData);
+        sceneMeshData = meshData.emplace();
         materials.clear();
+        materials.compact();
         textures2D.clear();
         texturesCube.clear();
         status = SceneStatus::Cleared;
     }
 
 private:
+    void readGltf(const std::filesystem::path& filepath, tinygltf::Model& model);
+
+    struct Texture2DSource {
+        std::string name;
+        uint32_t width;
+        uint32_t height;
+        std::span<const unsigned char> pixels;  // RGBA8
+        bool srgb;                              // 色 (ベースカラー、エミッシブ) のテクスチャ
+    };
+
+    // 2Dテクスチャをまとめて作って転送し、ミップマップを作る
+    // NOTE: ステージングバッファへのコピーは並列に行い、転送は一度の oneTimeSubmit で済ませる
+    //       ミップマップは転送と同じコマンドバッファで、GPU が縮小コピーを繰り返して作る
+    void createTextures2D(std::span<const Texture2DSource> sources);
+
+    Object& createObject(std::string_view name) {
+        ObjectHandle handle = objects.emplace(*this);
+        Object& object = objects[handle.index];
+        object.handle = handle;
+        object.name = objectNames.add(name, handle);
+        return object;
+    }
+
+    // コンポーネントをプールから外す前に、シーン側で持っている情報を片付ける
+    void detachComponent(uint32_t index, uint32_t id) {
+        if (id == componentID<Transform>) {
+            sceneGraph.remove(index);
+            animationPlayer.removeTarget(index);
+            jointPalette.removeObject(index);
+            removeBakedAnimationInstances(index, true);
+            animationLodSourcesDirty = true;
+        } else if (id == componentID<Mesh>) {
+            if (index < boundsLeaves.size() && boundsLeaves[index] != BoundsTree::nullNode) {
+                boundsTree.remove(boundsLeaves[index]);
+                boundsLeaves[index] = BoundsTree::nullNode;
+                aabb = boundsTree.getRootAABB();
+            }
+            removedObjectIndices.push_back(index);
+            status |= SceneStatus::ObjectRemoved;
+            removeBakedAnimationInstances(index, false);
+            animationLodSourcesDirty = true;
+        }
+    }
+
+    // index をメッシュとするインスタンスを外す (anchored なら index をアンカーとするものも)
+    void removeBakedAnimationInstances(uint32_t index, bool anchored);
+
+    // アンカーの親のワールド行列と、アンカーからメッシュへの相対行列を計算し直す
+    void updateBakedAnimationInstance(uint32_t instanceIndex);
+
+    // メッシュのワールドAABB (焼き込んだアニメーションで動くものはトラックの全フレーム分)
+    rv::AABB computeWorldAABB(uint32_t objectIndex, const Mesh& mesh) const;
+
+    template <typename T>
+    ComponentPool<T>& getOrCreatePool() {
+        auto& pool = componentPools[componentID<T>];
+        if (!pool) {
+            pool = std::make_unique<ComponentPool<T>>();
+        }
+        return *static_cast<ComponentPool<T>*>(pool.get());
+    }
+
     const rv::Context* context = nullptr;
+    JobSystem* jobSystem = nullptr;
+
+    // オブジェクト、マテリアル、メッシュデータは外部からハンドルで参照させる。
+    // 配列が再アロケートされてもハンドルは有効なまま残るため、事前に大きく確保する必要はない。
+    // 削除されたスロットは再利用され、古いハンドルは世代番号の不一致で無効と判定される。
+    SlotMap<Object> objects{};
+    NameRegistry<ObjectHandle> objectNames{};
+    ChangeJournal changeJournal{};
+    std::vector<uint32_t> worldChangedObjectIndices{};
+    std::vector<uint32_t> removedObjectIndices{};
 
-    // vectorの再アロケートが起きると外部で持っている要素へのポインタが壊れるため
-    // 事前に大きなサイズでメモリ確保しておく。
-    // ポインタではなく別のハンドルやIDで参照させれば再アロケートも可能。
-    // もしくは外部のポインタを強制的に一度nullptrにしても良いが、一般的に難しい。
-    int maxObjectCount = 10000;
-    std::vector<Object> objects{};
-    std::vector<uint32_t> updatedObjectIndices{};
+    // コンポーネントの型ごとのプール (コンポーネントIDで添字アクセスする)
+    std::array<std::unique_ptr<ComponentPoolBase>, Components::count> componentPools{};
 
     Camera defaultCamera{rv::Camera::Type::Orbital};
-    Camera* mainCamera = nullptr;
+    ObjectHandle mainCamera{};
     bool isMainCameraActive = false;
 
-    std::vector<MeshData> templateMeshData{};
+    SlotMap<MeshData> meshData{};
+    std::vector<MeshDataHandle> templateMeshData{};
 
-    // 全ての頂点とインデックス
-    MeshData meshData;
+    // 読み込んだ全ての頂点とインデックス
+    MeshDataHandle sceneMeshData{};
 
-    std::vector<Material> materials{};
+    SlotMap<Material> materials{};
+    std::vector<MaterialHandle> gltfMaterials{};  // glTF のマテリアルインデックス -> ハンドル
     std::vector<Texture> textures2D{};
     std::vector<Texture> texturesCube{};
 
+    // Transform を持つオブジェクトの親子関係とワールド行列
+    SceneGraph sceneGraph{};
+
+    AnimationPlayer animationPlayer{};
+    static constexpr uint32_t animationChunkSize = 256;
+
+    // アニメーション LOD
+    // 関節はそれが動かすスキンメッシュ、それ以外は自身か子孫のメッシュの大きさと可視性で決める
+    // NOTE: 添字はオブジェクトインデックス。同じメッシュで決まる対象は同じフレームに更新する
+    void buildAnimationLodSources();
+
+    std::vector<uint32_t> animationLodTargets{};        // アニメーションの対象 (重複なし)
+    std::vector<uint32_t> animationLodSources{};        // 対象 -> 測るメッシュのオブジェクト
+    std::vector<uint32_t> animationLodSourceObjects{};  // 測るメッシュ (重複なし)
+    std::vector<AnimationRate> animationLodRates{};     // 測るメッシュごとの頻度
+    std::vector<uint8_t> animationUpdateMask{};         // 対象ごとに今フレーム更新するか
+    uint64_t animationFrame = 0;
+    bool animationLodSourcesDirty = true;
+
+    JointPalette jointPalette{};
+    std::vector<rv::AABB> jointAABBs{};  // 関節ごとのバインド姿勢でのAABB (メッシュのローカル空間)
+    MorphWeights morphWeights{};
+
+    // GPU で再生する焼き込んだアニメーション
+    // NOTE: インスタンスはメッシュを持つオブジェクトごとに一つ。アンカーは焼き込んだ対象
+    //       インスタンスを持たないオブジェクトは SceneGraph::nullIndex
+    BakedAnimation bakedAnimation{};
+    std::vector<BakedAnimationInstance> bakedAnimationInstances{};
+    std::vector<uint32_t> bakedAnimationAnchors{};  // インスタンスごとのアンカー
+    std::vector<uint32_t> bakedInstanceOfObject{};  // object index -> インスタンス
+    bool bakedAnimationInstancesDirty = false;
+    double bakedAnimationTime = 0.0;
+
+    // メッシュを持つオブジェクトのワールドAABBの木
+    BoundsTree boundsTree{};
+    std::vector<uint32_t> boundsLeaves{};  // object index -> leaf node
+    std::vector<rv::AABB> worldAABBs{};    // object index -> world AABB
     rv::AABB aabb{};
 
     SceneStatusFlags status = SceneStatus::None;
 };
 
-inline const Object* Scene::findObject(const std::string& name) const {
-    for (auto& obj : objects) {
-        if (obj.getName() == name) {
-            return &obj;
-        }
+template <typename T, typename... Args>
+T& Object::add(Args&&... args) {
+    return scene->addComponent<T>(*this, std::forward<Args>(args)...);
+}
+
+template <typename T>
+void Object::remove() {
+    scene->removeComponent<T>(*this);
+}
+
+// NOTE: マスクにビットが立っていればプールは必ず存在する
+template <typename T>
+T* Object::get() {
+    if (!has<T>()) {
+        return nullptr;
     }
-    return nullptr;
+    return &scene->getPool<T>()->getUnchecked(handle.index);
+}
+
+template <typename T>
+const T* Object::get() const {
+    if (!has<T>()) {
+        return nullptr;
+    }
+    return &scene->getPool<T>()->getUnchecked(handle.index);
+}
+
+inline std::vector<Component*> Object::getComponents() const {
+    return scene->getComponents(handle.index);
 }
@@ -0,0 +1,357 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// Transform を持つオブジェクトの親子関係
+// ノードは親が必ず子より前に来る順 (深さ優先の行きがけ順) に並べて保持するため、
+// ワールド行列は先頭から一度なめるだけで求められる
+// また、部分木は連続した範囲になるので subtreeSize だけ飛ばせば子孫を読み飛ばせる
+class SceneGraph {
+public:
+    static constexpr uint32_t nullIndex = std::numeric_limits<uint32_t>::max();
+
+    // ルートとして追加する
+    void add(uint32_t objectIndex) {
+        if (contains(objectIndex)) {
+            return;
+        }
+        if (objectIndex >= slots.size()) {
+            slots.resize(objectIndex + 1, nullIndex);
+            parents.resize(objectIndex + 1, nullIndex);
+        }
+        slots[objectIndex] = static_cast<uint32_t>(objectIndices.size());
+        parents[objectIndex] = nullIndex;
+        objectIndices.push_back(objectIndex);
+        parentSlots.push_back(nullIndex);
+        subtreeSizes.push_back(1);
+        localMatrices.emplace_back(1.0f);
+        worldMatrices.emplace_back(1.0f);
+        normalMatrices.emplace_back(1.0f);
+        dirtyFlags.push_back(1);
+        dirtyCount++;
+        needsSort = true;
+    }
+
+    // 子は削除したノードの親に付け替える
+    // NOTE: 子は部分木の範囲の中にあり、孫の部分木を読み飛ばせば順に辿れる
+    void remove(uint32_t objectIndex) {
+        if (!contains(objectIndex)) {
+            return;
+        }
+        if (needsSort) {
+            sort();
+        }
+        uint32_t slot = slots[objectIndex];
+        uint32_t parent = parents[objectIndex];
+        uint32_t end = slot + subtreeSizes[slot];
+        for (uint32_t child = slot + 1; child < end; child += subtreeSizes[child]) {
+            parents[objectIndices[child]] = parent;
+            parentSlots[child] = parentSlots[slot];
+            markDirty(objectIndices[child]);
+        }
+        eraseSlots(slot, 1);
+    }
+
+    // 子孫ごと削除する
+    void removeSubtree(uint32_t objectIndex) {
+        if (!contains(objectIndex)) {
+            return;
+        }
+        if (needsSort) {
+            sort();
+        }
+        uint32_t slot = slots[objectIndex];
+        eraseSlots(slot, subtreeSizes[slot]);
+    }
+
+    bool contains(uint32_t objectIndex) const {
+        return objectIndex < slots.size() && slots[objectIndex] != nullIndex;
+    }
+
+    // 親を付け替える (nullIndex ならルートにする)
+    // 自分の子孫を親にしようとした場合は循環するため失敗する
+    bool setParent(uint32_t objectIndex, uint32_t parentIndex) {
+        if (!contains(objectIndex)) {
+            return false;
+        }
+        if (parentIndex != nullIndex) {
+            if (!contains(parentIndex)) {
+                return false;
+            }
+            for (uint32_t ancestor = parentIndex; ancestor != nullIndex;
+                 ancestor = parents[ancestor]) {
+                if (ancestor == objectIndex) {
+                    return false;
+                }
+            }
+        }
+        if (parents[objectIndex] == parentIndex) {
+            return true;
+        }
+        parents[objectIndex] = parentIndex;
+        markDirty(objectIndex);
+        needsSort = true;
+        return true;
+    }
+
+    uint32_t getParent(uint32_t objectIndex) const {
+        return contains(objectIndex) ? parents[objectIndex] : nullIndex;
+    }
+
+    // 子孫のオブジェクトインデックス (親が先に来る順)
+    // NOTE: 部分木は行きがけ順で連続しているので、並べ直した上でその範囲をそのまま返す
+    //       親子関係を変えるか、ノードを追加・削除すると無効になる
+    std::span<const uint32_t> getDescendants(uint32_t objectIndex) {
+        if (!contains(objectIndex)) {
+            return {};
+        }
+        if (needsSort) {
+            sort();
+        }
+        uint32_t slot = slots[objectIndex];
+        return std::span<const uint32_t>{objectIndices}.subspan(slot + 1, subtreeSizes[slot] - 1);
+    }
+
+    void collectDescendants(uint32_t objectIndex, std::vector<uint32_t>& descendants) {
+        std::span<const uint32_t> range = getDescendants(objectIndex);
+        descendants.insert(descendants.end(), range.begin(), range.end());
+    }
+
+    void setLocalMatrix(uint32_t objectIndex, const glm::mat4& matrix) {
+        uint32_t slot = slots[objectIndex];
+        localMatrices[slot] = matrix;
+        markDirty(objectIndex);
+    }
+
+    const glm::mat4& getLocalMatrix(uint32_t objectIndex) const {
+        return contains(objectIndex) ? localMatrices[slots[objectIndex]] : identity;
+    }
+
+    // NOTE: グラフに含まれないオブジェクトは単位行列を返す
+    const glm::mat4& getWorldMatrix(uint32_t objectIndex) const {
+        return contains(objectIndex) ? worldMatrices[slots[objectIndex]] : identity;
+    }
+
+    const glm::mat4& getParentWorldMatrix(uint32_t objectIndex) const {
+        return getWorldMatrix(getParent(objectIndex));
+    }
+
+    // ワールド行列の逆転置 (法線の変換用)
+    // NOTE: 逆行列は重いので、ワールド行列と一緒に変更のあったときだけ計算する
+    const glm::mat4& getNormalMatrix(uint32_t objectIndex) const {
+        return contains(objectIndex) ? normalMatrices[slots[objectIndex]] : identity;
+    }
+
+    // 親子関係が変わっていれば並べ直し、変更のあったノードとその子孫のワールド行列を計算する
+    // ワールド行列が変わったオブジェクトのインデックスを changedObjectIndices に追加する
+    void update(std::vector<uint32_t>& changedObjectIndices) {
+        if (needsSort) {
+            sort();
+        }
+        if (dirtyCount == 0) {
+            return;
+        }
+
+        // NOTE: 親は必ず前にあるので、親が計算し直されていれば子も計算し直す
+        for (uint32_t slot = 0; slot < objectIndices.size(); slot++) {
+            uint32_t parentSlot = parentSlots[slot];
+            if (parentSlot != nullIndex && dirtyFlags[parentSlot]) {
+                dirtyFlags[slot] = 1;
+            }
+            if (!dirtyFlags[slot]) {
+                continue;
+            }
+            worldMatrices[slot] = parentSlot == nullIndex
+                                      ? localMatrices[slot]
+                                      : worldMatrices[parentSlot] * localMatrices[slot];
+            normalMatrices[slot] =
+                glm::mat4{glm::transpose(glm::inverse(glm::mat3{worldMatrices[slot]}))};
+            changedObjectIndices.push_back(objectIndices[slot]);
+        }
+
+        std::ranges::fill(dirtyFlags, 0);
+        dirtyCount = 0;
+    }
+
+    // 並び順 (行きがけ順) でのアクセス
+    uint32_t getNodeCount() const {
+        return static_cast<uint32_t>(objectIndices.size());
+    }
+
+    uint32_t getObjectIndex(uint32_t slot) const {
+        return objectIndices[slot];
+    }
+
+    // 自分を含む部分木のノード数
+    uint32_t getSubtreeSize(uint32_t slot) const {
+        return subtreeSizes[slot];
+    }
+
+    uint32_t getParentSlot(uint32_t slot) const {
+        return parentSlots[slot];
+    }
+
+    void clear() {
+        slots.clear();
+        parents.clear();
+        objectIndices.clear();
+        parentSlots.clear();
+        subtreeSizes.clear();
+        localMatrices.clear();
+        worldMatrices.clear();
+        normalMatrices.clear();
+        dirtyFlags.clear();
+        dirtyCount = 0;
+        needsSort = false;
+    }
+
+private:
+    void markDirty(uint32_t objectIndex) {
+        uint8_t& dirty = dirtyFlags[slots[objectIndex]];
+        if (!dirty) {
+            dirty = 1;
+            dirtyCount++;
+        }
+    }
+
+    // 行きがけ順を保ったまま [begin, begin + count) のノードを詰める
+    // NOTE: 範囲は部分木全体か、子を付け替えた後の一つのノードであること
+    //       範囲の外のノードの親は範囲の外にあるので、後ろのノードの番号をずらすだけでよい
+    void eraseSlots(uint32_t begin, uint32_t count) {
+        uint32_t end = begin + count;
+        for (uint32_t ancestor = parentSlots[begin]; ancestor != nullIndex;
+             ancestor = parentSlots[ancestor]) {
+            subtreeSizes[ancestor] -= count;
+        }
+        for (uint32_t slot = begin; slot < end; slot++) {
+            if (dirtyFlags[slot]) {
+                dirtyCount--;
+            }
+            slots[objectIndices[slot]] = nullIndex;
+            parents[objectIndices[slot]] = nullIndex;
+        }
+
+        auto eraseRange = [&](auto& values) {
+            values.erase(values.begin() + begin, values.begin() + end);
+        };
+        eraseRange(objectIndices);
+        eraseRange(parentSlots);
+        eraseRange(subtreeSizes);
+        eraseRange(localMatrices);
+        eraseRange(worldMatrices);
+        eraseRange(normalMatrices);
+        eraseRange(dirtyFlags);
+        for (uint32_t slot = begin; slot < objectIndices.size(); slot++) {
+            slots[objectIndices[slot]] = slot;
+            if (parentSlots[slot] != nullIndex && parentSlots[slot] >= end) {
+                parentSlots[slot] -= count;
+            }
+        }
+    }
+
+    // 深さ優先の行きがけ順に並べ直す
+    // NOTE: 兄弟の順序は現在の並び順を保つ
+    void sort() {
+        uint32_t count = static_cast<uint32_t>(objectIndices.size());
+
+        // 子の一覧を CSR 形式で作る
+        std::vector<uint32_t> childOffsets(count + 1, 0);
+        for (uint32_t slot = 0; slot < count; slot++) {
+            uint32_t parent = parents[objectIndices[slot]];
+            if (parent != nullIndex) {
+                childOffsets[slots[parent] + 1]++;
+            }
+        }
+        for (uint32_t slot = 0; slot < count; slot++) {
+            childOffsets[slot + 1] += childOffsets[slot];
+        }
+        std::vector<uint32_t> children(childOffsets[count]);
+        std::vector<uint32_t> cursor(childOffsets.begin(), childOffsets.end() - 1);
+        for (uint32_t slot = 0; slot < count; slot++) {
+            uint32_t parent = parents[objectIndices[slot]];
+            if (parent != nullIndex) {
+                children[cursor[slots[parent]]++] = slot;
+            }
+        }
+
+        std::vector<uint32_t> order;  // new slot -> old slot
+        order.reserve(count);
+        std::vector<uint32_t> stack;
+        for (uint32_t root = 0; root < count; root++) {
+            if (parents[objectIndices[root]] != nullIndex) {
+                continue;
+            }
+            stack.push_back(root);
+            while (!stack.empty()) {
+                uint32_t slot = stack.back();
+                stack.pop_back();
+                order.push_back(slot);
+
+                // 兄弟の順序を保つため逆順に積む
+                for (uint32_t i = childOffsets[slot + 1]; i > childOffsets[slot]; i--) {
+                    stack.push_back(children[i - 1]);
+                }
+            }
+        }
+
+        // 新しい並びに詰め直す
+        std::vector<uint32_t> newObjectIndices(count);
+        std::vector<glm::mat4> newLocalMatrices(count);
+        std::vector<glm::mat4> newWorldMatrices(count);
+        std::vector<glm::mat4> newNormalMatrices(count);
+        std::vector<uint8_t> newDirtyFlags(count);
+        for (uint32_t newSlot = 0; newSlot < count; newSlot++) {
+            uint32_t oldSlot = order[newSlot];
+            newObjectIndices[newSlot] = objectIndices[oldSlot];
+            newLocalMatrices[newSlot] = localMatrices[oldSlot];
+            newWorldMatrices[newSlot] = worldMatrices[oldSlot];
+            newNormalMatrices[newSlot] = normalMatrices[oldSlot];
+            newDirtyFlags[newSlot] = dirtyFlags[oldSlot];
+        }
+        objectIndices = std::move(newObjectIndices);
+        localMatrices = std::move(newLocalMatrices);
+        worldMatrices = std::move(newWorldMatrices);
+        normalMatrices = std::move(newNormalMatrices);
+        dirtyFlags = std::move(newDirtyFlags);
+        for (uint32_t slot = 0; slot < count; slot++) {
+            slots[objectIndices[slot]] = slot;
+        }
+
+        // 親のスロットと部分木のサイズ
+        for (uint32_t slot = 0; slot < count; slot++) {
+            uint32_t parent = parents[objectIndices[slot]];
+            parentSlots[slot] = parent == nullIndex ? nullIndex : slots[parent];
+            subtreeSizes[slot] = 1;
+        }
+        for (uint32_t slot = count; slot-- > 0;) {
+            if (parentSlots[slot] != nullIndex) {
+                subtreeSizes[parentSlots[slot]] += subtreeSizes[slot];
+            }
+        }
+
+        needsSort = false;
+    }
+
+    inline static const glm::mat4 identity{1.0f};
+
+    // オブジェクトのインデックスで引くもの
+    std::vector<uint32_t> slots;    // object index -> slot
+    std::vector<uint32_t> parents;  // object index -> parent object index
+
+    // 行きがけ順に並んだノード
+    std::vector<uint32_t> objectIndices;
+    std::vector<uint32_t> parentSlots;
+    std::vector<uint32_t> subtreeSizes;
+    std::vector<glm::mat4> localMatrices;
+    std::vector<glm::mat4> worldMatrices;
+    std::vector<glm::mat4> normalMatrices;
+    std::vector<uint8_t> dirtyFlags;
+
+    uint32_t dirtyCount = 0;
+    bool needsSort = false;
+};
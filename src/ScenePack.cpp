@@ -0,0 +1,119 @@
+#include "ScenePack.hpp"
+
+#include <fstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+constexpr uint64_t sectionAlignment = 16;
+
+uint64_t alignUp(uint64_t value) {
+    return (value + sectionAlignment - 1) / sectionAlignment * sectionAlignment;
+}
+}  // namespace
+
+bool ScenePackWriter::write(const std::filesystem::path& filepath) const {
+    ScenePackHeader header{};
+    uint64_t offset = alignUp(sizeof(ScenePackHeader));
+    for (size_t i = 0; i < sections.size(); i++) {
+        header.sections[i] = {offset, sections[i].size()};
+        offset = alignUp(offset + sections[i].size());
+    }
+
+    std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    const std::array<char, sectionAlignment> padding{};
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    uint64_t written = sizeof(header);
+    for (size_t i = 0; i < sections.size(); i++) {
+        auto paddingSize = static_cast<std::streamsize>(header.sections[i].offset - written);
+        file.write(padding.data(), paddingSize);
+        file.write(reinterpret_cast<const char*>(sections[i].data()),
+                   static_cast<std::streamsize>(sections[i].size()));
+        written = header.sections[i].offset + sections[i].size();
+    }
+    return file.good();
+}
+
+bool ScenePackFile::open(const std::filesystem::path& filepath) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileW(filepath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                              OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize{};
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    // NOTE: ビューがマッピングを参照し続けるので、ハンドルはすぐに閉じてよい
+    if (mapping) {
+        data = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+        size = static_cast<size_t>(fileSize.QuadPart);
+        CloseHandle(mapping);
+    }
+    CloseHandle(file);
+#else
+    int file = ::open(filepath.c_str(), O_RDONLY);
+    if (file < 0) {
+        return false;
+    }
+    struct stat fileStat{};
+    if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0) {
+        void* mapped = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ,
+                            MAP_PRIVATE, file, 0);
+        if (mapped != MAP_FAILED) {
+            data = static_cast<const std::byte*>(mapped);
+            size = static_cast<size_t>(fileStat.st_size);
+        }
+    }
+    ::close(file);
+#endif
+    if (!data) {
+        size = 0;
+        return false;
+    }
+
+    // ヘッダとセクションの範囲を検証する
+    bool valid = size >= sizeof(ScenePackHeader);
+    if (valid) {
+        const ScenePackHeader& header = getHeader();
+        valid = header.magic == ScenePackHeader::validMagic &&
+                header.version == ScenePackHeader::currentVersion &&
+                header.sectionCount == static_cast<uint32_t>(ScenePackSection::COUNT);
+        for (const ScenePackHeader::Section& section : header.sections) {
+            valid = valid && section.offset % sectionAlignment == 0 && section.offset <= size &&
+                    section.size <= size - section.offset;
+        }
+    }
+    if (!valid) {
+        close();
+    }
+    return valid;
+}
+
+void ScenePackFile::close() {
+    if (data) {
+#ifdef _WIN32
+        UnmapViewOfFile(data);
+#else
+        munmap(const_cast<std::byte*>(data), size);
+#endif
+    }
+    data = nullptr;
+    size = 0;
+}
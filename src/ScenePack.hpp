@@ -0,0 +1,241 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <limits>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/quaternion.hpp>
+
+// 読み込み済みのシーン (glTF から作ったもの) を、そのまま GPU に転送できる形で書き出したバイナリ
+// ファイルは ヘッダ, セクションの表, 各セクションの中身 の順に並ぶ
+// 中身は POD の配列で、頂点は VertexPNUT、テクスチャはデコード済みの RGBA8 のまま持つ
+// NOTE: メモリマップしたファイルから span としてそのまま読めるよう、セクションは16バイト境界に置く
+//       エンディアンや構造体の配置は書き出したマシンと同じものを前提にする
+
+enum class ScenePackSection : uint32_t {
+    Strings,           // char (名前を詰めたもの)
+    Objects,           // ScenePackObject
+    Materials,         // ScenePackMaterial
+    Vertices,          // VertexPNUT
+    Indices,           // uint32_t
+    SkinVertices,      // SkinVertex
+    MorphRanges,       // glm::uvec2
+    MorphDeltas,       // MorphDelta
+    MorphWeights,      // float
+    Textures,          // ScenePackTexture
+    TexturePixels,     // uint8_t
+    Clips,             // ScenePackClip
+    Tracks,            // ScenePackTrack
+    TrackTimes,        // float
+    TrackValues,       // float (vec3 / quat / float を詰めたもの)
+    Skins,             // ScenePackSkin
+    SkinJoints,        // uint32_t (パック上のオブジェクトの番号)
+    SkinInverseBinds,  // glm::mat4
+    Indices16,         // uint16_t
+    MeshLods,          // MeshLod (インデックスはメッシュと同じセクション上の位置)
+    MeshClusters,      // MeshCluster (インデックスはメッシュの firstIndex からの位置)
+    COUNT,
+};
+
+// Strings セクション上の文字列
+struct ScenePackString {
+    uint32_t offset = 0;
+    uint32_t length = 0;
+};
+
+// NOTE: 親や関節、アニメーションの対象はパック上のオブジェクトの番号で指す
+struct ScenePackObject {
+    static constexpr uint32_t none = std::numeric_limits<uint32_t>::max();
+
+    ScenePackString name;
+    uint32_t parent = none;
+    uint32_t material = none;  // メッシュを持たないか、マテリアルが無ければ none
+
+    glm::vec3 translation{0.0f};
+    uint32_t hasMesh = 0;
+    glm::quat rotation{1.0f, 0.0f, 0.0f, 0.0f};
+    glm::vec3 scale{1.0f};
+    uint32_t morphTargetCount = 0;
+
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    uint32_t vertexOffset = 0;
+    uint32_t vertexCount = 0;
+    int32_t firstJoint = -1;
+    int32_t firstMorphWeight = -1;
+    uint32_t indices16 = 0;  // 1 なら firstIndex は Indices16 セクション上の位置
+    uint32_t firstLod = 0;   // MeshLods セクション上の [firstLod, firstLod + lodCount)
+    uint32_t lodCount = 0;
+    uint32_t firstCluster = 0;  // MeshClusters セクション上の [firstCluster, +clusterCount)
+    uint32_t clusterCount = 0;
+    uint32_t _dummy{};
+};
+
+struct ScenePackMaterial {
+    glm::vec4 baseColor{1.0f};
+    glm::vec3 emissive{0.0f};
+    float metallic = 1.0f;
+    float roughness = 1.0f;
+    float ior = 1.5f;
+    int32_t baseColorTextureIndex = -1;
+    int32_t metallicRoughnessTextureIndex = -1;
+    int32_t normalTextureIndex = -1;
+    int32_t occlusionTextureIndex = -1;
+    int32_t emissiveTextureIndex = -1;
+    uint32_t enableNormalMapping = 0;
+    uint32_t doubleSided = 0;
+    ScenePackString name;
+};
+
+// TexturePixels セクション上の RGBA8 の画素
+struct ScenePackTexture {
+    ScenePackString name;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    uint64_t pixelOffset = 0;
+    uint64_t pixelSize = 0;
+    uint32_t srgb = 0;  // 1 なら sRGB のフォーマットで作る
+    uint32_t _dummy{};
+};
+
+// クリップのトラックは Tracks セクション上の [firstTrack, firstTrack + trackCount)
+struct ScenePackClip {
+    ScenePackString name;
+    uint32_t firstTrack = 0;
+    uint32_t trackCount = 0;
+};
+
+enum class ScenePackChannel : uint32_t {
+    Translation,
+    Rotation,
+    Scale,
+    Weights,  // 対象は MorphWeights 上の位置
+};
+
+// NOTE: 値の個数は float 単位 (CUBICSPLINE は接線も含む)
+struct ScenePackTrack {
+    ScenePackChannel channel = ScenePackChannel::Translation;
+    uint32_t target = 0;
+    uint32_t interpolation = 0;
+    uint32_t firstTime = 0;
+    uint32_t timeCount = 0;
+    uint32_t firstValue = 0;
+    uint32_t valueCount = 0;
+    uint32_t _dummy{};
+};
+
+// 関節と逆バインド行列は SkinJoints / SkinInverseBinds 上の [firstJoint, firstJoint + jointCount)
+struct ScenePackSkin {
+    uint32_t meshObject = 0;
+    uint32_t firstJoint = 0;
+    uint32_t jointCount = 0;
+    uint32_t _dummy{};
+};
+
+struct ScenePackHeader {
+    static constexpr std::array<char, 4> validMagic = {'R', 'R', 'S', 'P'};
+    static constexpr uint32_t currentVersion = 5;
+
+    // NOTE: セクションごとのファイル上の位置と大きさ (バイト)
+    struct Section {
+        uint64_t offset = 0;
+        uint64_t size = 0;
+    };
+
+    std::array<char, 4> magic = validMagic;
+    uint32_t version = currentVersion;
+    uint32_t sectionCount = static_cast<uint32_t>(ScenePackSection::COUNT);
+    uint32_t _dummy{};
+    std::array<Section, static_cast<size_t>(ScenePackSection::COUNT)> sections{};
+};
+
+// セクションごとにメモリ上に溜めてから、一度に書き出す
+class ScenePackWriter {
+public:
+    template <typename T>
+    uint32_t add(ScenePackSection section, std::span<const T> values) {
+        static_assert(std::is_trivially_copyable_v<T>);
+        std::vector<std::byte>& data = sections[static_cast<size_t>(section)];
+        size_t first = data.size() / sizeof(T);
+        const auto* bytes = reinterpret_cast<const std::byte*>(values.data());
+        data.insert(data.end(), bytes, bytes + values.size_bytes());
+        return static_cast<uint32_t>(first);
+    }
+
+    template <typename T>
+    uint32_t add(ScenePackSection section, const T& value) {
+        return add(section, std::span<const T>{&value, 1});
+    }
+
+    // NOTE: 読み出したときに C 文字列としても使えるよう、終端の 0 も書き込む
+    ScenePackString addString(std::string_view string) {
+        std::vector<std::byte>& data = sections[static_cast<size_t>(ScenePackSection::Strings)];
+        ScenePackString packString{static_cast<uint32_t>(data.size()),
+                                   static_cast<uint32_t>(string.size())};
+        const auto* bytes = reinterpret_cast<const std::byte*>(string.data());
+        data.insert(data.end(), bytes, bytes + string.size());
+        data.push_back(std::byte{0});
+        return packString;
+    }
+
+    size_t getSize(ScenePackSection section) const {
+        return sections[static_cast<size_t>(section)].size();
+    }
+
+    // section に T がいくつ入っているか (次に追加する要素の番号)
+    template <typename T>
+    uint32_t getCount(ScenePackSection section) const {
+        return static_cast<uint32_t>(getSize(section) / sizeof(T));
+    }
+
+    bool write(const std::filesystem::path& filepath) const;
+
+private:
+    std::array<std::vector<std::byte>, static_cast<size_t>(ScenePackSection::COUNT)> sections;
+};
+
+// メモリマップしたシーンパック
+// NOTE: 返す span は close() するか破棄されるまで有効
+class ScenePackFile {
+public:
+    ScenePackFile() = default;
+    ScenePackFile(const ScenePackFile&) = delete;
+    ScenePackFile& operator=(const ScenePackFile&) = delete;
+
+    ~ScenePackFile() {
+        close();
+    }
+
+    // ヘッダとセクションの範囲を検証し、壊れているか古いバージョンなら false を返す
+    bool open(const std::filesystem::path& filepath);
+
+    void close();
+
+    template <typename T>
+    std::span<const T> get(ScenePackSection section) const {
+        const ScenePackHeader::Section& entry = getHeader().sections[static_cast<size_t>(section)];
+        return {reinterpret_cast<const T*>(data + entry.offset), entry.size / sizeof(T)};
+    }
+
+    std::string_view getString(ScenePackString string) const {
+        std::span<const char> strings = get<char>(ScenePackSection::Strings);
+        if (string.offset > strings.size() || string.length > strings.size() - string.offset) {
+            return {};
+        }
+        return {strings.data() + string.offset, string.length};
+    }
+
+    const ScenePackHeader& getHeader() const {
+        return *reinterpret_cast<const ScenePackHeader*>(data);
+    }
+
+private:
+    const std::byte* data = nullptr;
+    size_t size = 0;
+};
@@ -0,0 +1,179 @@
+#pragma once
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// 頂点ごとの関節とウェイト (glTF の JOINTS_0 / WEIGHTS_0)
+// NOTE: 関節はスキン内のインデックス。パレット上の位置はメッシュごとの先頭を足して求める
+struct SkinVertex {
+    glm::uvec4 joints{0};
+    glm::vec4 weights{0.0f};
+};
+
+// スキンメッシュの関節行列をまとめて保持する
+// スキンメッシュを持つオブジェクト (インスタンス) ごとに、関節の数だけパレットの範囲を確保する
+// 関節行列は メッシュのワールド逆行列 * 関節のワールド行列 * 逆バインド行列 で、
+// スキニング後の頂点はメッシュのローカル空間に残るため、モデル行列はそのまま使える
+// NOTE: 関節は全インスタンス分を一つの配列に詰め、毎フレーム一度のループで計算する
+class JointPalette {
+public:
+    static constexpr uint32_t invalidObject = std::numeric_limits<uint32_t>::max();
+
+    // パレット上の先頭位置を返す
+    uint32_t addInstance(uint32_t meshObjectIndex,
+                         std::span<const uint32_t> jointObjectIndices,
+                         std::span<const glm::mat4> inverseBindMatrices) {
+        uint32_t instance = static_cast<uint32_t>(instanceObjects.size());
+        uint32_t firstJoint = static_cast<uint32_t>(jointObjects.size());
+        instanceObjects.push_back(meshObjectIndex);
+        inverseMeshMatrices.emplace_back(1.0f);
+        for (size_t i = 0; i < jointObjectIndices.size(); i++) {
+            jointObjects.push_back(jointObjectIndices[i]);
+            jointInstances.push_back(instance);
+            // NOTE: inverseBindMatrices が省略された場合は単位行列
+            if (i < inverseBindMatrices.size()) {
+                jointInverseBinds.push_back(inverseBindMatrices[i]);
+            } else {
+                jointInverseBinds.emplace_back(1.0f);
+            }
+            matrices.emplace_back(1.0f);
+        }
+        dirty = true;
+        return firstJoint;
+    }
+
+    // getWorldMatrix(objectIndex) からパレットを計算し直す
+    template <typename GetWorldMatrix>
+    void update(GetWorldMatrix&& getWorldMatrix) {
+        for (size_t i = 0; i < instanceObjects.size(); i++) {
+            inverseMeshMatrices[i] = glm::inverse(getWorldMatrix(instanceObjects[i]));
+        }
+        for (size_t i = 0; i < jointObjects.size(); i++) {
+            glm::mat4 world{1.0f};
+            if (jointObjects[i] != invalidObject) {
+                world = getWorldMatrix(jointObjects[i]);
+            }
+            matrices[i] = inverseMeshMatrices[jointInstances[i]] * world * jointInverseBinds[i];
+        }
+        dirty = true;
+    }
+
+    // 削除されたオブジェクトを関節として参照しないようにする
+    void removeObject(uint32_t objectIndex) {
+        for (uint32_t& object : jointObjects) {
+            if (object == objectIndex) {
+                object = invalidObject;
+            }
+        }
+    }
+
+    // (関節のオブジェクト, それが動かすメッシュのオブジェクト) の組を列挙する
+    template <typename Function>
+    void forEachJoint(Function&& function) const {
+        for (size_t i = 0; i < jointObjects.size(); i++) {
+            if (jointObjects[i] != invalidObject) {
+                function(jointObjects[i], instanceObjects[jointInstances[i]]);
+            }
+        }
+    }
+
+    // インスタンスごとに (メッシュのオブジェクト, 関節のオブジェクト, 逆バインド行列) を列挙する
+    // NOTE: 関節はインスタンス順に詰まっている
+    template <typename Function>
+    void forEachInstance(Function&& function) const {
+        std::span<const uint32_t> joints = jointObjects;
+        std::span<const glm::mat4> inverseBinds = jointInverseBinds;
+        size_t first = 0;
+        for (uint32_t instance = 0; instance < instanceObjects.size(); instance++) {
+            size_t last = first;
+            while (last < jointInstances.size() && jointInstances[last] == instance) {
+                last++;
+            }
+            function(instanceObjects[instance], joints.subspan(first, last - first),
+                     inverseBinds.subspan(first, last - first));
+            first = last;
+        }
+    }
+
+    // 前回の読み出しから変更があったか (リセットしない)
+    bool isDirty() const {
+        return dirty;
+    }
+
+    // 前回の読み出しから変更があったか (読み出すとリセットされる)
+    bool consumeDirty() {
+        bool wasDirty = dirty;
+        dirty = false;
+        return wasDirty;
+    }
+
+    bool empty() const {
+        return jointObjects.empty();
+    }
+
+    std::span<const glm::mat4> getMatrices() const {
+        return matrices;
+    }
+
+    void clear() {
+        instanceObjects.clear();
+        inverseMeshMatrices.clear();
+        jointObjects.clear();
+        jointInstances.clear();
+        jointInverseBinds.clear();
+        matrices.clear();
+        dirty = true;
+    }
+
+private:
+    // インスタンスごと
+    std::vector<uint32_t> instanceObjects;
+    std::vector<glm::mat4> inverseMeshMatrices;
+
+    // 関節ごと
+    std::vector<uint32_t> jointObjects;
+    std::vector<uint32_t> jointInstances;
+    std::vector<glm::mat4> jointInverseBinds;
+    std::vector<glm::mat4> matrices;
+
+    bool dirty = false;
+};
+
+// CPU でのスキニング (GPU の deform.comp と同じ計算)
+// NOTE: テストや検証用の参照実装。描画ではコンピュートシェーダが一度だけ書き出した頂点を使う
+//       ウェイトが全て 0 の頂点は動かさない
+inline glm::mat4 computeSkinMatrix(const SkinVertex& skin,
+                                   std::span<const glm::mat4> palette,
+                                   uint32_t firstJoint) {
+    glm::mat4 matrix{0.0f};
+    float weightSum = 0.0f;
+    for (int i = 0; i < 4; i++) {
+        if (skin.weights[i] != 0.0f) {
+            matrix += skin.weights[i] * palette[firstJoint + skin.joints[i]];
+            weightSum += skin.weights[i];
+        }
+    }
+    return weightSum == 0.0f ? glm::mat4{1.0f} : matrix;
+}
+
+template <typename Vertex>
+void skinVertices(std::span<const Vertex> srcVertices,
+                  std::span<const SkinVertex> skins,
+                  std::span<const glm::mat4> palette,
+                  uint32_t firstJoint,
+                  std::span<Vertex> dstVertices) {
+    for (size_t i = 0; i < srcVertices.size(); i++) {
+        const Vertex& src = srcVertices[i];
+        Vertex& dst = dstVertices[i];
+        glm::mat4 matrix = computeSkinMatrix(skins[i], palette, firstJoint);
+        glm::mat3 normalMatrix{matrix};
+        dst = src;
+        dst.position = glm::vec3{matrix * glm::vec4{src.position, 1.0f}};
+        // NOTE: 正規化はフラグメントシェーダで行う
+        dst.normal = normalMatrix * src.normal;
+        dst.tangent = glm::vec4{normalMatrix * glm::vec3{src.tangent}, src.tangent.w};
+    }
+}
@@ -0,0 +1,190 @@
+#pragma once
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <vector>
+
+// インデックスと世代番号の組による参照
+// スロットが解放・再利用されると世代番号が進むため、古いハンドルは無効として検出できる
+template <typename T>
+struct Handle {
+    static constexpr uint32_t invalidIndex = std::numeric_limits<uint32_t>::max();
+
+    uint32_t index = invalidIndex;
+    uint32_t generation = 0;
+
+    bool isValid() const {
+        return index != invalidIndex;
+    }
+
+    bool operator==(const Handle& other) const = default;
+};
+
+// 要素をスロット単位で保持し、ハンドルで参照するコンテナ
+// 配列の再アロケートで要素のアドレスは変わるが、ハンドルは有効なまま残る
+template <typename T>
+class SlotMap {
+public:
+    template <typename Value>
+    class Iterator {
+    public:
+        Iterator(Value* _slotMap, uint32_t _index) : slotMap{_slotMap}, index{_index} {
+            skip();
+        }
+
+        auto& operator*() const {
+            return *slotMap->values[index];
+        }
+
+        auto* operator->() const {
+            return &*slotMap->values[index];
+        }
+
+        Iterator& operator++() {
+            index++;
+            skip();
+            return *this;
+        }
+
+        bool operator!=(const Iterator& other) const {
+            return index != other.index;
+        }
+
+    private:
+        void skip() {
+            while (index < slotMap->values.size() && !slotMap->values[index]) {
+                index++;
+            }
+        }
+
+        Value* slotMap;
+        uint32_t index;
+    };
+
+    template <typename... Args>
+    Handle<T> emplace(Args&&... args) {
+        uint32_t index;
+        if (!freeList.empty()) {
+            index = freeList.back();
+            freeList.pop_back();
+        } else {
+            index = static_cast<uint32_t>(values.size());
+            values.emplace_back();
+            if (generations.size() <= index) {
+                generations.push_back(0);
+            }
+        }
+        values[index].emplace(std::forward<Args>(args)...);
+        aliveCount++;
+        return {index, generations[index]};
+    }
+
+    bool erase(Handle<T> handle) {
+        if (!contains(handle)) {
+            return false;
+        }
+        values[handle.index].reset();
+        generations[handle.index]++;
+        freeList.push_back(handle.index);
+        aliveCount--;
+        return true;
+    }
+
+    bool contains(Handle<T> handle) const {
+        return handle.index < values.size() && generations[handle.index] == handle.generation &&
+               values[handle.index].has_value();
+    }
+
+    T* get(Handle<T> handle) {
+        return contains(handle) ? &*values[handle.index] : nullptr;
+    }
+
+    const T* get(Handle<T> handle) const {
+        return contains(handle) ? &*values[handle.index] : nullptr;
+    }
+
+    // スロットのインデックスで直接参照する
+    // 生存しているスロットであることは呼び出し側が保証する
+    T& operator[](uint32_t index) {
+        assert(isAlive(index));
+        return *values[index];
+    }
+
+    const T& operator[](uint32_t index) const {
+        assert(isAlive(index));
+        return *values[index];
+    }
+
+    bool isAlive(uint32_t index) const {
+        return index < values.size() && values[index].has_value();
+    }
+
+    Handle<T> getHandle(uint32_t index) const {
+        if (!isAlive(index)) {
+            return {};
+        }
+        return {index, generations[index]};
+    }
+
+    // 生存している要素数
+    size_t size() const {
+        return aliveCount;
+    }
+
+    bool empty() const {
+        return aliveCount == 0;
+    }
+
+    // 解放済みも含めたスロット数
+    // スロットのインデックスは常にこの値未満になる
+    size_t getSlotCount() const {
+        return values.size();
+    }
+
+    // NOTE: clear 前に取得したハンドルが無効になるよう世代番号は進めて残す
+    void clear() {
+        for (uint32_t index = 0; index < values.size(); index++) {
+            if (values[index]) {
+                generations[index]++;
+            }
+        }
+        values.clear();
+        freeList.clear();
+        aliveCount = 0;
+    }
+
+    // 末尾の空きスロットを切り詰めてメモリを返却する
+    // 生存している要素は移動しないため、ハンドルは有効なまま残る
+    // NOTE: 世代番号は切り詰めずに残し、古いハンドルが再び有効にならないようにする
+    void compact() {
+        while (!values.empty() && !values.back().has_value()) {
+            values.pop_back();
+        }
+        std::erase_if(freeList, [this](uint32_t index) { return index >= values.size(); });
+        values.shrink_to_fit();
+        freeList.shrink_to_fit();
+    }
+
+    Iterator<SlotMap> begin() {
+        return {this, 0};
+    }
+
+    Iterator<SlotMap> end() {
+        return {this, static_cast<uint32_t>(values.size())};
+    }
+
+    Iterator<const SlotMap> begin() const {
+        return {this, 0};
+    }
+
+    Iterator<const SlotMap> end() const {
+        return {this, static_cast<uint32_t>(values.size())};
+    }
+
+private:
+    std::vector<std::optional<T>> values;
+    std::vector<uint32_t> generations;
+    std::vector<uint32_t> freeList;
+    size_t aliveCount = 0;
+};
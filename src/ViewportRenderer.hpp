@@ -3,7 +3,7 @@
 
 #include <reactive/reactive.hpp>
 
-#include "Scene.hpp"
+#include "RenderSnapshot.hpp"
 
 class LineDrawer {
     struct PushConstants {
@@ -115,16 +115,12 @@ public:
     void render(const rv::CommandBuffer& commandBuffer,
                 const rv::ImageHandle& colorImage,
                 const rv::ImageHandle& depthImage,
-                Scene& scene) const {
+                const RenderSnapshot& snapshot) const {
         vk::Extent3D extent = colorImage->getExtent();
         commandBuffer.beginDebugLabel("ViewportRender");
         commandBuffer.beginRendering(colorImage, depthImage, {0, 0}, {extent.width, extent.height});
 
-        Camera* camera = &scene.getDefaultCamera();
-        if (scene.isMainCameraAvailable()) {
-            camera = scene.getMainCamera();
-        }
-        glm::mat4 viewProj = camera->getProj() * camera->getView();
+        glm::mat4 viewProj = snapshot.camera.proj * snapshot.camera.view;
 
         commandBuffer.setViewport(extent.width, extent.height);
         commandBuffer.setScissor(extent.width, extent.height);
@@ -137,40 +133,32 @@ public:
                             glm::vec3{0.2f, 0.2f, 0.2f}, 1.0f);
         }
 
-        // Draw scene objects
-        for (auto& object : scene.getObjects()) {
-            // Draw directional light
-            if (isLightVisible) {
-                if (const DirectionalLight* light = object.get<DirectionalLight>()) {
-                    lineDrawer.draw(commandBuffer, singleLineMesh,
-                                    viewProj * light->getRotationMatrix(),
-                                    glm::vec3{0.7f, 0.7f, 0.7f}, 2.0f);
-                }
+        // Draw directional light
+        if (isLightVisible) {
+            for (const glm::mat4& rotation : snapshot.directionalLightRotations) {
+                lineDrawer.draw(commandBuffer, singleLineMesh, viewProj * rotation,
+                                glm::vec3{0.7f, 0.7f, 0.7f}, 2.0f);
             }
+        }
 
-            // Draw camera
-            if (isCameraVisible) {
-                const Camera* _camera = object.get<Camera>();
-                if (_camera && camera != _camera) {
-                    glm::mat4 invProj = _camera->getInvProj();
-                    glm::mat4 invView = _camera->getInvView();
-                    glm::mat4 model = invView * invProj;
-                    lineDrawer.draw(commandBuffer, cubeLineMesh, viewProj * model,  //
-                                    glm::vec3{1.0f, 1.0f, 1.0f}, 2.0f);
-                }
+        // Draw camera
+        if (isCameraVisible) {
+            for (const glm::mat4& model : snapshot.cameraFrustums) {
+                lineDrawer.draw(commandBuffer, cubeLineMesh, viewProj * model,  //
+                                glm::vec3{1.0f, 1.0f, 1.0f}, 2.0f);
             }
+        }
 
-            // Draw AABB
-            if (isObjectAABBVisible) {
-                if (const Mesh* mesh = object.get<Mesh>()) {
-                    drawAABB(commandBuffer, mesh->getWorldAABB(), viewProj);
-                }
+        // Draw AABB
+        if (isObjectAABBVisible) {
+            for (const DrawPacket& packet : snapshot.drawPackets) {
+                drawAABB(commandBuffer, packet.worldAABB, viewProj);
             }
         }
 
         // Draw scene AABB
         if (isSceneAABBVisible) {
-            drawAABB(commandBuffer, scene.getAABB(), viewProj);
+            drawAABB(commandBuffer, snapshot.aabb, viewProj);
         }
 
         commandBuffer.endRendering();
@@ -9,7 +9,7 @@ public:
     static void show(Scene& scene, const Object* object) {
         if (ImGui::Begin("Attribute")) {
             if (object) {
-                for (const auto& comp : object->getComponents() | std::views::values) {
+                for (Component* comp : object->getComponents()) {
                     comp->showAttributes(scene);
                 }
             }
@@ -60,13 +60,19 @@ public:
             showTime("  Update", cpuUpdateTime);
             showTime("  Render", cpuRenderTime);
 
+            float deformTime = renderer.getPassTimeDeform();
+            float bakedTime = renderer.getPassTimeBakedAnimation();
             float shadowTime = renderer.getPassTimeShadow();
             float skyTime = renderer.getPassTimeSkybox();
             float forwardTime = renderer.getPassTimeForward();
             float ssrTime = renderer.getPassTimeSSR();
             float aaTime = renderer.getPassTimeAA();
 
-            showTime("GPU time", shadowTime + skyTime + forwardTime + ssrTime + aaTime);
+            showTime("GPU time",
+                     deformTime + bakedTime + shadowTime + skyTime + forwardTime + ssrTime +
+                         aaTime);
+            showTime("  Deform", deformTime);
+            showTime("  Baked animation", bakedTime);
             showTime("  Shadow map", shadowTime);
             showTime("  Skybox", skyTime);
             showTime("  Forward", forwardTime);
@@ -118,7 +124,7 @@ public:
         message |= showMiscWindow(context, scene, renderer);
 
         SceneWindow::show(scene, &selectedObject);
-        AttributeWindow::show(scene, selectedObject);
+        AttributeWindow::show(scene, scene.getObject(selectedObject));
         ViewportWindow::show(scene, imguiDescSet, &selectedObject);
         AssetWindow::show(context, scene);
 
@@ -169,7 +175,8 @@ public:
     vk::Format colorFormat{};
 
     // Editor
-    Object* selectedObject = nullptr;
+    // NOTE: オブジェクトの削除や再配置に追従できるようハンドルで保持する
+    ObjectHandle selectedObject{};
 
     rv::CPUTimer updateTimer;
     rv::CPUTimer renderTimer;
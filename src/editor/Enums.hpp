@@ -36,6 +36,10 @@ public:
         return Flags(e1.value | e2.value);
     }
 
+    friend Flags operator&(Flags e1, Flags e2) {
+        return Flags(e1.value & e2.value);
+    }
+
     friend Flags operator^(Flags e1, Flags e2) {
         return Flags(e1.value ^ e2.value);
     }
@@ -72,6 +76,7 @@ enum class SceneStatus {
     Texture2DAdded = 1 << 1,
     TextureCubeAdded = 1 << 2,
     Cleared = 1 << 3,
+    ObjectRemoved = 1 << 4,
 };
 
 using EditorMessageFlags = Flags<EditorMessage>;
@@ -84,7 +84,25 @@ public:
                     }
                     ImGui::Checkbox("Frustum culling", &Renderer::enableFrustumCulling);
                     ImGui::Checkbox("Sorting", &Renderer::enableSorting);
+                    ImGui::Checkbox("Cluster culling", &Renderer::enableClusterCulling);
                     ImGui::DragFloat("Exposure", &Renderer::exposure, 0.01f, 0.0f);
+                    MeshLodSettings& lod = Renderer::meshLodSettings;
+                    ImGui::Checkbox("Mesh LOD", &lod.enabled);
+                    if (lod.enabled) {
+                        ImGui::SliderFloat("LOD error (px)", &lod.errorPixels, 0.1f, 10.0f);
+                        ImGui::SliderFloat("Shadow LOD error (texel)", &lod.shadowErrorPixels,
+                                           0.1f, 20.0f);
+                        ImGui::SliderFloat("LOD hysteresis", &lod.hysteresis, 0.0f, 0.9f);
+                    }
+                    ImGui::EndMenu();
+                }
+                if (ImGui::BeginMenu("Animation")) {
+                    AnimationLodSettings& lod = Scene::animationLodSettings;
+                    ImGui::Checkbox("LOD", &lod.enabled);
+                    if (lod.enabled) {
+                        ImGui::SliderFloat("Half rate size", &lod.halfRateSize, 0.0f, 1.0f);
+                        ImGui::SliderFloat("Quarter rate size", &lod.quarterRateSize, 0.0f, 1.0f);
+                    }
                     ImGui::EndMenu();
                 }
                 ImGui::EndMenu();
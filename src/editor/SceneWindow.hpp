@@ -5,26 +5,72 @@
 
 class SceneWindow {
 public:
-    static void show(Scene& scene, Object** selectedObject) {
+    static void show(Scene& scene, ObjectHandle* selectedObject) {
         ImGui::Begin("Scene");
 
+        // Transform を持つオブジェクトは親子関係に沿って表示する
+        const SceneGraph& sceneGraph = scene.getSceneGraph();
+        uint32_t slot = 0;
+        while (slot < sceneGraph.getNodeCount()) {
+            slot = showNode(scene, sceneGraph, slot, selectedObject);
+        }
+
+        // ライトやカメラなど親子関係を持たないもの
         for (auto& object : scene.getObjects()) {
-            // Set flag
-            int flag = ImGuiTreeNodeFlags_OpenOnArrow;
-            if (&object == *selectedObject) {
-                flag = flag | ImGuiTreeNodeFlags_Selected;
+            if (!sceneGraph.contains(object.getIndex())) {
+                if (showObject(object, true, selectedObject)) {
+                    ImGui::TreePop();
+                }
             }
+        }
 
-            // Show object
-            bool open = ImGui::TreeNodeEx(object.getName().c_str(), flag);
-            if (ImGui::IsItemClicked()) {
-                *selectedObject = &object;
-            }
-            if (open) {
-                ImGui::TreePop();
-            }
+        // 選択中のオブジェクトを子孫ごと削除する
+        if (ImGui::IsWindowFocused() && ImGui::IsKeyPressed(ImGuiKey_Delete)) {
+            scene.removeObject(*selectedObject);
+            *selectedObject = {};
         }
 
         ImGui::End();
     }
+
+private:
+    // 部分木を表示し、次の兄弟のスロットを返す
+    static uint32_t showNode(Scene& scene,
+                             const SceneGraph& sceneGraph,
+                             uint32_t slot,
+                             ObjectHandle* selectedObject) {
+        uint32_t end = slot + sceneGraph.getSubtreeSize(slot);
+        Object& object = scene.getObjects()[sceneGraph.getObjectIndex(slot)];
+        if (showObject(object, end == slot + 1, selectedObject)) {
+            uint32_t child = slot + 1;
+            while (child < end) {
+                child = showNode(scene, sceneGraph, child, selectedObject);
+            }
+            ImGui::TreePop();
+        }
+        return end;
+    }
+
+    static bool showObject(const Object& object, bool isLeaf, ObjectHandle* selectedObject) {
+        // Set flag
+        int flag = ImGuiTreeNodeFlags_OpenOnArrow;
+        if (isLeaf) {
+            flag = flag | ImGuiTreeNodeFlags_Leaf;
+        }
+        if (object.getHandle() == *selectedObject) {
+            flag = flag | ImGuiTreeNodeFlags_Selected;
+        }
+
+        // Show object
+        // NOTE: string_view は終端文字を前提にできないため長さを指定して表示する
+        //       IDはスロットのインデックスで固定する
+        std::string_view name = object.getName();
+        void* id = reinterpret_cast<void*>(static_cast<intptr_t>(object.getIndex()));
+        bool open = ImGui::TreeNodeEx(id, flag, "%.*s", static_cast<int>(name.size()),
+                                      name.data());
+        if (ImGui::IsItemClicked()) {
+            *selectedObject = object.getHandle();
+        }
+        return open;
+    }
 };
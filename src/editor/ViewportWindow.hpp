@@ -55,15 +55,23 @@ public:
             return;
         }
 
-        glm::mat4 model = transform->computeTransformMatrix();
+        // NOTE: ギズモはワールド空間で操作し、親のワールド行列の逆行列でローカルに戻す
+        const SceneGraph& sceneGraph = scene.getSceneGraph();
+        uint32_t index = selectedObject->getIndex();
+        glm::mat4 parentWorld = sceneGraph.getParentWorldMatrix(index);
+        glm::mat4 model = parentWorld * transform->computeTransformMatrix();
         Camera* camera = scene.isMainCameraAvailable()  //
                              ? scene.getMainCamera()
                              : &scene.getDefaultCamera();
-        transform->changed |= editTransform(*camera, model);
+        if (!editTransform(*camera, model)) {
+            return;
+        }
+        scene.markChanged(*transform, ChangeField::Transform);
 
+        glm::mat4 local = glm::inverse(parentWorld) * model;
         glm::vec3 skew;
         glm::vec4 perspective;
-        glm::decompose(model, transform->scale, transform->rotation, transform->translation, skew,
+        glm::decompose(local, transform->scale, transform->rotation, transform->translation, skew,
                        perspective);
     }
 
@@ -113,7 +121,7 @@ public:
         ImGui::Image((ImTextureID)(VkDescriptorSet)auxiliaryDescSet, ImVec2(imageWidth, imageHeight));
     }
 
-    static void pickObject(Scene& scene, Object** selectedObject) {
+    static void pickObject(Scene& scene, ObjectHandle* selectedObject) {
         // NOTE: Clicked()を使うとドラッグ開始時にも反応してしまうためReleased()を使う
         // NOTE: リリースされたときにマウスが動いていたらクリックではないと判定する
         if (!ImGui::IsWindowFocused() || ImGuizmo::IsUsing() ||
@@ -141,22 +149,22 @@ public:
         ray.direction = glm::normalize(worldPos.xyz - ray.origin);
 
         float tmin = std::numeric_limits<float>::max();
-        for (auto& obj : scene.getObjects()) {
-            Mesh* mesh = obj.get<Mesh>();
+        for (uint32_t index : scene.queryObjects<Mesh>()) {
             float t;
-            if (mesh && ray.intersect(mesh->getWorldAABB(), t) && t < tmin) {
+            const rv::AABB& aabb = scene.getWorldAABB(index);
+            if (ray.intersect(aabb, t) && t < tmin) {
                 tmin = t;
-                *selectedObject = &obj;
+                *selectedObject = scene.getObjects()[index].getHandle();
             }
         }
 
         // 何にもヒットしなかったら選択を解除する
         if (tmin == std::numeric_limits<float>::max()) {
-            *selectedObject = nullptr;
+            *selectedObject = {};
         }
     }
 
-    static void show(Scene& scene, vk::DescriptorSet image, Object** selectedObject) {
+    static void show(Scene& scene, vk::DescriptorSet image, ObjectHandle* selectedObject) {
         // TODO: support animation
         if (ImGui::Begin("Viewport")) {
             processMouseInput();
@@ -178,7 +186,7 @@ public:
             }
 
             if (isGizmoVisible) {
-                showGizmo(scene, *selectedObject);
+                showGizmo(scene, scene.getObject(*selectedObject));
             }
 
             if (ImGui::IsMouseReleased(ImGuiMouseButton_Left)) {
@@ -1,8 +1,14 @@
 #include "MainApp.hpp"
 
-int main() {
+int main(int argc, char* argv[]) {
     try {
         MainApp app{};
+
+        // --cook [scene.json ...] でシーンパックを書き出して終了する
+        if (argc >= 2 && std::string_view{argv[1]} == "--cook") {
+            app.cook({argv + 2, argv + argc});
+            return 0;
+        }
         app.run();
     } catch (const std::exception& e) {
         spdlog::error(e.what());
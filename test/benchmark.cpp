@@ -0,0 +1,218 @@
+// コンポーネント参照のマイクロベンチマーク
+// 1. std::map<std::type_index> をオブジェクトごとに持ち、contains() + at() で引く (旧実装)
+// 2. std::unordered_map<std::type_index> で型ごとのプールを引き、sparse set で引く
+// 3. コンパイル時のコンポーネントIDでマスクを調べ、固定長配列のプールを引く (現行実装)
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <memory>
+#include <random>
+#include <typeindex>
+#include <unordered_map>
+#include <vector>
+
+#include "../src/ComponentID.hpp"
+
+namespace {
+struct Component {
+    virtual ~Component() = default;
+    float value = 1.0f;
+};
+
+struct Transform final : Component {};
+struct Mesh final : Component {};
+struct Camera final : Component {};
+struct DirectionalLight final : Component {};
+struct PointLight final : Component {};
+struct AmbientLight final : Component {};
+
+using Components = ComponentRegistry<
+    TypeList<Transform, Mesh, Camera, DirectionalLight, PointLight, AmbientLight>>;
+
+constexpr uint32_t invalidIndex = UINT32_MAX;
+
+struct PoolBase {
+    virtual ~PoolBase() = default;
+};
+
+template <typename T>
+struct Pool final : PoolBase {
+    void emplace(uint32_t objectIndex) {
+        if (objectIndex >= sparse.size()) {
+            sparse.resize(objectIndex + 1, invalidIndex);
+        }
+        sparse[objectIndex] = static_cast<uint32_t>(components.size());
+        components.emplace_back();
+    }
+
+    T* get(uint32_t objectIndex) {
+        if (objectIndex >= sparse.size() || sparse[objectIndex] == invalidIndex) {
+            return nullptr;
+        }
+        return &components[sparse[objectIndex]];
+    }
+
+    T& getUnchecked(uint32_t objectIndex) {
+        return components[sparse[objectIndex]];
+    }
+
+    std::vector<T> components;
+    std::vector<uint32_t> sparse;
+};
+
+// 1. 旧実装
+struct MapObject {
+    template <typename T>
+    void add() {
+        components[std::type_index{typeid(T)}] = std::make_unique<T>();
+    }
+
+    template <typename T>
+    T* get() {
+        const std::type_index& index = {typeid(T)};
+        if (components.contains(index)) {
+            return static_cast<T*>(components.at(index).get());
+        }
+        return nullptr;
+    }
+
+    std::map<std::type_index, std::unique_ptr<Component>> components;
+};
+
+// 2. type_index でプールを引く
+struct TypeIndexScene {
+    template <typename T>
+    void add(uint32_t objectIndex) {
+        auto& pool = pools[std::type_index{typeid(T)}];
+        if (!pool) {
+            pool = std::make_unique<Pool<T>>();
+        }
+        static_cast<Pool<T>*>(pool.get())->emplace(objectIndex);
+    }
+
+    template <typename T>
+    T* get(uint32_t objectIndex) {
+        auto it = pools.find(std::type_index{typeid(T)});
+        if (it == pools.end()) {
+            return nullptr;
+        }
+        return static_cast<Pool<T>*>(it->second.get())->get(objectIndex);
+    }
+
+    std::unordered_map<std::type_index, std::unique_ptr<PoolBase>> pools;
+};
+
+// 3. コンポーネントID
+struct IDScene {
+    template <typename T>
+    void add(uint32_t objectIndex) {
+        auto& pool = pools[Components::id<T>];
+        if (!pool) {
+            pool = std::make_unique<Pool<T>>();
+        }
+        static_cast<Pool<T>*>(pool.get())->emplace(objectIndex);
+        masks[objectIndex] |= Components::bit<T>;
+    }
+
+    template <typename T>
+    T* get(uint32_t objectIndex) {
+        if (!(masks[objectIndex] & Components::bit<T>)) {
+            return nullptr;
+        }
+        return &static_cast<Pool<T>*>(pools[Components::id<T>].get())->getUnchecked(objectIndex);
+    }
+
+    std::vector<Components::Mask> masks;
+    std::array<std::unique_ptr<PoolBase>, Components::count> pools;
+};
+
+template <typename Func>
+double measure(const char* label, int iterations, Func func) {
+    // ウォームアップ
+    float sink = func();
+
+    auto begin = std::chrono::high_resolution_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        sink += func();
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - begin).count() / iterations;
+    std::printf("%-32s %8.4f ms  (checksum %.0f)\n", label, ms, sink);
+    return ms;
+}
+
+// シーン内の典型的な参照パターン: Transform と Mesh を引き、Camera の有無を調べる
+template <typename GetFunc>
+float touchAll(uint32_t objectCount, GetFunc get) {
+    float sum = 0.0f;
+    for (uint32_t i = 0; i < objectCount; i++) {
+        sum += get.template operator()<Transform>(i);
+        sum += get.template operator()<Mesh>(i);
+        sum += get.template operator()<Camera>(i);
+    }
+    return sum;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    uint32_t objectCount = argc > 1 ? static_cast<uint32_t>(std::atoi(argv[1])) : 100000;
+    int iterations = argc > 2 ? std::atoi(argv[2]) : 100;
+
+    std::vector<MapObject> mapObjects(objectCount);
+    TypeIndexScene typeIndexScene;
+    IDScene idScene;
+    idScene.masks.resize(objectCount);
+
+    // 全オブジェクトが Transform を持ち、多くが Mesh、一部が Light や Camera を持つ
+    std::mt19937 rng{42};
+    std::uniform_int_distribution<int> dist{0, 99};
+    for (uint32_t i = 0; i < objectCount; i++) {
+        int r = dist(rng);
+        mapObjects[i].add<Transform>();
+        typeIndexScene.add<Transform>(i);
+        idScene.add<Transform>(i);
+        if (r < 80) {
+            mapObjects[i].add<Mesh>();
+            typeIndexScene.add<Mesh>(i);
+            idScene.add<Mesh>(i);
+        } else if (r < 95) {
+            mapObjects[i].add<PointLight>();
+            typeIndexScene.add<PointLight>(i);
+            idScene.add<PointLight>(i);
+        } else {
+            mapObjects[i].add<Camera>();
+            typeIndexScene.add<Camera>(i);
+            idScene.add<Camera>(i);
+        }
+    }
+
+    std::printf("objects: %u, iterations: %d\n", objectCount, iterations);
+
+    double mapTime = measure("map<type_index> contains+at", iterations, [&] {
+        return touchAll(objectCount, [&]<typename T>(uint32_t i) {
+            T* component = mapObjects[i].get<T>();
+            return component ? component->value : 0.0f;
+        });
+    });
+
+    double typeIndexTime = measure("unordered_map<type_index> pool", iterations, [&] {
+        return touchAll(objectCount, [&]<typename T>(uint32_t i) {
+            T* component = typeIndexScene.get<T>(i);
+            return component ? component->value : 0.0f;
+        });
+    });
+
+    double idTime = measure("component ID + mask", iterations, [&] {
+        return touchAll(objectCount, [&]<typename T>(uint32_t i) {
+            T* component = idScene.get<T>(i);
+            return component ? component->value : 0.0f;
+        });
+    });
+
+    std::printf("speedup vs map: %.2fx, vs type_index pool: %.2fx\n",  //
+                mapTime / idTime, typeIndexTime / idTime);
+    return 0;
+}
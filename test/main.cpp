@@ -1,10 +1,64 @@
 // Add gtest
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+
 #include <reactive/Scene/AABB.hpp>
 #include <reactive/Scene/Camera.hpp>
 #include <reactive/Scene/Frustum.hpp>
 
+#include <glm/gtc/matrix_transform.hpp>
+
+#include "../src/Accessor.hpp"
+#include "../src/Animation.hpp"
+#include "../src/BoundsTree.hpp"
+#include "../src/ChangeJournal.hpp"
+#include "../src/ComponentID.hpp"
+#include "../src/JobSystem.hpp"
+#include "../src/MeshCluster.hpp"
+#include "../src/MeshLod.hpp"
+#include "../src/MeshOptimizer.hpp"
+#include "../src/Morph.hpp"
+#include "../src/NameRegistry.hpp"
+#include "../src/Object.hpp"
+#include "../src/Scene.hpp"
+#include "../src/SceneGraph.hpp"
+#include "../src/ScenePack.hpp"
+#include "../src/Skinning.hpp"
+#include "../src/SlotMap.hpp"
+
+// 変形 (スキニング、モーフターゲット) のテストで使う頂点
+struct DeformVertex {
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec4 tangent;
+};
+
+// xy 平面上の平らな格子 (n x n の四角形) を、頂点を共有するインデックスで作る。法線は +z
+static void buildGrid(uint32_t n,
+                      std::vector<glm::vec3>& positions,
+                      std::vector<uint32_t>& indices) {
+    for (uint32_t y = 0; y <= n; y++) {
+        for (uint32_t x = 0; x <= n; x++) {
+            positions.push_back(glm::vec3{x, y, 0});
+        }
+    }
+    for (uint32_t y = 0; y < n; y++) {
+        for (uint32_t x = 0; x < n; x++) {
+            uint32_t i00 = y * (n + 1) + x;
+            uint32_t i10 = i00 + 1;
+            uint32_t i01 = i00 + n + 1;
+            uint32_t i11 = i01 + 1;
+            indices.insert(indices.end(), {i00, i10, i01, i01, i10, i11});
+        }
+    }
+}
+
 // Camera coordinate system
 TEST(OrbitalCameraTest, Camera) {
     rv::Camera camera{};
@@ -117,6 +171,1028 @@ TEST(FrustumAABBTest, FrustumAABB) {
     EXPECT_FALSE(aabb.isOnFrustum(frustum));
 }
 
+TEST(AABBTest, Transform) {
+    // Arvo の方法で変換した AABB は、8つの角を変換して包んだものと一致する
+    rv::AABB aabb{glm::vec3{-1.0f, 0.0f, 2.0f}, glm::vec3{3.0f, 1.0f, 4.0f}};
+    glm::mat4 rotation =
+        glm::rotate(glm::mat4{1.0f}, 0.7f, glm::normalize(glm::vec3{1.0f, 2.0f, 3.0f}));
+    glm::mat4 translation = glm::translate(glm::mat4{1.0f}, glm::vec3{5.0f, -2.0f, 1.0f});
+    std::array<glm::mat4, 3> matrices = {
+        rotation,
+        translation * rotation * glm::scale(glm::mat4{1.0f}, glm::vec3{2.0f, 0.5f, 3.0f}),
+        translation * rotation * glm::scale(glm::mat4{1.0f}, glm::vec3{-1.0f, 2.0f, 1.0f}),
+    };
+    for (const glm::mat4& matrix : matrices) {
+        glm::vec3 min{std::numeric_limits<float>::max()};
+        glm::vec3 max{-std::numeric_limits<float>::max()};
+        for (int corner = 0; corner < 8; corner++) {
+            glm::vec3 sign{corner & 1 ? 1.0f : -1.0f, corner & 2 ? 1.0f : -1.0f,
+                           corner & 4 ? 1.0f : -1.0f};
+            glm::vec3 position{matrix * glm::vec4{aabb.center + sign * aabb.extents, 1.0f}};
+            min = glm::min(min, position);
+            max = glm::max(max, position);
+        }
+        rv::AABB transformed = transformAABB(aabb, matrix);
+        for (int i = 0; i < 3; i++) {
+            EXPECT_NEAR(transformed.center[i], (min[i] + max[i]) * 0.5f, 1e-4f);
+            EXPECT_NEAR(transformed.extents[i], (max[i] - min[i]) * 0.5f, 1e-4f);
+        }
+    }
+}
+
+// Bounds tree
+TEST(BoundsTreeTest, RootAABB) {
+    BoundsTree tree;
+    EXPECT_TRUE(tree.empty());
+
+    uint32_t a = tree.insert(rv::AABB{glm::vec3(-1.0f), glm::vec3(1.0f)}, 0);
+    uint32_t b = tree.insert(rv::AABB{glm::vec3(4.0f), glm::vec3(6.0f)}, 1);
+    tree.insert(rv::AABB{glm::vec3(-3.0f), glm::vec3(-2.0f)}, 2);
+    EXPECT_EQ(tree.size(), 3u);
+    EXPECT_EQ(tree.getUserData(b), 1u);
+    EXPECT_EQ(tree.getRootAABB().center, glm::vec3(1.5f));
+    EXPECT_EQ(tree.getRootAABB().extents, glm::vec3(4.5f));
+
+    // 動かすと根も縮む
+    tree.update(b, rv::AABB{glm::vec3(0.0f), glm::vec3(2.0f)});
+    EXPECT_EQ(tree.getRootAABB().center, glm::vec3(-0.5f));
+    EXPECT_EQ(tree.getRootAABB().extents, glm::vec3(2.5f));
+
+    tree.remove(a);
+    tree.remove(b);
+    EXPECT_EQ(tree.getRootAABB().center, glm::vec3(-2.5f));
+    EXPECT_EQ(tree.getRootAABB().extents, glm::vec3(0.5f));
+}
+
+// Slot map
+TEST(SlotMapTest, EraseAndReuse) {
+    SlotMap<int> map;
+    Handle<int> a = map.emplace(1);
+    Handle<int> b = map.emplace(2);
+    EXPECT_EQ(map.size(), 2u);
+    EXPECT_EQ(*map.get(b), 2);
+
+    // 消したハンドルは無効になる
+    EXPECT_TRUE(map.erase(a));
+    EXPECT_FALSE(map.erase(a));
+    EXPECT_FALSE(map.contains(a));
+    EXPECT_EQ(map.get(a), nullptr);
+    EXPECT_EQ(map.size(), 1u);
+
+    // 同じスロットを世代番号を進めて再利用し、古いハンドルは無効のまま
+    Handle<int> c = map.emplace(3);
+    EXPECT_EQ(c.index, a.index);
+    EXPECT_EQ(c.generation, a.generation + 1);
+    EXPECT_FALSE(map.contains(a));
+    EXPECT_EQ(*map.get(c), 3);
+    EXPECT_EQ(map.getSlotCount(), 2u);
+}
+
+TEST(SlotMapTest, CompactAndClear) {
+    SlotMap<int> map;
+    std::vector<Handle<int>> handles;
+    for (int i = 0; i < 4; i++) {
+        handles.push_back(map.emplace(i));
+    }
+
+    // 末尾の空きスロットだけを切り詰め、途中の空きスロットは再利用できるまま残す
+    map.erase(handles[1]);
+    map.erase(handles[2]);
+    map.erase(handles[3]);
+    map.compact();
+    EXPECT_EQ(map.getSlotCount(), 1u);
+    EXPECT_EQ(*map.get(handles[0]), 0);
+    Handle<int> reused = map.emplace(5);
+    EXPECT_EQ(reused.index, 1u);
+    EXPECT_EQ(map.getSlotCount(), 2u);
+
+    // 切り詰めたスロットの古いハンドルは、同じ番号に追加し直しても無効のまま
+    Handle<int> appended = map.emplace(6);
+    EXPECT_EQ(appended.index, handles[2].index);
+    EXPECT_FALSE(map.contains(handles[2]));
+    EXPECT_TRUE(map.contains(appended));
+
+    // clear すると全てのハンドルが無効になる
+    map.clear();
+    EXPECT_TRUE(map.empty());
+    EXPECT_FALSE(map.contains(handles[0]));
+    EXPECT_FALSE(map.contains(reused));
+    Handle<int> fresh = map.emplace(7);
+    EXPECT_EQ(fresh.index, 0u);
+    EXPECT_FALSE(map.contains(handles[0]));
+    EXPECT_TRUE(map.contains(fresh));
+}
+
+// Scene graph
+TEST(SceneGraphTest, WorldMatrix) {
+    auto translate = [](float x) { return glm::translate(glm::mat4{1.0f}, glm::vec3{x, 0.0f, 0.0f}); };
+
+    // 0 -> 1 -> 2, 3
+    SceneGraph graph;
+    for (uint32_t i = 0; i < 4; i++) {
+        graph.add(i);
+        graph.setLocalMatrix(i, translate(1.0f));
+    }
+    EXPECT_TRUE(graph.setParent(2, 1));
+    EXPECT_TRUE(graph.setParent(1, 0));
+    EXPECT_FALSE(graph.setParent(0, 2));  // cycle
+
+    std::vector<uint32_t> changed;
+    graph.update(changed);
+    EXPECT_EQ(changed.size(), 4u);
+    EXPECT_EQ(graph.getWorldMatrix(2)[3].x, 3.0f);
+    EXPECT_EQ(graph.getWorldMatrix(3)[3].x, 1.0f);
+
+    // 親は子より前に並ぶ
+    for (uint32_t slot = 0; slot < graph.getNodeCount(); slot++) {
+        EXPECT_TRUE(graph.getParentSlot(slot) == SceneGraph::nullIndex ||
+                    graph.getParentSlot(slot) < slot);
+    }
+    EXPECT_EQ(graph.getSubtreeSize(0), 3u);
+
+    // 変更のあった部分木だけ計算し直す
+    changed.clear();
+    graph.setLocalMatrix(1, translate(5.0f));
+    graph.update(changed);
+    EXPECT_EQ(changed, (std::vector<uint32_t>{1, 2}));
+    EXPECT_EQ(graph.getWorldMatrix(2)[3].x, 7.0f);
+
+    std::vector<uint32_t> descendants;
+    graph.collectDescendants(0, descendants);
+    EXPECT_EQ(descendants, (std::vector<uint32_t>{1, 2}));
+
+    // 削除すると子は親に付け替えられる
+    graph.remove(1);
+    EXPECT_EQ(graph.getParent(2), 0u);
+    EXPECT_EQ(graph.getSubtreeSize(0), 2u);
+
+    // 部分木ごと削除する
+    graph.removeSubtree(0);
+    EXPECT_FALSE(graph.contains(2));
+    EXPECT_EQ(graph.getNodeCount(), 1u);
+}
+
+TEST(SceneGraphTest, NormalMatrix) {
+    SceneGraph graph;
+    graph.add(0);
+    graph.setLocalMatrix(0, glm::scale(glm::mat4{1.0f}, glm::vec3{2.0f, 4.0f, 1.0f}));
+
+    std::vector<uint32_t> changed;
+    graph.update(changed);
+    EXPECT_FLOAT_EQ(graph.getNormalMatrix(0)[0].x, 0.5f);
+    EXPECT_FLOAT_EQ(graph.getNormalMatrix(0)[1].y, 0.25f);
+    EXPECT_FLOAT_EQ(graph.getNormalMatrix(0)[2].z, 1.0f);
+}
+
+// Scene
+TEST(SceneTest, RemoveObject) {
+    JobSystem jobSystem{2};
+    Scene scene;
+    scene.init(jobSystem);
+    auto addMeshObject = [&](std::string_view name, ObjectHandle parent) {
+        Object& object = scene.addObject(name);
+        scene.addComponent<Transform>(object);
+        scene.addComponent<Mesh>(object).aabb = rv::AABB{glm::vec3{-1.0f}, glm::vec3{1.0f}};
+        if (const Object* parentObject = scene.getObject(parent)) {
+            scene.setParent(object, parentObject);
+        }
+        return object.getHandle();
+    };
+    ObjectHandle parent = addMeshObject("Parent", {});
+    ObjectHandle child = addMeshObject("Child", parent);
+    ObjectHandle grandchild = addMeshObject("Grandchild", child);
+    ObjectHandle other = addMeshObject("Other", {});
+    scene.update(0.0f);
+    EXPECT_EQ(scene.getBoundsTree().size(), 4u);
+
+    // 子孫ごと消え、古いハンドルは無効になる
+    EXPECT_TRUE(scene.removeObject(parent));
+    EXPECT_FALSE(scene.removeObject(parent));
+    for (ObjectHandle handle : {parent, child, grandchild}) {
+        EXPECT_EQ(scene.getObject(handle), nullptr);
+    }
+    EXPECT_NE(scene.getObject(other), nullptr);
+    EXPECT_EQ(scene.countObjects<Transform>(), 1u);
+    EXPECT_EQ(scene.countObjects<Mesh>(), 1u);
+    EXPECT_EQ(scene.findObject("Child"), nullptr);
+    EXPECT_EQ(scene.getBoundsTree().size(), 1u);
+    EXPECT_EQ(scene.getSceneGraph().getNodeCount(), 1u);
+
+    // 空いたスロットを再利用するので、スロット数は増えない
+    ObjectHandle reused = scene.addObject("Child").getHandle();
+    EXPECT_TRUE(reused.index == parent.index || reused.index == child.index ||
+                reused.index == grandchild.index);
+    EXPECT_EQ(scene.getObjects().getSlotCount(), 4u);
+    EXPECT_EQ(scene.getObject(child), nullptr);
+    EXPECT_EQ(scene.findObject("Child")->getHandle(), reused);
+}
+
+TEST(SceneTest, SkinnedAABB) {
+    JobSystem jobSystem{2};
+    Scene scene;
+    scene.init(jobSystem);
+    Object& meshObject = scene.addObject("Mesh");
+    uint32_t meshIndex = meshObject.getIndex();
+    scene.addComponent<Transform>(meshObject);
+    Mesh& mesh = scene.addComponent<Mesh>(meshObject);
+    std::vector<uint32_t> joints;
+    for (std::string_view name : {"Joint0", "Joint1"}) {
+        Object& joint = scene.addObject(name);
+        scene.addComponent<Transform>(joint);
+        joints.push_back(joint.getIndex());
+    }
+    Transform* joint1 = scene.getObjects()[joints[1]].get<Transform>();
+    joint1->translation = glm::vec3{0.0f, 1.0f, 0.0f};
+
+    // 関節0 だけ、両方、関節1 だけ、ウェイト無しの頂点を y に並べる
+    MeshData* data = scene.getMeshData(scene.getSceneMeshData());
+    data->vertices.resize(4);
+    for (uint32_t i = 0; i < 4; i++) {
+        data->vertices[i].position = glm::vec3{0.0f, static_cast<float>(i), 0.0f};
+    }
+    data->skinVertices = {
+        {glm::uvec4{0, 0, 0, 0}, glm::vec4{1.0f, 0.0f, 0.0f, 0.0f}},
+        {glm::uvec4{0, 1, 0, 0}, glm::vec4{0.5f, 0.5f, 0.0f, 0.0f}},
+        {glm::uvec4{1, 0, 0, 0}, glm::vec4{1.0f, 0.0f, 0.0f, 0.0f}},
+        {glm::uvec4{0, 0, 0, 0}, glm::vec4{0.0f}},
+    };
+    mesh.meshData = scene.getSceneMeshData();
+    mesh.vertexCount = 4;
+    std::vector<glm::mat4> inverseBindMatrices = {
+        glm::mat4{1.0f},
+        glm::translate(glm::mat4{1.0f}, glm::vec3{0.0f, -1.0f, 0.0f}),
+    };
+    scene.addSkin(meshIndex, joints, inverseBindMatrices);
+
+    // バインドポーズでは頂点をちょうど包む
+    scene.update(0.0f);
+    glm::vec3 min = mesh.aabb.center - mesh.aabb.extents;
+    glm::vec3 max = mesh.aabb.center + mesh.aabb.extents;
+    EXPECT_NEAR(min.y, 0.0f, 1e-5f);
+    EXPECT_NEAR(max.y, 3.0f, 1e-5f);
+    EXPECT_NEAR(max.x, 0.0f, 1e-5f);
+
+    // 関節1 を x に 5 動かすと、関節1 で動く頂点を含むように広がる
+    joint1->translation = glm::vec3{5.0f, 1.0f, 0.0f};
+    scene.markChanged(*joint1, ChangeField::Transform);
+    scene.update(0.0f);
+    max = mesh.aabb.center + mesh.aabb.extents;
+    EXPECT_NEAR(max.x, 5.0f, 1e-5f);
+    const rv::AABB& worldAABB = scene.getWorldAABB(meshIndex);
+    EXPECT_NEAR(worldAABB.center.x + worldAABB.extents.x, 5.0f, 1e-5f);
+}
+
+TEST(SceneTest, TextureFormats) {
+    // 1x1 まで半分ずつ縮める (長い方の辺で決まる)
+    EXPECT_EQ(Scene::computeMipLevelCount(1, 1), 1u);
+    EXPECT_EQ(Scene::computeMipLevelCount(1024, 512), 11u);
+    EXPECT_EQ(Scene::computeMipLevelCount(1000, 3), 10u);
+    EXPECT_EQ(Scene::computeMipLevelCount(5, 7), 3u);
+    EXPECT_EQ(Scene::computeMipLevelCount(0, 0), 1u);
+
+    // ベースカラーとエミッシブだけが sRGB
+    tinygltf::Model model;
+    model.textures.resize(4);
+    tinygltf::Material& material = model.materials.emplace_back();
+    material.pbrMetallicRoughness.baseColorTexture.index = 2;
+    material.emissiveTexture.index = 0;
+    material.normalTexture.index = 1;
+    material.pbrMetallicRoughness.metallicRoughnessTexture.index = 3;
+    EXPECT_EQ(Scene::findSrgbTextures(model), (std::vector<uint8_t>{1, 0, 1, 0}));
+
+    // 範囲外のインデックスは無視する
+    material.emissiveTexture.index = 4;
+    EXPECT_EQ(Scene::findSrgbTextures(model), (std::vector<uint8_t>{0, 0, 1, 0}));
+}
+
+// Component ID
+TEST(ComponentRegistryTest, ComponentID) {
+    struct A;
+    struct B;
+    struct C;
+    using Registry = ComponentRegistry<TypeList<A, B, C>>;
+    static_assert(Registry::count == 3);
+    static_assert(Registry::id<A> == 0);
+    static_assert(Registry::id<const C> == 2);
+
+    Registry::Mask mask = Registry::bit<A> | Registry::bit<C>;
+    EXPECT_TRUE(mask & Registry::bit<A>);
+    EXPECT_FALSE(mask & Registry::bit<B>);
+    EXPECT_TRUE(mask & Registry::bit<C>);
+}
+
+// Unique name
+TEST(NameRegistryTest, UniqueName) {
+    using TestHandle = Handle<int>;
+    NameRegistry<TestHandle> registry;
+    EXPECT_EQ(registry.add("Cube", {0}), "Cube");
+    EXPECT_EQ(registry.add("Cube", {1}), "Cube 0");
+    EXPECT_EQ(registry.add("Cube 0", {2}), "Cube 0 0");
+    EXPECT_EQ(registry.add("Cube", {3}), "Cube 1");
+    EXPECT_EQ(registry.find("Cube 1").index, 3);
+    EXPECT_FALSE(registry.find("Sphere").isValid());
+
+    registry.remove("Cube");
+    EXPECT_FALSE(registry.find("Cube").isValid());
+    EXPECT_EQ(registry.add("Cube", {4}), "Cube");
+}
+
+// Job system
+TEST(JobSystemTest, ParallelFor) {
+    JobSystem jobSystem{4};
+    std::vector<int> values(10000, 0);
+    PerThread<int> counts{jobSystem.getThreadCount()};
+    uint32_t count = static_cast<uint32_t>(values.size());
+    jobSystem.parallelFor(count, 100, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            values[i]++;
+            counts.local()++;
+        }
+    });
+
+    int total = 0;
+    counts.forEach([&](int count) { total += count; });
+    EXPECT_EQ(total, 10000);
+    EXPECT_TRUE(std::ranges::all_of(values, [](int value) { return value == 1; }));
+}
+
+TEST(JobSystemTest, TaskGraph) {
+    JobSystem jobSystem{4};
+    std::atomic<int> order = 0;
+    int a = -1, b = -1, c = -1, d = -1;
+
+    // a -> (b, c) -> d
+    TaskGraph graph;
+    auto taskA = graph.add([&]() { a = order++; });
+    auto taskB = graph.add([&]() { b = order++; });
+    auto taskC = graph.add([&]() { c = order++; });
+    auto taskD = graph.add([&]() { d = order++; });
+    graph.precede(taskA, taskB);
+    graph.precede(taskA, taskC);
+    graph.precede(taskB, taskD);
+    graph.precede(taskC, taskD);
+    graph.run(jobSystem);
+
+    EXPECT_EQ(a, 0);
+    EXPECT_LT(a, b);
+    EXPECT_LT(a, c);
+    EXPECT_EQ(d, 3);
+}
+
+// Change journal
+TEST(ChangeJournalTest, MergeRecords) {
+    JobSystem jobSystem{4};
+    ChangeJournal journal;
+    journal.init(2, jobSystem.getThreadCount());
+
+    // 同じ (オブジェクト, コンポーネント) の記録は一つにまとめられる
+    jobSystem.parallelFor(1000, 10, [&](uint32_t begin, uint32_t end) {
+        for (uint32_t i = begin; i < end; i++) {
+            journal.record(i % 10, 0, ChangeField::Transform);
+        }
+    });
+    journal.record(3, 0, ChangeField::Material);
+    journal.record(3, 1, ChangeField::Geometry);
+    journal.flush();
+
+    auto records = journal.getRecords();
+    ASSERT_EQ(records.size(), 11u);
+    EXPECT_EQ(records[3].objectIndex, 3u);
+    EXPECT_TRUE(records[3].fields & ChangeField::Transform);
+    EXPECT_TRUE(records[3].fields & ChangeField::Material);
+    EXPECT_EQ(records[4].componentID, 1u);
+
+    EXPECT_TRUE(journal.isDirty(0, 9u));
+    EXPECT_FALSE(journal.isDirty(1, 9u));
+    EXPECT_TRUE(journal.isDirty(1, ChangeField::Geometry));
+    EXPECT_FALSE(journal.isDirty(1, ChangeField::Material));
+
+    journal.discard(3);
+    EXPECT_EQ(journal.getRecords().size(), 9u);
+    EXPECT_FALSE(journal.isDirty(0, 3u));
+
+    journal.clearRecords();
+    EXPECT_TRUE(journal.getRecords().empty());
+    EXPECT_FALSE(journal.isDirty(0, 0u));
+    EXPECT_FALSE(journal.isDirty(0, ChangeField::Transform));
+}
+
+TEST(AnimationTest, SampleTracks) {
+    AnimationTracks<glm::vec3> tracks;
+    std::vector<float> times = {0.0f, 1.0f, 2.0f};
+    std::vector<glm::vec3> values = {glm::vec3{0.0f}, glm::vec3{1.0f}, glm::vec3{3.0f}};
+    tracks.add(0, Interpolation::Linear, times, values);
+    tracks.add(1, Interpolation::Step, times, values);
+
+    // CUBICSPLINE は (inTangent, value, outTangent) の組
+    // 接線が 0 なら端点では値そのもの、中点では平均になる
+    std::vector<glm::vec3> cubicValues = {
+        glm::vec3{0.0f}, glm::vec3{0.0f}, glm::vec3{0.0f},  //
+        glm::vec3{0.0f}, glm::vec3{2.0f}, glm::vec3{0.0f},  //
+        glm::vec3{0.0f}, glm::vec3{2.0f}, glm::vec3{0.0f},
+    };
+    tracks.add(2, Interpolation::CubicSpline, times, cubicValues);
+    EXPECT_EQ(tracks.getDuration(), 2.0f);
+
+    tracks.sample(0.5f, 0, tracks.size());
+    EXPECT_FLOAT_EQ(tracks.getResults()[0].x, 0.5f);
+    EXPECT_FLOAT_EQ(tracks.getResults()[1].x, 0.0f);
+    EXPECT_FLOAT_EQ(tracks.getResults()[2].x, 1.0f);
+
+    tracks.sample(1.5f, 0, tracks.size());
+    EXPECT_FLOAT_EQ(tracks.getResults()[0].x, 2.0f);
+    EXPECT_FLOAT_EQ(tracks.getResults()[1].x, 1.0f);
+    EXPECT_FLOAT_EQ(tracks.getResults()[2].x, 2.0f);
+
+    // 巻き戻しと範囲外
+    tracks.sample(0.25f, 0, 1);
+    EXPECT_FLOAT_EQ(tracks.getResults()[0].x, 0.25f);
+    tracks.sample(5.0f, 0, 1);
+    EXPECT_FLOAT_EQ(tracks.getResults()[0].x, 3.0f);
+
+    tracks.removeTarget(1);
+    EXPECT_EQ(tracks.getTargets()[1], AnimationTracks<glm::vec3>::invalidTarget);
+}
+
+TEST(AnimationTest, LoopTime) {
+    AnimationClip clip;
+    std::vector<float> times = {0.0f, 2.0f};
+    std::vector<glm::vec3> values = {glm::vec3{0.0f}, glm::vec3{1.0f}};
+    clip.translations.add(0, Interpolation::Linear, times, values);
+
+    AnimationPlayer player;
+    player.addClip(std::move(clip));
+
+    // 長時間再生しても誤差が蓄積しない
+    for (int i = 0; i < 1000000; i++) {
+        player.advance(0.001);
+    }
+    player.advance(0.5);
+    EXPECT_NEAR(player.getClipTime(), 0.5f, 1e-4f);
+}
+
+TEST(AnimationTest, Lod) {
+    AnimationLodSettings settings;
+    EXPECT_EQ(chooseAnimationRate(true, 0.5f, settings), AnimationRate::Full);
+    EXPECT_EQ(chooseAnimationRate(true, 0.05f, settings), AnimationRate::Half);
+    EXPECT_EQ(chooseAnimationRate(true, 0.01f, settings), AnimationRate::Quarter);
+    EXPECT_EQ(chooseAnimationRate(false, 0.5f, settings), AnimationRate::Sixteenth);
+    settings.enabled = false;
+    EXPECT_EQ(chooseAnimationRate(false, 0.01f, settings), AnimationRate::Full);
+
+    // 16 フレームのうち Half は 8 回、Quarter は 4 回、Sixteenth は 1 回
+    int halfCount = 0;
+    int quarterCount = 0;
+    int sixteenthCount = 0;
+    for (uint64_t frame = 0; frame < 16; frame++) {
+        halfCount += shouldUpdateAnimation(AnimationRate::Half, frame, 3);
+        quarterCount += shouldUpdateAnimation(AnimationRate::Quarter, frame, 3);
+        sixteenthCount += shouldUpdateAnimation(AnimationRate::Sixteenth, frame, 3);
+        EXPECT_FALSE(shouldUpdateAnimation(AnimationRate::Paused, frame, 3));
+    }
+    EXPECT_EQ(halfCount, 8);
+    EXPECT_EQ(quarterCount, 4);
+    EXPECT_EQ(sixteenthCount, 1);
+
+    // 飛ばしたトラックは前回の結果のまま。再開するとその時刻の値に戻る
+    AnimationTracks<glm::vec3> tracks;
+    std::vector<float> times = {0.0f, 1.0f, 2.0f, 3.0f, 4.0f};
+    std::vector<glm::vec3> values = {glm::vec3{0.0f}, glm::vec3{1.0f}, glm::vec3{2.0f},
+                                     glm::vec3{3.0f}, glm::vec3{4.0f}};
+    tracks.add(0, Interpolation::Linear, times, values);
+    tracks.add(1, Interpolation::Linear, times, values);
+    tracks.sample(0.5f, 0, tracks.size());
+    tracks.sample(1.5f, 0, tracks.size(), [](uint32_t target) { return target == 0; });
+    EXPECT_FLOAT_EQ(tracks.getResults()[0].x, 1.5f);
+    EXPECT_FLOAT_EQ(tracks.getResults()[1].x, 0.5f);
+    tracks.sample(3.5f, 0, tracks.size(), [](uint32_t) { return true; });
+    EXPECT_FLOAT_EQ(tracks.getResults()[1].x, 3.5f);
+}
+
+TEST(AnimationTest, LodWalkIn) {
+    JobSystem jobSystem{2};
+    Scene scene;
+    scene.init(jobSystem);
+
+    // NOTE: XY平面上で上下左右 5.0 まで視界に入る
+    Object& cameraObject = scene.addObject("Camera");
+    Camera& camera = scene.addComponent<Camera>(cameraObject, rv::Camera::Type::Orbital);
+    camera.setFovY(glm::radians(90.0f));
+    camera.setDistance(5.0f);
+    camera.frustum = rv::Frustum{camera};
+    scene.setMainCamera(camera);
+
+    // 視錐台の外 (x = 20) から中 (x = 0) へ歩いてくる
+    Object& walker = scene.addObject("Walker");
+    uint32_t walkerIndex = walker.getIndex();
+    Transform& transform = scene.addComponent<Transform>(walker);
+    transform.translation = glm::vec3{20.0f, 0.0f, 0.0f};
+    scene.addComponent<Mesh>(walker).aabb = rv::AABB{glm::vec3{-0.5f}, glm::vec3{0.5f}};
+
+    AnimationClip clip;
+    std::vector<float> times = {0.0f, 1.0f, 2.0f};
+    std::vector<glm::vec3> values = {glm::vec3{20.0f, 0.0f, 0.0f}, glm::vec3{0.0f},
+                                     glm::vec3{0.0f}};
+    clip.translations.add(walkerIndex, Interpolation::Linear, times, values);
+    scene.getAnimationPlayer().addClip(std::move(clip));
+
+    // 外にいる間も間引いて更新されるので、視界に入った後は毎フレーム更新される
+    for (int frame = 0; frame < 90; frame++) {
+        scene.update(1000.0f / 60.0f);
+    }
+    EXPECT_NEAR(transform.translation.x, 0.0f, 1e-4f);
+    EXPECT_TRUE(scene.getWorldAABB(walkerIndex).isOnFrustum(camera.getFrustum()));
+}
+
+TEST(AnimationTest, Bake) {
+    AnimationClip clip;
+    std::vector<float> times = {0.0f, 2.0f};
+    std::vector<glm::vec3> values = {glm::vec3{0.0f}, glm::vec3{2.0f, 0.0f, 0.0f}};
+    clip.translations.add(5, Interpolation::Linear, times, values);
+
+    BakedAnimation baked;
+    glm::vec3 restTranslation{0.0f};
+    glm::quat restRotation{1.0f, 0.0f, 0.0f, 0.0f};
+    glm::vec3 restScale{1.0f};
+    uint32_t track = baked.bake(clip, 5, 10.0f, restTranslation, restRotation, restScale);
+    EXPECT_EQ(track, 0u);
+    EXPECT_EQ(baked.getTracks()[track].frameCount, 21u);
+    EXPECT_TRUE(baked.consumeDirty());
+    EXPECT_EQ(baked.bake(clip, 6, 10.0f, restTranslation, restRotation, restScale),
+              BakedAnimation::invalidTrack);
+
+    // フレームの間とループ
+    EXPECT_NEAR(baked.sample(track, 0.55f)[3].x, 0.55f, 1e-4f);
+    EXPECT_NEAR(baked.sample(track, 2.5f)[3].x, 0.5f, 1e-4f);
+    EXPECT_NEAR(baked.sample(track, -0.5f)[3].x, 1.5f, 1e-4f);
+    EXPECT_NEAR(baked.sample(track, 1.0f)[0].x, 1.0f, 1e-4f);
+
+    // 全フレームで通る範囲
+    auto [min, max] = baked.computeBounds(track, glm::vec3{0.0f}, glm::vec3{1.0f});
+    EXPECT_NEAR(min.x, -1.0f, 1e-5f);
+    EXPECT_NEAR(max.x, 3.0f, 1e-5f);
+    EXPECT_NEAR(max.y, 1.0f, 1e-5f);
+    auto [pointMin, pointMax] =
+        baked.computeBounds(track, glm::vec3{1.0f, 0.0f, 0.0f}, glm::vec3{0.0f});
+    EXPECT_NEAR(pointMin.x, 1.0f, 1e-5f);
+    EXPECT_NEAR(pointMax.x, 3.0f, 1e-5f);
+}
+
+TEST(SkinningTest, CpuReference) {
+    // メッシュ (オブジェクト0) と関節0 は同じ位置、関節1 はバインドポーズから x に 1 だけ動かす
+    std::vector<glm::mat4> worldMatrices = {
+        glm::translate(glm::mat4{1.0f}, glm::vec3{2.0f, 0.0f, 0.0f}),
+        glm::translate(glm::mat4{1.0f}, glm::vec3{2.0f, 0.0f, 0.0f}),
+        glm::translate(glm::mat4{1.0f}, glm::vec3{3.0f, 1.0f, 0.0f}),
+    };
+    std::vector<uint32_t> joints = {1, 2};
+    std::vector<glm::mat4> inverseBindMatrices = {
+        glm::mat4{1.0f},
+        glm::translate(glm::mat4{1.0f}, glm::vec3{0.0f, -1.0f, 0.0f}),
+    };
+
+    JointPalette palette;
+    uint32_t firstJoint = palette.addInstance(0, joints, inverseBindMatrices);
+    EXPECT_EQ(firstJoint, 0u);
+    palette.update([&](uint32_t objectIndex) -> const glm::mat4& {
+        return worldMatrices[objectIndex];
+    });
+    EXPECT_TRUE(palette.consumeDirty());
+    EXPECT_FALSE(palette.consumeDirty());
+
+    std::vector<DeformVertex> srcVertices = {
+        {glm::vec3{0.0f, 0.0f, 0.0f}, glm::vec3{0.0f, 1.0f, 0.0f}, glm::vec4{1.0f}},
+        {glm::vec3{0.0f, 1.0f, 0.0f}, glm::vec3{0.0f, 1.0f, 0.0f}, glm::vec4{1.0f}},
+        {glm::vec3{0.0f, 2.0f, 0.0f}, glm::vec3{0.0f, 1.0f, 0.0f}, glm::vec4{1.0f}},
+        {glm::vec3{0.0f, 3.0f, 0.0f}, glm::vec3{0.0f, 1.0f, 0.0f}, glm::vec4{1.0f}},
+    };
+    std::vector<SkinVertex> skins = {
+        {glm::uvec4{0, 0, 0, 0}, glm::vec4{1.0f, 0.0f, 0.0f, 0.0f}},
+        {glm::uvec4{0, 1, 0, 0}, glm::vec4{0.5f, 0.5f, 0.0f, 0.0f}},
+        {glm::uvec4{1, 0, 0, 0}, glm::vec4{1.0f, 0.0f, 0.0f, 0.0f}},
+        {glm::uvec4{0, 0, 0, 0}, glm::vec4{0.0f}},  // ウェイト無しは動かない
+    };
+    std::vector<DeformVertex> dstVertices(srcVertices.size());
+    skinVertices<DeformVertex>(srcVertices, skins, palette.getMatrices(), firstJoint, dstVertices);
+
+    EXPECT_NEAR(dstVertices[0].position.x, 0.0f, 1e-5f);
+    EXPECT_NEAR(dstVertices[1].position.x, 0.5f, 1e-5f);
+    EXPECT_NEAR(dstVertices[2].position.x, 1.0f, 1e-5f);
+    EXPECT_NEAR(dstVertices[2].position.y, 2.0f, 1e-5f);
+    EXPECT_NEAR(dstVertices[3].position.x, 0.0f, 1e-5f);
+    EXPECT_NEAR(dstVertices[2].normal.y, 1.0f, 1e-5f);
+}
+
+TEST(MorphTest, SparseDeltas) {
+    std::vector<DeformVertex> srcVertices = {
+        {glm::vec3{0.0f, 0.0f, 0.0f}, glm::vec3{0.0f, 1.0f, 0.0f}, glm::vec4{1.0f}},
+        {glm::vec3{1.0f, 0.0f, 0.0f}, glm::vec3{0.0f, 1.0f, 0.0f}, glm::vec4{1.0f}},
+        {glm::vec3{2.0f, 0.0f, 0.0f}, glm::vec3{0.0f, 1.0f, 0.0f}, glm::vec4{1.0f}},
+    };
+
+    // ターゲット0 は頂点1 だけ、ターゲット1 は頂点1 と頂点2 を動かす
+    std::vector<MorphTargetAttributes> targets(2);
+    targets[0].positions = {glm::vec3{0.0f}, glm::vec3{0.0f, 1.0f, 0.0f}, glm::vec3{0.0f}};
+    targets[1].positions = {
+        glm::vec3{0.0f},
+        glm::vec3{0.0f, 0.0f, 2.0f},
+        glm::vec3{0.0f, 4.0f, 0.0f},
+    };
+    targets[1].normals = {glm::vec3{0.0f}, glm::vec3{0.0f}, glm::vec3{1.0f, 0.0f, 0.0f}};
+
+    // 先頭に別のメッシュの頂点が 2 つある想定
+    MorphTargets morphTargets;
+    uint32_t vertexOffset = 2;
+    EXPECT_EQ(morphTargets.add(vertexOffset, 3, targets), 3u);
+    EXPECT_EQ(morphTargets.getRanges().size(), 5u);
+    EXPECT_EQ(morphTargets.getRanges()[0].y, 0u);
+    EXPECT_EQ(morphTargets.getRanges()[vertexOffset].y, 0u);
+    EXPECT_EQ(morphTargets.getRanges()[vertexOffset + 1].y, 2u);
+
+    MorphWeights weights;
+    std::vector<float> defaultWeights = {0.0f, 0.0f};
+    uint32_t firstWeight = weights.addInstance(defaultWeights);
+    EXPECT_TRUE(weights.consumeDirty());
+    EXPECT_TRUE(weights.isZero(firstWeight, 2));
+    weights.getWeights()[firstWeight + 1] = 0.5f;
+    weights.markDirty();
+    EXPECT_TRUE(weights.consumeDirty());
+    EXPECT_FALSE(weights.isZero(firstWeight, 2));
+
+    std::vector<DeformVertex> dstVertices(srcVertices.size());
+    applyMorphTargets<DeformVertex>(srcVertices, morphTargets, vertexOffset,
+                                    weights.getWeights().subspan(firstWeight, 2), dstVertices);
+    EXPECT_NEAR(dstVertices[0].position.x, 0.0f, 1e-5f);
+    EXPECT_NEAR(dstVertices[1].position.y, 0.0f, 1e-5f);
+    EXPECT_NEAR(dstVertices[1].position.z, 1.0f, 1e-5f);
+    EXPECT_NEAR(dstVertices[2].position.y, 2.0f, 1e-5f);
+    EXPECT_NEAR(dstVertices[2].normal.x, 0.5f, 1e-5f);
+}
+
+TEST(AccessorTest, ConvertAttributes) {
+    struct Vertex {
+        glm::vec3 position;
+        glm::vec2 texCoord;
+    };
+    std::vector<Vertex> vertices(3, Vertex{glm::vec3{0.0f}, glm::vec2{0.0f}});
+
+    // 間に 2 バイトの詰め物を挟んだ、正規化された unsigned short の UV
+    std::vector<uint16_t> texCoords = {0, 65535, 0, 32768, 0, 0, 0, 65535, 0};
+    AccessorView texCoordView{
+        .data = reinterpret_cast<const unsigned char*>(texCoords.data()),
+        .byteStride = sizeof(uint16_t) * 3,
+        .count = 3,
+        .componentType = AccessorComponentType::UnsignedShort,
+        .normalized = true,
+    };
+    readAccessor<float, 2>(texCoordView, &vertices[0].texCoord.x, sizeof(Vertex));
+    EXPECT_NEAR(vertices[0].texCoord.y, 1.0f, 1e-5f);
+    EXPECT_NEAR(vertices[1].texCoord.x, 0.5f, 1e-4f);
+    EXPECT_NEAR(vertices[2].texCoord.x, 0.0f, 1e-5f);
+
+    // 正規化された signed byte は -128 も -1 になる
+    std::vector<int8_t> positions = {127, -128, 0, -64, 0, 0, 0, 0, 0};
+    AccessorView positionView{
+        .data = reinterpret_cast<const unsigned char*>(positions.data()),
+        .count = 3,
+        .componentType = AccessorComponentType::Byte,
+        .normalized = true,
+    };
+    // 頂点2 だけを sparse で上書きする
+    std::vector<uint8_t> sparseIndices = {2};
+    std::vector<int8_t> sparseValues = {0, 127, 0};
+    AccessorSparseView sparse{
+        .indices = sparseIndices.data(),
+        .values = reinterpret_cast<const unsigned char*>(sparseValues.data()),
+        .count = 1,
+        .indexComponentType = AccessorComponentType::UnsignedByte,
+    };
+    readAccessor<float, 3>(positionView, &vertices[0].position.x, sizeof(Vertex), sparse);
+    EXPECT_NEAR(vertices[0].position.x, 1.0f, 1e-5f);
+    EXPECT_NEAR(vertices[0].position.y, -1.0f, 1e-5f);
+    EXPECT_NEAR(vertices[1].position.x, -64.0f / 127.0f, 1e-5f);
+    EXPECT_NEAR(vertices[2].position.y, 1.0f, 1e-5f);
+    EXPECT_NEAR(vertices[0].texCoord.y, 1.0f, 1e-5f);
+
+    // インデックスは幅によらず uint32_t にする
+    std::vector<uint8_t> byteIndices = {0, 1, 255};
+    std::vector<uint32_t> indices(3);
+    AccessorView indexView{
+        .data = byteIndices.data(),
+        .count = 3,
+        .componentType = AccessorComponentType::UnsignedByte,
+    };
+    readAccessor<uint32_t, 1>(indexView, indices.data(), sizeof(uint32_t));
+    EXPECT_EQ(indices[2], 255u);
+
+    std::vector<uint32_t> wideIndices = {0, 1, 70000};
+    indexView.data = reinterpret_cast<const unsigned char*>(wideIndices.data());
+    indexView.componentType = AccessorComponentType::UnsignedInt;
+    readAccessor<uint32_t, 1>(indexView, indices.data(), sizeof(uint32_t));
+    EXPECT_EQ(indices[2], 70000u);
+}
+
+TEST(MeshOptimizerTest, OptimizeGrid) {
+    // 頂点を共有しない三角形の羅列の格子 (N x N の四角形)
+    constexpr uint32_t N = 16;
+    std::vector<glm::vec3> soupPositions;
+    for (uint32_t y = 0; y < N; y++) {
+        for (uint32_t x = 0; x < N; x++) {
+            glm::vec3 p00{x, y, 0};
+            glm::vec3 p10{x + 1, y, 0};
+            glm::vec3 p01{x, y + 1, 0};
+            glm::vec3 p11{x + 1, y + 1, 0};
+            soupPositions.insert(soupPositions.end(), {p00, p10, p01, p01, p10, p11});
+        }
+    }
+    auto soupCount = static_cast<uint32_t>(soupPositions.size());
+
+    // 同じ位置の頂点がまとまる
+    std::vector<uint32_t> remap;
+    uint32_t vertexCount = buildDeduplicationRemap(
+        soupCount,
+        [&](uint32_t v) { return hashBytes(&soupPositions[v], sizeof(glm::vec3)); },
+        [&](uint32_t a, uint32_t b) { return soupPositions[a] == soupPositions[b]; }, remap);
+    EXPECT_EQ(vertexCount, (N + 1) * (N + 1));
+    std::vector<glm::vec3> positions(vertexCount);
+    std::vector<uint32_t> indices(soupCount);
+    for (uint32_t i = 0; i < soupCount; i++) {
+        indices[i] = remap[i];
+        positions[remap[i]] = soupPositions[i];
+    }
+
+    // 三角形をばらばらに並べると、並べ替えでキャッシュのミスが減る
+    std::vector<uint32_t> shuffled;
+    uint32_t triangleCount = soupCount / 3;
+    for (uint32_t i = 0; i < triangleCount; i++) {
+        uint32_t t = (i * 97) % triangleCount;
+        shuffled.insert(shuffled.end(), indices.begin() + t * 3, indices.begin() + t * 3 + 3);
+    }
+    float shuffledACMR = analyzeVertexCache(shuffled, vertexCount).getACMR();
+    std::vector<uint32_t> optimized = shuffled;
+    optimizeVertexCache(optimized, vertexCount);
+    optimizeOverdraw(optimized, positions);
+    VertexCacheStats stats = analyzeVertexCache(optimized, vertexCount);
+    EXPECT_LT(stats.getACMR(), shuffledACMR);
+    EXPECT_EQ(stats.triangles, triangleCount);
+
+    // 同じ入力からは同じ結果になる
+    std::vector<uint32_t> optimizedAgain = shuffled;
+    optimizeVertexCache(optimizedAgain, vertexCount);
+    optimizeOverdraw(optimizedAgain, positions);
+    EXPECT_EQ(optimized, optimizedAgain);
+
+    // 頂点は最初に使われる順に並ぶ
+    std::vector<uint32_t> fetchRemap;
+    EXPECT_EQ(optimizeVertexFetch(optimized, vertexCount, fetchRemap), vertexCount);
+    uint32_t next = 0;
+    for (uint32_t index : optimized) {
+        EXPECT_LE(index, next);
+        next = std::max(next, index + 1);
+    }
+}
+
+TEST(MeshOptimizerTest, Simplify) {
+    // 平らな格子は誤差なしで簡略化できる
+    constexpr uint32_t N = 16;
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    buildGrid(N, positions, indices);
+    float error = 1.0f;
+    std::vector<uint32_t> simplified =
+        simplifyMesh(indices, positions, indices.size() / 4, 0.01f, &error);
+    EXPECT_LT(simplified.size(), indices.size() / 2);
+    EXPECT_EQ(simplified.size() % 3, 0u);
+    EXPECT_LT(error, 1e-4f);
+
+    // 境界の頂点は動かないので、面積と向きが保たれる
+    float area = 0.0f;
+    for (size_t i = 0; i < simplified.size(); i += 3) {
+        const glm::vec3& p0 = positions[simplified[i + 0]];
+        glm::vec3 normal = glm::cross(positions[simplified[i + 1]] - p0,  //
+                                      positions[simplified[i + 2]] - p0);
+        EXPECT_GT(normal.z, 0.0f);
+        area += normal.z * 0.5f;
+    }
+    EXPECT_NEAR(area, static_cast<float>(N * N), 1e-3f);
+
+    // 許容する誤差が 0 なら、曲がった面は簡略化しない
+    for (glm::vec3& position : positions) {
+        position.z = (position.x - N * 0.5f) * (position.x - N * 0.5f);
+    }
+    EXPECT_EQ(simplifyMesh(indices, positions, 0, 0.0f).size(), indices.size());
+}
+
+TEST(MeshLodTest, Select) {
+    // 誤差は半径に対する割合、errorScale はそれを画面上のピクセル数にする係数
+    MeshLod lods[] = {{0, 0, 0.01f}, {0, 0, 0.04f}};
+    EXPECT_EQ(selectMeshLod(lods, 10.0f, 1.0f, 0.25f, 0), 2u);
+    EXPECT_EQ(selectMeshLod(lods, 100.0f, 1.0f, 0.25f, 0), 0u);
+    EXPECT_EQ(selectMeshLod(lods, 100.0f, 1.0f, 0.25f, 2), 1u);
+
+    // 閾値の近くでは前の LOD を保つ
+    EXPECT_EQ(selectMeshLod(lods, 90.0f, 1.0f, 0.25f, 0), 0u);
+    EXPECT_EQ(selectMeshLod(lods, 90.0f, 1.0f, 0.25f, 1), 1u);
+
+    // カメラが球の中にあれば元のメッシュを使う
+    float errorScale = computeLodErrorScale(1.0f, 0.5f, 1.0f, 1080.0f);
+    EXPECT_EQ(selectMeshLod(lods, errorScale, 1.0f, 0.25f, 2), 0u);
+}
+
+TEST(MeshClusterTest, BuildGrid) {
+    constexpr uint32_t N = 24;
+    std::vector<glm::vec3> positions;
+    std::vector<uint32_t> indices;
+    buildGrid(N, positions, indices);
+    std::vector<uint32_t> original = indices;
+    std::vector<MeshCluster> clusters = buildMeshClusters(indices, positions);
+    ASSERT_GT(clusters.size(), 1u);
+
+    // 塊はインデックスの上で隙間なく並び、上限を超えない
+    uint32_t nextIndex = 0;
+    for (const MeshCluster& cluster : clusters) {
+        EXPECT_EQ(cluster.firstIndex, nextIndex);
+        EXPECT_LE(cluster.indexCount, maxClusterTriangles * 3);
+        std::vector<uint32_t> vertices(indices.begin() + cluster.firstIndex,
+                                       indices.begin() + cluster.firstIndex + cluster.indexCount);
+        std::ranges::sort(vertices);
+        EXPECT_LE(std::unique(vertices.begin(), vertices.end()) - vertices.begin(),
+                  maxClusterVertices);
+        for (uint32_t vertex : vertices) {
+            EXPECT_LE(glm::length(positions[vertex] - cluster.center), cluster.radius + 1e-4f);
+        }
+        nextIndex += cluster.indexCount;
+    }
+    EXPECT_EQ(nextIndex, indices.size());
+
+    // 三角形は並び替わるだけで、向きも含めて全て残る
+    auto sortTriangles = [](const std::vector<uint32_t>& source) {
+        std::vector<std::array<uint32_t, 3>> triangles;
+        for (size_t i = 0; i < source.size(); i += 3) {
+            std::array<uint32_t, 3> triangle = {source[i], source[i + 1], source[i + 2]};
+            std::ranges::rotate(triangle, std::ranges::min_element(triangle));
+            triangles.push_back(triangle);
+        }
+        std::ranges::sort(triangles);
+        return triangles;
+    };
+    EXPECT_EQ(sortTriangles(indices), sortTriangles(original));
+
+    // 同じ入力からは同じ塊になる
+    std::vector<uint32_t> rebuilt = original;
+    EXPECT_EQ(buildMeshClusters(rebuilt, positions).size(), clusters.size());
+    EXPECT_EQ(rebuilt, indices);
+
+    // 裏側から見たときだけ裏向きと判定する
+    const MeshCluster& cluster = clusters.front();
+    auto isBackfacing = [&](const glm::vec3& cameraPosition) {
+        return isClusterBackfacing(cluster.center, cluster.radius, cluster.coneAxis,
+                                   cluster.coneCutoff, cameraPosition);
+    };
+    EXPECT_TRUE(isBackfacing(cluster.center - glm::vec3{0.0f, 0.0f, 10.0f}));
+    EXPECT_FALSE(isBackfacing(cluster.center + glm::vec3{0.0f, 0.0f, 10.0f}));
+}
+
+TEST(MeshDataTest, CompactIndices) {
+    // small: 4頂点の四角形と、その LOD (三角形一つ)
+    // large: 65535 を超える頂点を参照する三角形
+    // NOTE: インデックスは small, large, small の LOD の順に並べ、移動後の位置を確かめる
+    MeshData data;
+    data.indices = {0, 1, 2, 2, 1, 3, 0, 70000, 1, 0, 1, 3};
+    Mesh small;
+    small.firstIndex = 0;
+    small.indexCount = 6;
+    small.lods[0] = {9, 3, 0.1f};
+    small.lodCount = 1;
+    Mesh large;
+    large.firstIndex = 6;
+    large.indexCount = 3;
+
+    // 塊の範囲はメッシュの firstIndex からの相対位置なので、移動しても変わらない
+    MeshCluster cluster{};
+    cluster.firstIndex = 3;
+    cluster.indexCount = 3;
+
+    std::array<Mesh*, 2> meshes = {&small, &large};
+    data.compactIndices(meshes);
+
+    EXPECT_EQ(small.indexType, vk::IndexType::eUint16);
+    EXPECT_EQ(small.firstIndex, 0u);
+    EXPECT_EQ(small.lods[0].firstIndex, 6u);
+    EXPECT_EQ(small.lods[0].indexCount, 3u);
+    EXPECT_EQ(data.indices16, (std::vector<uint16_t>{0, 1, 2, 2, 1, 3, 0, 1, 3}));
+    std::vector<uint16_t> clusterIndices(
+        data.indices16.begin() + small.firstIndex + cluster.firstIndex,
+        data.indices16.begin() + small.firstIndex + cluster.firstIndex + cluster.indexCount);
+    EXPECT_EQ(clusterIndices, (std::vector<uint16_t>{2, 1, 3}));
+
+    EXPECT_EQ(large.indexType, vk::IndexType::eUint32);
+    EXPECT_EQ(large.firstIndex, 0u);
+    EXPECT_EQ(data.indices, (std::vector<uint32_t>{0, 70000, 1}));
+    EXPECT_EQ(data.getIndices16Offset(), sizeof(uint32_t) * 3);
+
+    // 16ビットの最大値ちょうどは 16ビットに収まる
+    MeshData boundary;
+    boundary.indices = {0, 65535, 1};
+    Mesh edge;
+    edge.indexCount = 3;
+    std::array<Mesh*, 1> edgeMeshes = {&edge};
+    boundary.compactIndices(edgeMeshes);
+    EXPECT_EQ(edge.indexType, vk::IndexType::eUint16);
+    EXPECT_EQ(boundary.indices16, (std::vector<uint16_t>{0, 65535, 1}));
+    EXPECT_TRUE(boundary.indices.empty());
+}
+
+TEST(ScenePackTest, RoundTrip) {
+    ScenePackWriter writer;
+    ScenePackObject object{};
+    object.name = writer.addString("Root");
+    object.translation = glm::vec3{1.0f, 2.0f, 3.0f};
+    EXPECT_EQ(writer.add(ScenePackSection::Objects, object), 0u);
+    object.name = writer.addString("Child");
+    object.parent = 0;
+    EXPECT_EQ(writer.add(ScenePackSection::Objects, object), 1u);
+
+    // 同じセクションに追加すると後ろに続く
+    std::vector<float> times = {0.0f, 1.0f};
+    EXPECT_EQ(writer.add<float>(ScenePackSection::TrackTimes, times), 0u);
+    EXPECT_EQ(writer.add<float>(ScenePackSection::TrackTimes, times), 2u);
+    EXPECT_EQ(writer.getCount<float>(ScenePackSection::TrackTimes), 4u);
+
+    std::filesystem::path filepath =
+        std::filesystem::temp_directory_path() / "scene_pack_test.pack";
+    ASSERT_TRUE(writer.write(filepath));
+    {
+        ScenePackFile pack;
+        ASSERT_TRUE(pack.open(filepath));
+        std::span<const ScenePackObject> objects =
+            pack.get<ScenePackObject>(ScenePackSection::Objects);
+        ASSERT_EQ(objects.size(), 2u);
+        EXPECT_EQ(pack.getString(objects[0].name), "Root");
+        EXPECT_EQ(pack.getString(objects[1].name), "Child");
+        EXPECT_EQ(objects[0].parent, ScenePackObject::none);
+        EXPECT_EQ(objects[1].parent, 0u);
+        EXPECT_EQ(objects[1].translation.z, 3.0f);
+        EXPECT_EQ(pack.get<float>(ScenePackSection::TrackTimes).size(), 4u);
+        EXPECT_TRUE(pack.get<MorphDelta>(ScenePackSection::MorphDeltas).empty());
+
+        // セクションは16バイト境界に置かれる
+        auto address = reinterpret_cast<uintptr_t>(objects.data());
+        EXPECT_EQ(address % 16, 0u);
+    }
+
+    // 壊れたファイルは開けない
+    {
+        std::ofstream file(filepath, std::ios::binary | std::ios::trunc);
+        file << "not a scene pack";
+    }
+    ScenePackFile pack;
+    EXPECT_FALSE(pack.open(filepath));
+    std::filesystem::remove(filepath);
+}
+
+TEST(ScenePackTest, Staleness) {
+    std::filesystem::path directory =
+        std::filesystem::temp_directory_path() / "scene_pack_stale_test";
+    std::filesystem::create_directories(directory / "textures");
+    auto writeFile = [&](const char* name, const char* text) {
+        std::ofstream file(directory / name, std::ios::binary | std::ios::trunc);
+        file << text;
+    };
+    writeFile("scene.gltf", R"({
+        "buffers": [{"uri": "scene.bin"}, {"uri": "data:application/octet-stream;base64,AAAA"}],
+        "images": [{"uri": "textures/base.png"}, {"bufferView": 0}]
+    })");
+    writeFile("scene.bin", "");
+    writeFile("textures/base.png", "");
+    writeFile("scene.pack", "");
+
+    // シーンパックを焼いた後に更新されたファイルがあれば古い
+    auto now = std::filesystem::file_time_type::clock::now();
+    auto resetTimes = [&]() {
+        for (const char* name : {"scene.gltf", "scene.bin", "textures/base.png"}) {
+            std::filesystem::last_write_time(directory / name, now - std::chrono::hours{1});
+        }
+        std::filesystem::last_write_time(directory / "scene.pack", now);
+    };
+    std::filesystem::path packPath = directory / "scene.pack";
+    std::filesystem::path gltfPath = directory / "scene.gltf";
+    resetTimes();
+    EXPECT_FALSE(Scene::isScenePackStale(packPath, gltfPath));
+    for (const char* name : {"scene.gltf", "scene.bin", "textures/base.png"}) {
+        resetTimes();
+        std::filesystem::last_write_time(directory / name, now + std::chrono::hours{1});
+        EXPECT_TRUE(Scene::isScenePackStale(packPath, gltfPath)) << name;
+    }
+
+    // 参照先が無いファイルやシーンパックが無い場合も焼き直す
+    resetTimes();
+    std::filesystem::remove(directory / "scene.bin");
+    EXPECT_TRUE(Scene::isScenePackStale(packPath, gltfPath));
+    EXPECT_TRUE(Scene::isScenePackStale(directory / "missing.pack", gltfPath));
+    std::filesystem::remove_all(directory);
+}
+
 // Run all the tests that were declared with TEST()
 int main(int argc, char** argv) {
     testing::InitGoogleTest(&argc, argv);